@@ -0,0 +1,191 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _DATABASE_BLOB_H_
+#define _DATABASE_BLOB_H_
+
+#include <string.h>
+#include <stdint.h>
+
+#include <iostream>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/checked_delete.hpp>
+
+#include <database_interface/db_class.h>
+
+namespace household_objects_database {
+
+//! A read-only typed view of a contiguous array; does not own the data
+template <class T>
+class BlobSpan
+{
+ private:
+  const T *data_;
+  size_t size_;
+
+ public:
+  BlobSpan() : data_(NULL), size_(0) {}
+  BlobSpan(const T *data, size_t size) : data_(data), size_(size) {}
+
+  const T* data() const {return data_;}
+  size_t size() const {return size_;}
+  bool empty() const {return size_ == 0;}
+  const T* begin() const {return data_;}
+  const T* end() const {return data_ + size_;}
+  const T& operator[](size_t i) const {return data_[i];}
+};
+
+//! Binary data from the database, held in a single reference counted buffer
+/*! Copies of a blob share the same buffer, so blobs can be passed around and stored without
+  copying the data. Buffers allocated by the blob itself are aligned for any of the element
+  types stored in the database, so typed views can be obtained directly with as<T>(), with
+  no decoding step.
+
+  A blob can also be a view into memory owned by something else (e.g. a memory mapped file),
+  which is then kept alive for as long as the blob, or any copy of it, exists.
+ */
+class DatabaseBlob
+{
+ private:
+  //! Keeps the memory that data_ points into alive
+  boost::shared_ptr<const void> owner_;
+  //! The start of the data
+  const char *data_;
+  //! The size of the data, in bytes
+  size_t length_;
+
+ public:
+  DatabaseBlob() : data_(NULL), length_(0) {}
+
+  //! A view of \a length bytes at \a data, which stay valid as long as \a owner is alive
+  DatabaseBlob(boost::shared_ptr<const void> owner, const char *data, size_t length) : 
+    owner_(owner), data_(data), length_(length) {}
+
+  //! Copies \a length bytes into a new buffer, which this blob then holds
+  void assign(const char *data, size_t length)
+  {
+    if (!length)
+    {
+      clear();
+      return;
+    }
+    //uint64_t storage makes sure the buffer is suitably aligned
+    uint64_t *buffer = new uint64_t[(length + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    memcpy(buffer, data, length);
+    owner_.reset(buffer, boost::checked_array_deleter<uint64_t>());
+    data_ = reinterpret_cast<const char*>(buffer);
+    length_ = length;
+  }
+
+  //! Copies the contents of a vector into a new buffer
+  template <class T>
+  void assign(const std::vector<T> &vec)
+  {
+    if (vec.empty()) clear();
+    else assign(reinterpret_cast<const char*>(&vec[0]), vec.size() * sizeof(T));
+  }
+
+  void clear()
+  {
+    owner_.reset();
+    data_ = NULL;
+    length_ = 0;
+  }
+
+  const char* data() const {return data_;}
+  size_t length() const {return length_;}
+  bool empty() const {return length_ == 0;}
+
+  //! True if the blob holds a whole number of elements of type T
+  template <class T>
+  bool isArrayOf() const {return length_ % sizeof(T) == 0;}
+
+  //! A typed view of the data; any trailing partial element is left out
+  template <class T>
+  BlobSpan<T> as() const {return BlobSpan<T>(reinterpret_cast<const T*>(data_), length_ / sizeof(T));}
+};
+
+//! Blobs only have a binary representation; text conversion always fails
+inline std::istream& operator >> (std::istream &str, DatabaseBlob &)
+{
+  str.setstate(std::ios::failbit);
+  return str;
+}
+
+//! Blobs only have a binary representation; text conversion always fails
+inline std::ostream& operator << (std::ostream &str, const DatabaseBlob &)
+{
+  str.setstate(std::ios::failbit);
+  return str;
+}
+
+} //namespace
+
+namespace database_interface {
+
+//! Binary conversion from a database binary blob to a DatabaseBlob
+/*! The data returned by the database is copied exactly once, into the blob's own buffer. Writing
+  the blob back to the database uses the buffer directly. */
+template <>
+class DBField<household_objects_database::DatabaseBlob> : public DBFieldData<household_objects_database::DatabaseBlob>
+{
+ public:
+  DBField(Type type, DBClass *owner, std::string name, std::string table_name, bool write_permission) : 
+    DBFieldData<household_objects_database::DatabaseBlob>(type, owner, name, table_name, write_permission) {}
+
+  DBField(DBClass *owner, const DBField<household_objects_database::DatabaseBlob> *other) : 
+    DBFieldData<household_objects_database::DatabaseBlob>(owner, other) 
+      {
+	this->copy(other);
+      }
+
+  virtual bool fromBinary(const char* binary, size_t length) 
+  {
+    data_.assign(binary, length);
+    return true;
+  }
+
+  virtual bool toBinary(const char* &binary, size_t &length) const 
+  {
+    binary = data_.data();
+    length = data_.length();
+    return true;
+  }
+};
+
+} //namespace
+
+#endif
@@ -39,6 +39,8 @@
 
 #include <database_interface/db_class.h>
 
+#include "household_objects_database/database_blob.h"
+
 namespace database_interface {
 
 //! Specialized version for binary conversion from a database binary blob to a vector of int
@@ -139,10 +141,10 @@ class DatabaseMesh : public database_interface::DBClass
  public:
   //! The original model id
   database_interface::DBField<int> id_;
-  //! List of vertices
-  database_interface::DBField< std::vector<double> > vertices_;
-  //! List of triangles
-  database_interface::DBField< std::vector<int> > triangles_;
+  //! List of vertices, as x, y, z doubles
+  database_interface::DBField<DatabaseBlob> vertices_;
+  //! List of triangles, as three int vertex indices each
+  database_interface::DBField<DatabaseBlob> triangles_;
 
  DatabaseMesh() :
   id_(database_interface::DBFieldBase::TEXT, this, "original_model_id", "mesh", true),
@@ -159,6 +161,18 @@ class DatabaseMesh : public database_interface::DBClass
       id_.setReadFromDatabase(true);
     }
   ~DatabaseMesh(){}
+
+  //! The vertices as a flat list of x, y, z coordinates, read in place
+  BlobSpan<double> vertices() const {return vertices_.data().as<double>();}
+  //! The triangles as a flat list of vertex indices, read in place
+  BlobSpan<int> triangles() const {return triangles_.data().as<int>();}
+
+  //! Checks that vertices and triangles are whole numbers of 3D entries
+  bool isValid() const
+  {
+    return vertices_.data().isArrayOf<double>() && triangles_.data().isArrayOf<int>() &&
+      vertices().size() % 3 == 0 && triangles().size() % 3 == 0;
+  }
 };
 
 } //namespace
@@ -0,0 +1,105 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _DATABASE_RECORD_IO_H_
+#define _DATABASE_RECORD_IO_H_
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <database_interface/db_class.h>
+
+namespace household_objects_database {
+
+/* Helpers for storing database objects in local files, e.g. read-only replicas or spools of
+   records waiting to be written to the database. Integers are stored in native format. */
+
+void writeUInt(std::ostream &str, uint32_t value);
+
+bool readUInt(std::istream &str, uint32_t &value);
+
+//! Writes a length-prefixed block of bytes
+void writeBytes(std::ostream &str, const char *data, size_t length);
+
+//! Reads a block written by writeBytes(...)
+/*! Fails if the stream ends before the stored length is reached. */
+bool readBytes(std::istream &str, std::string &data);
+
+//! Writes all the fields of \a entry as (name, value) pairs
+/*! Values use the same text or binary representation that is used for the database itself.*/
+bool writeRecord(std::ostream &str, database_interface::DBClass *entry);
+
+//! Reads a record written by writeRecord(...) into \a entry
+/*! Fields are matched by name; stored fields that \a entry does not have are ignored. */
+bool readRecord(std::istream &str, database_interface::DBClass *entry);
+
+//! Writes a count followed by the records in \a list
+template <class T>
+inline bool writeList(std::ostream &str, const std::vector<boost::shared_ptr<T> > &list)
+{
+  writeUInt(str, list.size());
+  for (size_t i=0; i<list.size(); i++)
+  {
+    if (!writeRecord(str, list[i].get())) return false;
+  }
+  return true;
+}
+
+//! Reads a list written by writeList(...)
+template <class T>
+inline bool readList(std::istream &str, std::vector<boost::shared_ptr<T> > &list)
+{
+  uint32_t size;
+  if (!readUInt(str, size)) return false;
+  list.clear();
+  //the size comes from the file, so it only serves as a hint
+  list.reserve(std::min<uint32_t>(size, 1024));
+  for (uint32_t i=0; i<size; i++)
+  {
+    boost::shared_ptr<T> entry(new T);
+    if (!readRecord(str, entry.get())) return false;
+    list.push_back(entry);
+  }
+  return true;
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,74 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _DATABASE_TOOL_UTILS_H_
+#define _DATABASE_TOOL_UTILS_H_
+
+#include <iostream>
+#include <string>
+
+#include "household_objects_database/objects_database.h"
+
+namespace household_objects_database {
+
+/* Helpers shared by the command line tools that copy (part of) the objects database into 
+   local files. */
+
+//! Prints the usage of such a tool, given its synopsis, e.g. "tool output_file [model_set ...]"
+inline void printDatabaseToolUsage(const std::string &synopsis)
+{
+  std::cerr << "Usage: " << synopsis << "\n";
+  std::cerr << "  Uses all models if no model sets are given.\n";
+  std::cerr << "  Database connection parameters are read from /household_objects_database/\n";
+}
+
+//! Connects to the database with the same parameters as the objects_database_node
+/*! Returns NULL if the connection fails; the caller takes ownership otherwise. */
+inline ObjectsDatabase* connectToDatabaseFromParams()
+{
+  std::string host, port, user, password, dbname;
+  ObjectsDatabase::getConnectionParams(host, port, user, password, dbname);
+  ObjectsDatabase *database = new ObjectsDatabase(host, port, user, password, dbname);
+  if (!database->isConnected())
+  {
+    std::cerr << "Database failed to connect\n";
+    delete database;
+    return NULL;
+  }
+  return database;
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,158 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _LOCAL_OBJECTS_DATABASE_H_
+#define _LOCAL_OBJECTS_DATABASE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <arm_navigation_msgs/Shape.h>
+
+#include "household_objects_database/objects_database.h"
+#include "household_objects_database/model_catalogue.h"
+
+namespace household_objects_database
+{
+
+  //! A read-only replica of (part of) the objects database, loaded from a local file
+  /*! Holds scaled models, model set memberships, meshes, grasps and, optionally, VFH
+    descriptors, all in memory. Offers the same query functions as the ObjectsDatabase for the
+    data it contains, so that robots can be served without any network access.
+
+    The replica file is created from a live database with exportDatabase(...), usually through
+    the export_local_database tool. Alternatively, the replica can be loaded from a model
+    catalogue (see model_catalogue.h), in which case meshes are not copied, but point directly
+    into the mapped catalogue file.
+
+    Objects returned by the query functions are shared with the replica and must not be modified.
+   */
+  class LocalObjectsDatabase
+  {
+  private:
+    //! All the scaled models in the replica, in the order they were exported
+    std::vector<boost::shared_ptr<DatabaseScaledModel> > models_;
+
+    //! Scaled models indexed by scaled model id
+    std::map<int, boost::shared_ptr<DatabaseScaledModel> > models_by_id_;
+
+    //! The scaled model ids belonging to each model set that was exported
+    std::map<std::string, std::vector<int> > model_sets_;
+
+    //! Meshes indexed by original model id
+    std::map<int, boost::shared_ptr<DatabaseMesh> > meshes_;
+
+    //! Grasps indexed by scaled model id
+    std::map<int, std::vector<boost::shared_ptr<DatabaseGrasp> > > grasps_;
+
+    //! All the VFH descriptors in the replica
+    std::vector<boost::shared_ptr<DatabaseVFH> > vfh_;
+
+    //! Whether a replica file has been successfully loaded
+    bool loaded_;
+
+    //! Clears all the content of the replica
+    void
+    clear ();
+
+    //! Populates the replica from a model catalogue file
+    bool
+    loadFromCatalogue (std::string filename);
+
+  public:
+    //! Creates an empty replica; use loadFromFile(...) to populate it
+    LocalObjectsDatabase () :
+      loaded_ (false)
+    {
+    }
+
+    //! Loads the replica from the given replica or model catalogue file, discarding any previous content
+    bool
+    loadFromFile (std::string filename);
+
+    //! Returns true if a replica file has been successfully loaded
+    bool
+    isLoaded () const
+    {
+      return loaded_;
+    }
+
+    //! Copies the models in the given model sets, with their meshes and grasps, into a replica file
+    /*! If \a model_sets is empty, all the models in the database are exported. VFH descriptors
+      are exported only if \a export_vfh is set, as they are large and not needed for most robots.*/
+    static bool
+    exportDatabase (ObjectsDatabase &database, const std::vector<std::string> &model_sets,
+                    bool export_vfh, std::string filename);
+
+    //! Gets a list of all the scaled models in the replica
+    bool
+    getScaledModelsList (std::vector<boost::shared_ptr<DatabaseScaledModel> > &models) const;
+
+    //! Gets the list of scaled models in a set; empty set name means all models
+    /*! Fails if the requested model set was not exported to this replica. */
+    bool
+    getScaledModelsBySet (std::vector<boost::shared_ptr<DatabaseScaledModel> > &models,
+                          std::string model_set_name) const;
+
+    //! Gets a single scaled model by id
+    bool
+    getScaledModel (int scaled_model_id, boost::shared_ptr<DatabaseScaledModel> &model) const;
+
+    //! Gets the list of all the grasps for a scaled model id
+    bool
+    getGrasps (int scaled_model_id, std::string hand_name,
+               std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps) const;
+
+    //! Gets the list of only those grasps that are cluster reps for a scaled model id
+    bool
+    getClusterRepGrasps (int scaled_model_id, std::string hand_name,
+                         std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps) const;
+
+    //! Gets the mesh for a scaled model as a arm_navigation_msgs::Shape
+    bool
+    getScaledModelMesh (int scaled_model_id, arm_navigation_msgs::Shape &shape) const;
+
+    //! Gets all the VFH descriptors in the replica, including their data
+    bool
+    getVFHDescriptors (std::vector<boost::shared_ptr<DatabaseVFH> > &vfh) const;
+  };
+
+  typedef boost::shared_ptr<LocalObjectsDatabase> LocalObjectsDatabasePtr;
+
+}//namespace
+
+#endif
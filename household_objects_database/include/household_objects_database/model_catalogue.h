@@ -0,0 +1,355 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _MODEL_CATALOGUE_H_
+#define _MODEL_CATALOGUE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include "household_objects_database/database_scaled_model.h"
+#include "household_objects_database/database_mesh.h"
+#include "household_objects_database/database_grasp.h"
+
+namespace household_objects_database
+{
+
+  /* A model catalogue is a single packed binary file with everything needed to recognize and grasp
+     a set of scaled models, laid out so that it can be memory mapped and used in place:
+
+     - a CatalogueHeader at the beginning of the file
+     - an array of CatalogueModel entries, one for each scaled model
+     - an array of CatalogueModelSet entries, one for each model set
+     - data blocks (vertices, triangles, sampled points, grasps, strings) referenced by offset
+
+     All offsets are in bytes from the beginning of the file, and all data blocks start on 8 byte
+     boundaries. Strings are null-terminated. Poses are stored as {tx, ty, tz, qx, qy, qz, qw}; note
+     that this is NOT the order used in the database.
+
+     All integers and floating point values are in the native format of the machine that wrote the
+     catalogue; the header records enough to reject a catalogue written by a different architecture.
+  */
+
+  //! Identifies model catalogue files
+  const char CATALOGUE_MAGIC[8] = {'H', 'O', 'D', 'B', 'C', 'A', 'T', '\0'};
+
+  //! Bumped whenever the layout of the catalogue changes
+  const uint32_t CATALOGUE_VERSION = 1;
+
+  //! The header at the beginning of each catalogue file
+  struct CatalogueHeader
+  {
+    char magic[8];
+    uint32_t version;
+    //! Always sizeof(CatalogueModel); used to detect layout mismatches
+    uint32_t model_entry_size;
+    //! Always sizeof(CatalogueGrasp); used to detect layout mismatches
+    uint32_t grasp_entry_size;
+    uint32_t num_models;
+    uint32_t num_sets;
+    uint32_t reserved;
+    //! The resolution that the sampled point sets were obtained with; 0 if none are stored
+    double sampling_resolution;
+    uint64_t models_offset;
+    uint64_t sets_offset;
+    uint64_t file_size;
+  };
+
+  //! All the information about a single scaled model
+  struct CatalogueModel
+  {
+    int32_t scaled_model_id;
+    int32_t original_model_id;
+    double scale;
+    //! Offset of the name (original_model_model) string
+    uint64_t name_offset;
+    //! Offset of the maker string
+    uint64_t maker_offset;
+    //! Offset of an array of num_tags string offsets
+    uint64_t tags_offset;
+    uint32_t num_tags;
+    uint32_t num_grasps;
+    //! Offset of an array of 3 * num_vertices doubles
+    uint64_t vertices_offset;
+    uint32_t num_vertices;
+    uint32_t num_triangles;
+    //! Offset of an array of 3 * num_triangles int32_t vertex indices
+    uint64_t triangles_offset;
+    //! Offset of an array of 3 * num_sampled_points floats, sampled from the mesh surface
+    uint64_t sampled_points_offset;
+    uint32_t num_sampled_points;
+    uint32_t padding;
+    //! Offset of an array of num_grasps CatalogueGrasp entries
+    uint64_t grasps_offset;
+  };
+
+  //! A single grasp from the database
+  struct CatalogueGrasp
+  {
+    int32_t grasp_id;
+    int32_t compliant_original_id;
+    uint8_t cluster_rep;
+    uint8_t compliant_copy;
+    uint8_t fingertip_object_collision;
+    uint8_t padding[5];
+    uint64_t hand_name_offset;
+    double quality;
+    double scaled_quality;
+    double pre_grasp_clearance;
+    double table_clearance;
+    double pre_grasp_pose[7];
+    double final_grasp_pose[7];
+    //! Offset of an array of num_pre_grasp_joints doubles
+    uint64_t pre_grasp_posture_offset;
+    //! Offset of an array of num_final_grasp_joints doubles
+    uint64_t final_grasp_posture_offset;
+    uint32_t num_pre_grasp_joints;
+    uint32_t num_final_grasp_joints;
+  };
+
+  //! The list of scaled models that belong to a model set
+  struct CatalogueModelSet
+  {
+    uint64_t name_offset;
+    //! Offset of an array of num_ids int32_t scaled model ids
+    uint64_t ids_offset;
+    uint32_t num_ids;
+    uint32_t padding;
+  };
+
+  //! Read-only access to a memory mapped model catalogue
+  /*! All pointers handed out point directly into the mapped file and are valid for as long
+    as the catalogue stays open. Offsets and sizes are validated once, when the file is opened,
+    so that accessors can be used without further checks.
+   */
+  class ModelCatalogue
+  {
+  private:
+    //! The start of the mapped file
+    const char *data_;
+
+    //! The size of the mapped file
+    size_t size_;
+
+    //! Index of models by scaled model id
+    std::map<int, size_t> model_index_;
+
+    //! Checks that a block of \a count elements of \a element_size bytes lies inside the file
+    bool
+    checkBlock (uint64_t offset, uint64_t count, size_t element_size) const;
+
+    //! Checks that a string starting at \a offset is null-terminated inside the file
+    bool
+    checkString (uint64_t offset) const;
+
+    //! Checks all the offsets and sizes in the file
+    bool
+    validate ();
+
+    //! Not implemented; the catalogue owns its mapping
+    ModelCatalogue (const ModelCatalogue &);
+    ModelCatalogue& operator= (const ModelCatalogue &);
+
+  public:
+    ModelCatalogue () :
+      data_ (NULL), size_ (0)
+    {
+    }
+
+    ~ModelCatalogue ()
+    {
+      close ();
+    }
+
+    //! Maps the given catalogue file into memory and validates it
+    bool
+    open (std::string filename);
+
+    //! Unmaps the catalogue, if any is open
+    void
+    close ();
+
+    //! Returns true if the given file starts with the catalogue magic string
+    static bool
+    isCatalogueFile (std::string filename);
+
+    bool
+    isOpen () const
+    {
+      return data_ != NULL;
+    }
+
+    const CatalogueHeader&
+    header () const
+    {
+      return *reinterpret_cast<const CatalogueHeader*> (data_);
+    }
+
+    size_t
+    numModels () const
+    {
+      return header ().num_models;
+    }
+
+    const CatalogueModel&
+    model (size_t i) const
+    {
+      return array<CatalogueModel> (header ().models_offset)[i];
+    }
+
+    //! Returns NULL if the model is not in the catalogue
+    const CatalogueModel*
+    findModel (int scaled_model_id) const
+    {
+      std::map<int, size_t>::const_iterator it = model_index_.find (scaled_model_id);
+      if (it == model_index_.end ())
+        return NULL;
+      return &model (it->second);
+    }
+
+    size_t
+    numModelSets () const
+    {
+      return header ().num_sets;
+    }
+
+    const CatalogueModelSet&
+    modelSet (size_t i) const
+    {
+      return array<CatalogueModelSet> (header ().sets_offset)[i];
+    }
+
+    //! Returns NULL if the model set is not in the catalogue
+    const CatalogueModelSet*
+    findModelSet (std::string name) const;
+
+    template <class T>
+    const T*
+    array (uint64_t offset) const
+    {
+      return reinterpret_cast<const T*> (data_ + offset);
+    }
+
+    const char*
+    getString (uint64_t offset) const
+    {
+      return data_ + offset;
+    }
+
+    const double*
+    vertices (const CatalogueModel &model) const
+    {
+      return array<double> (model.vertices_offset);
+    }
+
+    const int32_t*
+    triangles (const CatalogueModel &model) const
+    {
+      return array<int32_t> (model.triangles_offset);
+    }
+
+    const float*
+    sampledPoints (const CatalogueModel &model) const
+    {
+      return array<float> (model.sampled_points_offset);
+    }
+
+    const CatalogueGrasp*
+    grasps (const CatalogueModel &model) const
+    {
+      return array<CatalogueGrasp> (model.grasps_offset);
+    }
+  };
+
+  typedef boost::shared_ptr<ModelCatalogue> ModelCataloguePtr;
+
+  //! Assembles a model catalogue in memory and writes it to disk
+  class ModelCatalogueWriter
+  {
+  private:
+    struct ModelData
+    {
+      CatalogueModel entry;
+      std::string name;
+      std::string maker;
+      std::vector<std::string> tags;
+      std::vector<double> vertices;
+      std::vector<int32_t> triangles;
+      std::vector<float> sampled_points;
+      std::vector<CatalogueGrasp> grasps;
+      std::vector<std::string> hand_names;
+      std::vector<std::vector<double> > pre_grasp_postures;
+      std::vector<std::vector<double> > final_grasp_postures;
+    };
+
+    std::vector<ModelData> models_;
+
+    std::map<std::string, std::vector<int32_t> > model_sets_;
+
+    double sampling_resolution_;
+
+  public:
+    //! \a sampling_resolution is recorded in the catalogue and should be the one used for sampled points
+    ModelCatalogueWriter (double sampling_resolution) :
+      sampling_resolution_ (sampling_resolution)
+    {
+    }
+
+    //! Adds a scaled model with its mesh, grasps and (optionally empty) sampled surface points
+    /*! Sampled points are given as a flat list of x, y, z coordinates. */
+    bool
+    addModel (const DatabaseScaledModel &model, const DatabaseMesh &mesh,
+              const std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps,
+              const std::vector<float> &sampled_points);
+
+    //! Records that the given scaled models belong to a model set
+    void
+    addModelSet (std::string name, const std::vector<int32_t> &scaled_model_ids)
+    {
+      model_sets_[name] = scaled_model_ids;
+    }
+
+    //! Writes everything that has been added so far to a catalogue file
+    bool
+    write (std::string filename) const;
+  };
+
+}//namespace
+
+#endif
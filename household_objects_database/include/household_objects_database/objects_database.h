@@ -63,6 +63,8 @@
 #include "household_objects_database/database_vfh_orientation.h"
 #include "household_objects_database/database_file_path.h"
 #include "household_objects_database/database_task.h"
+#include "household_objects_database/perturbation_cube.h"
+#include "household_objects_database/query_profiler.h"
 
 namespace household_objects_database
 {
@@ -70,18 +72,36 @@ namespace household_objects_database
   class DatabaseTask;
 
   //! A slight specialization of the general database interface with a few convenience functions added
+  /*! The query functions of the general interface are shadowed here by versions that report each
+    query to the query profiler. The functions of PostgresqlDatabase are not virtual, so queries made
+    through a reference to the base class are not profiled. */
   class ObjectsDatabase : public database_interface::PostgresqlDatabase
   {
+  private:
+    //! Statistics for the queries made through this connection; can be shared with other connections
+    boost::shared_ptr<QueryProfiler> profiler_;
+
+  protected:
+    //! Inserts all the instances, which must be of the same type, using multi-row INSERT statements
+    /*! Must be called from inside a transaction. Primary keys generated by the database are
+     drawn from the key's sequence before inserting, and set in the instances. */
+    bool
+    insertListIntoTable (const std::vector<database_interface::DBClass*> &instances);
+
+    //! Loads the perturbations matching \a where_clause into \a cube with a single query
+    bool
+    loadPerturbationCube (const std::string &where_clause, PerturbationCube &cube);
+
   public:
     //! Attempts to connect to the specified database
     ObjectsDatabase (std::string host, std::string port, std::string user, std::string password, std::string dbname) :
-      PostgresqlDatabase (host, port, user, password, dbname)
+      PostgresqlDatabase (host, port, user, password, dbname), profiler_ (new QueryProfiler)
     {
     }
 
     //! Attempts to connect to the specified database
     ObjectsDatabase (const database_interface::PostgresqlDatabaseConfig &config) :
-      PostgresqlDatabase (config)
+      PostgresqlDatabase (config), profiler_ (new QueryProfiler)
     {
     }
 
@@ -90,12 +110,159 @@ namespace household_objects_database
     {
     }
 
+    //! Reads the connection parameters used by the database node and tools from /household_objects_database/
+    static void
+    getConnectionParams (std::string &host, std::string &port, std::string &user, std::string &password,
+                         std::string &dbname);
+
+    //! The profiler for the queries made through this connection; disabled unless enabled here
+    QueryProfiler&
+    getProfiler () const
+    {
+      return *profiler_;
+    }
+
+    //! Replaces the profiler, e.g. to keep statistics across connections
+    /*! The profiler is not thread-safe; it should not be shared by connections used from
+      different threads. */
+    void
+    setProfiler (boost::shared_ptr<QueryProfiler> profiler)
+    {
+      profiler_ = profiler;
+    }
+
+    //------- the general interface, with each query reported to the profiler -------
+
+    template <class T>
+    bool
+    getList (std::vector<boost::shared_ptr<T> > &vec, const T &example, std::string where_clause) const
+    {
+      ProfiledQuery query (*profiler_);
+      bool success = PostgresqlDatabase::getList (vec, example, where_clause);
+      if (!query.active ()) return success;
+      size_t bytes = 0;
+      for (size_t i = 0; i < vec.size (); i++) bytes += QueryProfiler::encodedSize (vec[i].get ());
+      query.finish ("getList:" + example.getPrimaryKeyField ()->getTableName (), success, vec.size (), bytes,
+                    where_clause);
+      return success;
+    }
+
+    template <class T>
+    bool
+    getList (std::vector<boost::shared_ptr<T> > &vec, std::string where_clause = "") const
+    {
+      T example;
+      return getList (vec, example, where_clause);
+    }
+
+    bool
+    countList (const database_interface::DBClass *example, int &count, std::string where_clause) const
+    {
+      ProfiledQuery query (*profiler_);
+      bool success = PostgresqlDatabase::countList (example, count, where_clause);
+      query.finish ("countList:" + example->getPrimaryKeyField ()->getTableName (), success, 1, sizeof(count),
+                    where_clause);
+      return success;
+    }
+
+    bool
+    loadFromDatabase (database_interface::DBFieldBase *field) const
+    {
+      ProfiledQuery query (*profiler_);
+      bool success = PostgresqlDatabase::loadFromDatabase (field);
+      if (!query.active ()) return success;
+      query.finish ("loadFromDatabase:" + field->getTableName () + "." + field->getName (), success, 1,
+                    success ? QueryProfiler::encodedSize (field) : 0, "");
+      return success;
+    }
+
+    bool
+    saveToDatabase (const database_interface::DBFieldBase *field)
+    {
+      ProfiledQuery query (*profiler_);
+      bool success = PostgresqlDatabase::saveToDatabase (field);
+      if (!query.active ()) return success;
+      query.finish ("saveToDatabase:" + field->getTableName () + "." + field->getName (), success, 1,
+                    QueryProfiler::encodedSize (field), "");
+      return success;
+    }
+
+    bool
+    insertIntoDatabase (database_interface::DBClass *instance)
+    {
+      ProfiledQuery query (*profiler_);
+      bool success = PostgresqlDatabase::insertIntoDatabase (instance);
+      if (!query.active ()) return success;
+      query.finish ("insertIntoDatabase:" + instance->getPrimaryKeyField ()->getTableName (), success, 1,
+                    QueryProfiler::encodedSize (instance), "");
+      return success;
+    }
+
+    bool
+    deleteFromDatabase (database_interface::DBClass *instance)
+    {
+      ProfiledQuery query (*profiler_);
+      bool success = PostgresqlDatabase::deleteFromDatabase (instance);
+      if (!query.active ()) return success;
+      query.finish ("deleteFromDatabase:" + instance->getPrimaryKeyField ()->getTableName (), success, 1, 0, "");
+      return success;
+    }
+
     //! Acquires the next experiment to be executed from the list of tasks in the database
     /*! Also marks it as RUNNING in an atomic fashion, so that it is not acquired by
      another process.*/
     virtual bool
     acquireNextTask (std::vector<boost::shared_ptr<DatabaseTask> > &task);
 
+    //! Checks that the connection is still usable by running a trivial query
+    /*! Unlike isConnected(), this notices a connection that has been dropped by the server or
+     the network since it was last used. Not reported to the query profiler, as the periodic
+     health checks would swamp its summary. */
+    bool
+    ping () const;
+
+    //! Acquires up to \a max_tasks experiments to be executed and marks them all as RUNNING
+    /*! Uses a single UPDATE ... RETURNING statement with SKIP LOCKED, so that concurrent
+     workers never block on, or fight over, the same rows. An empty result is not an error;
+     it just means there are no more tasks to be run.*/
+    virtual bool
+    acquireNextTasks (std::vector<boost::shared_ptr<DatabaseTask> > &tasks, size_t max_tasks);
+
+    //! Inserts a list of instances of the same type into the database, all in one transaction
+    /*! Much faster than calling insertIntoDatabase(...) for each instance, as rows are sent in
+     large multi-row INSERT statements instead of one round trip per row. Primary keys obtained
+     from sequences are set in the instances on success. If anything fails, nothing is inserted.
+
+     Only classes whose writable fields all live in the table of the primary key are supported.*/
+    template <class T>
+    bool
+    insertListIntoDatabase (std::vector<boost::shared_ptr<T> > &instances)
+    {
+      std::vector<database_interface::DBClass*> raw_instances;
+      raw_instances.reserve (instances.size ());
+      for (size_t i = 0; i < instances.size (); i++)
+        raw_instances.push_back (instances[i].get ());
+      if (raw_instances.empty ())
+        return true;
+      ProfiledQuery query (*profiler_);
+      bool success = begin ();
+      if (success && !insertListIntoTable (raw_instances))
+      {
+        rollback ();
+        success = false;
+      }
+      else if (success)
+      {
+        success = commit ();
+      }
+      if (!query.active ()) return success;
+      size_t bytes = 0;
+      for (size_t i = 0; i < raw_instances.size (); i++) bytes += QueryProfiler::encodedSize (raw_instances[i]);
+      query.finish ("insertListIntoDatabase:" + raw_instances[0]->getPrimaryKeyField ()->getTableName (), success,
+                    raw_instances.size (), bytes, "");
+      return success;
+    }
+
     //------- helper functions wrapped around the general versions for convenience -------
     //----------------- or for cases where where_clauses are needed ----------------------
 
@@ -215,32 +382,39 @@ namespace household_objects_database
       return true;
     }
 
-    //! Gets the mesh for a scaled model as a arm_navigation_msgs::Shape
-    bool
-    getScaledModelMesh (int scaled_model_id, arm_navigation_msgs::Shape &shape) const
+    //! Converts a database mesh to a arm_navigation_msgs::Shape, reading the mesh data in place
+    static bool
+    meshToShape (const DatabaseMesh &mesh, arm_navigation_msgs::Shape &shape)
     {
-      DatabaseMesh mesh;
-      if (!getScaledModelMesh (scaled_model_id, mesh))
-        return false;
-      shape.triangles = mesh.triangles_.data ();
-      shape.vertices.clear ();
-      if (mesh.vertices_.data ().size () % 3 != 0)
+      if (!mesh.isValid ())
       {
         ROS_ERROR ("Get scaled model mesh: size of vertices vector is not a multiple of 3");
         return false;
       }
-      for (size_t i = 0; i < mesh.vertices_.data ().size () / 3; i++)
+      BlobSpan<int> triangles = mesh.triangles ();
+      shape.triangles.assign (triangles.begin (), triangles.end ());
+      BlobSpan<double> vertices = mesh.vertices ();
+      shape.vertices.resize (vertices.size () / 3);
+      for (size_t i = 0; i < shape.vertices.size (); i++)
       {
-        geometry_msgs::Point p;
-        p.x = mesh.vertices_.data ().at (3 * i + 0);
-        p.y = mesh.vertices_.data ().at (3 * i + 1);
-        p.z = mesh.vertices_.data ().at (3 * i + 2);
-        shape.vertices.push_back (p);
+        shape.vertices[i].x = vertices[3 * i + 0];
+        shape.vertices[i].y = vertices[3 * i + 1];
+        shape.vertices[i].z = vertices[3 * i + 2];
       }
       shape.type = shape.MESH;
       return true;
     }
 
+    //! Gets the mesh for a scaled model as a arm_navigation_msgs::Shape
+    bool
+    getScaledModelMesh (int scaled_model_id, arm_navigation_msgs::Shape &shape) const
+    {
+      DatabaseMesh mesh;
+      if (!getScaledModelMesh (scaled_model_id, mesh))
+        return false;
+      return meshToShape (mesh, shape);
+    }
+
     bool
     getModelScans (int scaled_model_id, std::string source,
                    std::vector<household_objects_database_msgs::DatabaseScan> &matching_scan_list) const
@@ -296,6 +470,42 @@ namespace household_objects_database
       return getList<DatabasePerturbation> (perturbations, example, where_clause);
     }
 
+    //! Gets the perturbations for all grasps for a given scaled model in columnar form
+    /*! Rows are parsed as they arrive from the database, without building an object for each
+      perturbation. If \a energy_function_id is not negative, only perturbations evaluated with
+      that energy function are loaded. */
+    bool
+    getPerturbationCubeForModel (int scaled_model_id, PerturbationCube &cube, int energy_function_id = -1)
+    {
+      std::string where_clause = std::string ("grasp_id = ANY(ARRAY(SELECT grasp_id FROM grasp WHERE "
+        "scaled_model_id = " + boost::lexical_cast<std::string> (scaled_model_id) + std::string ("))"));
+      if (energy_function_id >= 0)
+      {
+        where_clause += " AND energy_function_id = " + boost::lexical_cast<std::string> (energy_function_id);
+      }
+      return loadPerturbationCube (where_clause, cube);
+    }
+
+    //! Gets the perturbations for the given grasps in columnar form
+    bool
+    getPerturbationCubeForGrasps (const std::vector<int> &grasp_ids, PerturbationCube &cube, 
+                                  int energy_function_id = -1)
+    {
+      std::vector<std::string> grasp_id_strs;
+      grasp_id_strs.reserve (grasp_ids.size ());
+      BOOST_FOREACH(int id, grasp_ids)
+            {
+              grasp_id_strs.push_back (boost::lexical_cast<std::string, int> (id));
+            }
+      std::string where_clause = std::string ("grasp_id = ANY(ARRAY[" + boost::algorithm::join (grasp_id_strs, ", ")
+          + "]::integer[])");
+      if (energy_function_id >= 0)
+      {
+        where_clause += " AND energy_function_id = " + boost::lexical_cast<std::string> (energy_function_id);
+      }
+      return loadPerturbationCube (where_clause, cube);
+    }
+
     bool
     getVFHDescriptors (std::vector<boost::shared_ptr<DatabaseVFH> > &vfh)
     {
@@ -309,6 +519,7 @@ namespace household_objects_database
           ROS_ERROR ("Failed to load descriptor data for vfh id %d", vfh[i]->vfh_id_.data ());
         }
       }
+      return true;
     }
 
     bool
@@ -0,0 +1,127 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _PERTURBATION_CUBE_H_
+#define _PERTURBATION_CUBE_H_
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "household_objects_database/database_helper_classes.h"
+#include "household_objects_database/database_perturbation.h"
+
+namespace household_objects_database
+{
+
+  //! Perturbation analysis results for a set of grasps, stored by column and grouped by grasp
+  /*! Grasps are kept sorted by id. The perturbations of the grasp at index g occupy rows
+    rowBegin(g) to rowEnd(g)-1 of all columns, so per-grasp aggregates are computed over
+    contiguous ranges of the score array. Each row has NUM_DELTAS deltas, stored one row after
+    the other in a single array.
+   */
+  class PerturbationCube
+  {
+  public:
+    //! Number of deltas applied to the grasp pose in each perturbation
+    static const size_t NUM_DELTAS = 6;
+
+  private:
+    //! Ids of the grasps, in increasing order
+    std::vector<int> grasp_ids_;
+
+    //! Row at which the perturbations of each grasp begin; has one extra entry at the end
+    std::vector<size_t> grasp_offsets_;
+
+    //! Energy function used for each row
+    std::vector<int> energy_function_ids_;
+
+    //! Score for each row
+    std::vector<double> scores_;
+
+    //! Deltas for each row, NUM_DELTAS per row
+    std::vector<double> deltas_;
+
+  public:
+    PerturbationCube() : grasp_offsets_(1, 0) {}
+
+    void clear();
+
+    //! Reserves space for the given number of rows
+    void reserve(size_t num_rows);
+
+    //! Appends a perturbation; rows must be appended grouped by grasp, in increasing grasp id order
+    /*! Missing deltas are set to zero and extra ones are ignored. Returns false if the row is out of
+      order. */
+    bool appendRow(int grasp_id, int energy_function_id, double score, const double *deltas, size_t num_deltas);
+
+    //! Builds the cube from perturbations in any order, e.g. as returned by getList(...)
+    void setFromList(const std::vector<DatabasePerturbationPtr> &perturbations);
+
+    size_t numGrasps() const {return grasp_ids_.size();}
+
+    size_t numRows() const {return scores_.size();}
+
+    const std::vector<int>& graspIds() const {return grasp_ids_;}
+
+    //! Index of the grasp with the given id, or -1 if the cube has no perturbations for it
+    int findGrasp(int grasp_id) const;
+
+    size_t rowBegin(size_t grasp) const {return grasp_offsets_[grasp];}
+
+    size_t rowEnd(size_t grasp) const {return grasp_offsets_[grasp+1];}
+
+    const std::vector<double>& scores() const {return scores_;}
+
+    const std::vector<int>& energyFunctionIds() const {return energy_function_ids_;}
+
+    //! The deltas of a row
+    const double* deltas(size_t row) const {return &deltas_[row * NUM_DELTAS];}
+
+    //! Mean and variance of the scores of each grasp
+    void scoreStatistics(std::vector<double> &means, std::vector<double> &variances) const;
+
+    //! Fraction of the perturbations of each grasp with a score of at least \a min_score
+    void successRates(double min_score, std::vector<double> &rates) const;
+
+    //! Grasp ids ordered from most to least robust
+    /*! Grasps are ranked by mean score minus \a deviation_weight times the standard deviation of
+      the score, so that a positive weight favors grasps whose score changes little when the
+      grasp is perturbed. */
+    void rankGrasps(double deviation_weight, std::vector<int> &grasp_ids) const;
+  };
+
+}//namespace
+
+#endif
@@ -0,0 +1,140 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _QUERY_PROFILER_H_
+#define _QUERY_PROFILER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <ros/time.h>
+
+#include <database_interface/db_class.h>
+
+namespace household_objects_database
+{
+
+  //! Collects latency statistics for database queries, grouped by query type
+  /*! Disabled by default; queries are timed through ProfiledQuery, which checks enabled()
+    before doing any timing work, so that a disabled profiler costs a single test per query. Queries slower than the
+    slow query threshold are logged along with their WHERE clause. */
+  class QueryProfiler
+  {
+  public:
+    //! Upper bounds, in seconds, of the latency histogram buckets; the last bucket is unbounded
+    static const std::vector<double>& histogramBounds();
+
+    //! Statistics for one type of query
+    struct Stats
+    {
+      unsigned int count;
+      unsigned int failures;
+      uint64_t rows;
+      uint64_t bytes;
+      double total_time;
+      double max_time;
+      //! One more entry than histogramBounds()
+      std::vector<unsigned int> histogram;
+
+      Stats();
+    };
+
+  private:
+    bool enabled_;
+
+    //! Queries taking longer than this, in seconds, are logged
+    double slow_query_threshold_;
+
+    std::map<std::string, Stats> stats_;
+
+  public:
+    QueryProfiler() : enabled_(false), slow_query_threshold_(0.5) {}
+
+    bool enabled() const {return enabled_;}
+
+    void setEnabled(bool enabled) {enabled_ = enabled;}
+
+    void setSlowQueryThreshold(double seconds) {slow_query_threshold_ = seconds;}
+
+    //! Records a query of the given type
+    /*! \a rows and \a bytes are the number of rows and the size of the values decoded from
+      the result. */
+    void record(const std::string &type, double seconds, bool success, size_t rows, size_t bytes,
+                const std::string &where_clause);
+
+    const std::map<std::string, Stats>& stats() const {return stats_;}
+
+    void reset() {stats_.clear();}
+
+    //! The size of the values in all the fields of \a entry, in their database representation
+    static size_t encodedSize(database_interface::DBClass *entry);
+
+    //! The size of the value of \a field, in its database representation
+    static size_t encodedSize(const database_interface::DBFieldBase *field);
+  };
+
+  //! Times a single query, from construction until finish(), and records it in a profiler
+  /*! If the profiler is disabled nothing is done, not even reading the clock; callers should
+    check active() before computing what they would pass to finish(). */
+  class ProfiledQuery
+  {
+  private:
+    //! NULL if the profiler is disabled, or once the query has been recorded
+    QueryProfiler *profiler_;
+
+    ros::WallTime start_;
+
+  public:
+    explicit ProfiledQuery(QueryProfiler &profiler) : profiler_(profiler.enabled() ? &profiler : NULL)
+    {
+      if (profiler_) start_ = ros::WallTime::now();
+    }
+
+    bool active() const {return profiler_ != NULL;}
+
+    //! Records the query; see QueryProfiler::record(...)
+    void finish(const std::string &type, bool success, size_t rows, size_t bytes, const std::string &where_clause)
+    {
+      if (!profiler_) return;
+      profiler_->record(type, (ros::WallTime::now() - start_).toSec(), success, rows, bytes, where_clause);
+      profiler_ = NULL;
+    }
+  };
+
+}//namespace
+
+#endif
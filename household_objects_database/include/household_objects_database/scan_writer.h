@@ -0,0 +1,164 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef _SCAN_WRITER_H_
+#define _SCAN_WRITER_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <ros/ros.h>
+
+#include "household_objects_database/database_helper_classes.h"
+#include "household_objects_database/database_scan.h"
+
+namespace household_objects_database
+{
+
+  class ObjectsDatabase;
+
+  //! Writes scans to the database from a background thread, several of them per transaction
+  /*! Uses its own database connection, so that writing scans never holds up the other
+    services. Scans that can not be written because the database is unreachable are appended
+    to a local spool file, and written out, in order, once the database can be reached again.
+    The spool survives restarts of the node.
+  */
+  class ScanWriter
+  {
+  public:
+    typedef std::vector< boost::shared_ptr<DatabaseScan> > ScanList;
+
+    //! The counters reported by getStatus()
+    struct Status
+    {
+      //! Scans accepted but not yet written to the database or the spool
+      unsigned int pending;
+      unsigned int written;
+      unsigned int spooled;
+      unsigned int failed;
+      bool database_connected;
+      std::string last_error;
+    };
+
+  private:
+    //! Connection parameters, used to (re)connect
+    std::string host_, port_, user_, pass_, name_;
+
+    //! The connection used for writing scans; NULL while not connected
+    ObjectsDatabase *database_;
+
+    //! Earliest time for the next connection attempt
+    ros::WallTime next_connection_attempt_;
+
+    //! Scans that could not be written are appended to this file
+    std::string spool_file_;
+
+    //! At most this many scans are written in one transaction
+    size_t batch_size_;
+
+    //! How long to wait between attempts to reach the database
+    double retry_interval_;
+
+    //! Guards all the members below
+    boost::mutex mutex_;
+
+    //! Signaled when scans are added to the queue, or when the writer should stop
+    boost::condition_variable work_condition_;
+
+    //! Signaled when all queued scans have been written or spooled
+    boost::condition_variable idle_condition_;
+
+    //! Scans waiting to be written
+    std::deque< boost::shared_ptr<DatabaseScan> > queue_;
+
+    //! Scans taken off the queue by the writer thread, not yet written or spooled
+    size_t in_progress_;
+
+    unsigned int written_, spooled_, failed_;
+    bool connected_;
+    std::string last_error_;
+    bool stop_;
+
+    boost::thread thread_;
+
+    void setError(const std::string &error);
+
+    void setConnected(bool connected);
+
+    //! Connects to the database if needed; attempts are spaced by the retry interval
+    bool connect();
+
+    void disconnect();
+
+    //! Writes \a scans in one transaction
+    /*! Returns false if the scans should be kept and retried later, i.e. the database could
+      not be reached. Scans that the database itself refuses are counted as failed, as
+      retrying them would not help. */
+    bool writeScans(ScanList &scans);
+
+    //! Appends \a scans to the spool file
+    void spoolScans(const ScanList &scans);
+
+    //! Reads all the complete records in the spool file
+    void readSpool(ScanList &scans);
+
+    //! Writes out the spool file, if there is one; returns true if it is empty afterwards
+    bool writeSpool();
+
+    //! The main function of the writer thread
+    void run();
+
+  public:
+    //! Reads the spool file left over from a previous run, if any, and starts the writer thread
+    ScanWriter(std::string host, std::string port, std::string user, std::string pass, std::string name,
+               std::string spool_file, size_t batch_size, double retry_interval);
+
+    //! Writes or spools all queued scans before returning
+    ~ScanWriter();
+
+    //! Queues scans for writing; returns immediately
+    void enqueue(const ScanList &scans);
+
+    //! Optionally waits until all queued scans are written or spooled, then reports the counters
+    /*! A timeout of zero means wait forever. Returns false if waiting timed out. */
+    bool getStatus(bool wait_for_completion, ros::Duration timeout, Status &status);
+  };
+
+} //namespace
+
+#endif
@@ -38,9 +38,17 @@
 //! as ROS services
 
 #include <vector>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <cmath>
+#include <cstdlib>
 #include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 
 #include <tf/transform_datatypes.h>
 #include <tf/transform_listener.h>
@@ -55,6 +63,12 @@
 #include <household_objects_database_msgs/SaveScan.h>
 
 #include "household_objects_database/objects_database.h"
+#include "household_objects_database/local_objects_database.h"
+#include "household_objects_database/scan_writer.h"
+#include "household_objects_database/SaveScanList.h"
+#include "household_objects_database/GetScanQueueStatus.h"
+#include "household_objects_database/GetDatabaseConnectionStatus.h"
+#include "household_objects_database/GetQueryProfile.h"
 
 const std::string GET_MODELS_SERVICE_NAME = "get_model_list";
 const std::string GET_MESH_SERVICE_NAME = "get_model_mesh";
@@ -62,6 +76,10 @@ const std::string GET_DESCRIPTION_SERVICE_NAME = "get_model_description";
 const std::string GRASP_PLANNING_SERVICE_NAME = "database_grasp_planning";
 const std::string GET_SCANS_SERVICE_NAME = "get_model_scans";
 const std::string SAVE_SCAN_SERVICE_NAME = "save_model_scan";
+const std::string SAVE_SCAN_LIST_SERVICE_NAME = "save_model_scan_list";
+const std::string SCAN_QUEUE_STATUS_SERVICE_NAME = "get_scan_queue_status";
+const std::string CONNECTION_STATUS_SERVICE_NAME = "get_connection_status";
+const std::string QUERY_PROFILE_SERVICE_NAME = "get_query_profile";
 
 using namespace household_objects_database_msgs;
 using namespace household_objects_database;
@@ -156,9 +174,53 @@ private:
   //! Server for the save scan service
   ros::ServiceServer save_scan_srv_;
 
+  //! Server for the save scan list service
+  ros::ServiceServer save_scan_list_srv_;
+
+  //! Server for the scan queue status service
+  ros::ServiceServer scan_queue_status_srv_;
+
+  //! Server for the connection status service
+  ros::ServiceServer connection_status_srv_;
+
+  //! Server for the query profile service
+  ros::ServiceServer query_profile_srv_;
+
   //! The database connection itself
   ObjectsDatabase *database_;
 
+  //! Local read-only replica; if loaded, model queries are served from it instead of the database
+  LocalObjectsDatabase *local_database_;
+
+  //! Writes saved scans in the background; if NULL, scans are written as they are received
+  ScanWriter *scan_writer_;
+
+  //! The scan queue status service waits for the scan writer, so it is served from this queue
+  ros::CallbackQueue scan_status_queue_;
+
+  //! Serves scan_status_queue_ from its own thread
+  ros::AsyncSpinner *scan_status_spinner_;
+
+  //! Connection parameters, kept for reconnecting
+  std::string database_host_, database_port_, database_user_, database_pass_, database_name_;
+
+  //! Periodically checks the database connection, and reconnects if needed
+  ros::WallTimer health_check_timer_;
+
+  //! Earliest time for the next connection attempt
+  ros::WallTime next_connection_attempt_;
+
+  //! Delay between connection attempts; doubles after each failure, up to the maximum
+  double reconnect_delay_, min_reconnect_delay_, max_reconnect_delay_;
+
+  //! Connection metrics, reported by the connection status service
+  unsigned int connection_attempts_, connection_losses_, failed_queries_, retried_queries_;
+  ros::Time last_state_change_;
+  std::string last_connection_error_;
+
+  //! Query statistics, kept across reconnections
+  boost::shared_ptr<QueryProfiler> profiler_;
+
   //! Transform listener
   tf::TransformListener listener_;
 
@@ -168,16 +230,135 @@ private:
   //! Threshold for pruning grasps based on table clearance
   double prune_table_clearance_;
 
+  //! Grasps closer than this (in meters) may be duplicates; 0 disables deduplication by pose
+  double dedup_position_tolerance_;
+
+  //! Grasps whose orientations differ by less than this (in radians) may be duplicates
+  double dedup_angle_tolerance_;
+
+  //! Grasps whose joint values all differ by less than this may be duplicates
+  double dedup_posture_tolerance_;
+
+  //! Opens a new database connection; on failure, backs off before the next attempt
+  bool connectDatabase()
+  {
+    connection_attempts_++;
+    database_ = new ObjectsDatabase(database_host_, database_port_, database_user_, 
+                                    database_pass_, database_name_);
+    database_->setProfiler(profiler_);
+    if (database_->isConnected())
+    {
+      ROS_INFO("ObjectsDatabaseNode: connected to database on host %s", database_host_.c_str());
+      reconnect_delay_ = min_reconnect_delay_;
+      last_state_change_ = ros::Time::now();
+      return true;
+    }
+    delete database_; database_ = NULL;
+    std::stringstream error;
+    error << "failed to open model database on host " << database_host_ << ", port " << database_port_ 
+          << ", user " << database_user_ << ", database " << database_name_ 
+          << "; next attempt in " << reconnect_delay_ << " seconds";
+    last_connection_error_ = error.str();
+    ROS_ERROR("ObjectsDatabaseNode: %s", last_connection_error_.c_str());
+    next_connection_attempt_ = ros::WallTime::now() + ros::WallDuration(reconnect_delay_);
+    reconnect_delay_ = std::min(2.0 * reconnect_delay_, max_reconnect_delay_);
+    return false;
+  }
+
+  //! Drops a connection that is no longer usable
+  void connectionLost()
+  {
+    ROS_ERROR("ObjectsDatabaseNode: lost connection to database");
+    last_connection_error_ = "lost connection to database";
+    delete database_; database_ = NULL;
+    connection_losses_++;
+    last_state_change_ = ros::Time::now();
+    next_connection_attempt_ = ros::WallTime::now();
+  }
+
+  //! Pings the database, and reconnects when the time comes if the connection is down
+  void healthCheckCB(const ros::WallTimerEvent &)
+  {
+    if (database_)
+    {
+      if (database_->ping()) return;
+      connectionLost();
+    }
+    if (ros::WallTime::now() >= next_connection_attempt_) connectDatabase();
+  }
+
+  //! To be called after a query failed; returns true if the query should be tried again
+  /*! If the failure was due to a lost connection, reconnects right away. Only queries that
+    are safe to repeat, i.e. reads, should be retried, and only once. */
+  bool retryAfterFailure(bool idempotent)
+  {
+    failed_queries_++;
+    if (!database_ || database_->ping()) return false;
+    connectionLost();
+    if (!connectDatabase() || !idempotent) return false;
+    retried_queries_++;
+    ROS_INFO("ObjectsDatabaseNode: reconnected to database, retrying query");
+    return true;
+  }
+
+  //! Callback for the connection status service
+  bool connectionStatusCB(GetDatabaseConnectionStatus::Request &request, 
+                          GetDatabaseConnectionStatus::Response &response)
+  {
+    response.connected = (database_ != NULL);
+    response.local_replica = (local_database_ != NULL);
+    response.connection_attempts = connection_attempts_;
+    response.connection_losses = connection_losses_;
+    response.failed_queries = failed_queries_;
+    response.retried_queries = retried_queries_;
+    response.last_state_change = last_state_change_;
+    if (!database_) response.reconnect_delay = ros::Duration(std::max(0.0, (next_connection_attempt_ - ros::WallTime::now()).toSec()));
+    response.last_error = last_connection_error_;
+    return true;
+  }
+
+  //! Callback for the query profile service
+  bool queryProfileCB(GetQueryProfile::Request &request, GetQueryProfile::Response &response)
+  {
+    response.histogram_bounds = QueryProfiler::histogramBounds();
+    std::map<std::string, QueryProfiler::Stats>::const_iterator it;
+    for (it = profiler_->stats().begin(); it != profiler_->stats().end(); it++)
+    {
+      const QueryProfiler::Stats &stats = it->second;
+      response.query_types.push_back(it->first);
+      response.counts.push_back(stats.count);
+      response.failures.push_back(stats.failures);
+      response.rows.push_back(stats.rows);
+      response.bytes.push_back(stats.bytes);
+      response.mean_times.push_back(stats.count ? stats.total_time / stats.count : 0.0);
+      response.max_times.push_back(stats.max_time);
+      response.histograms.insert(response.histograms.end(), stats.histogram.begin(), stats.histogram.end());
+    }
+    if (request.reset) profiler_->reset();
+    return true;
+  }
+
   //! Callback for the get models service
   bool getModelsCB(GetModelList::Request &request, GetModelList::Response &response)
   {
-    if (!database_)
+    if (!database_ && !local_database_)
     {
       response.return_code.code = response.return_code.DATABASE_NOT_CONNECTED;
       return true;
     }
     std::vector< boost::shared_ptr<DatabaseScaledModel> > models;
-    if (!database_->getScaledModelsBySet(models, request.model_set))
+    bool success;
+    if (local_database_) success = local_database_->getScaledModelsBySet(models, request.model_set);
+    else 
+    {
+      success = database_->getScaledModelsBySet(models, request.model_set);
+      if (!success && retryAfterFailure(true))
+      {
+        models.clear();
+        success = database_->getScaledModelsBySet(models, request.model_set);
+      }
+    }
+    if (!success)
     {
       response.return_code.code = response.return_code.DATABASE_QUERY_ERROR;
       return true;
@@ -193,12 +374,19 @@ private:
   //! Callback for the get mesh service
   bool getMeshCB(GetModelMesh::Request &request, GetModelMesh::Response &response)
   {
-    if (!database_)
+    if (!database_ && !local_database_)
     {
       response.return_code.code = response.return_code.DATABASE_NOT_CONNECTED;
       return true;
     }
-    if ( !database_->getScaledModelMesh(request.model_id, response.mesh) )
+    bool success;
+    if (local_database_) success = local_database_->getScaledModelMesh(request.model_id, response.mesh);
+    else
+    {
+      success = database_->getScaledModelMesh(request.model_id, response.mesh);
+      if (!success && retryAfterFailure(true)) success = database_->getScaledModelMesh(request.model_id, response.mesh);
+    }
+    if (!success)
     {
       response.return_code.code = response.return_code.DATABASE_QUERY_ERROR;
       return true;
@@ -210,17 +398,32 @@ private:
   //! Callback for the get description service
   bool getDescriptionCB(GetModelDescription::Request &request, GetModelDescription::Response &response)
   {
-    if (!database_)
+    if (!database_ && !local_database_)
     {
       response.return_code.code = response.return_code.DATABASE_NOT_CONNECTED;
       return true;
     }
     std::vector< boost::shared_ptr<DatabaseScaledModel> > models;
     
-    std::stringstream id;
-    id << request.model_id;
-    std::string where_clause("scaled_model_id=" + id.str());
-    if (!database_->getList(models, where_clause) || models.size() != 1)
+    bool success;
+    if (local_database_)
+    {
+      models.resize(1);
+      success = local_database_->getScaledModel(request.model_id, models[0]);
+    }
+    else
+    {
+      std::stringstream id;
+      id << request.model_id;
+      std::string where_clause("scaled_model_id=" + id.str());
+      success = database_->getList(models, where_clause);
+      if (!success && retryAfterFailure(true))
+      {
+        models.clear();
+        success = database_->getList(models, where_clause);
+      }
+    }
+    if (!success || models.size() != 1)
     {
       response.return_code.code = response.return_code.DATABASE_QUERY_ERROR;
       return true;
@@ -246,23 +449,81 @@ private:
     return true;
   }
 
-  bool saveScanCB(SaveScan::Request &request, SaveScan::Response &response)
+  //! Converts a scan message into a database scan
+  static boost::shared_ptr<household_objects_database::DatabaseScan>
+    scanFromMsg(const household_objects_database_msgs::DatabaseScan &msg)
   {
+    boost::shared_ptr<household_objects_database::DatabaseScan> scan(new household_objects_database::DatabaseScan);
+    scan->frame_id_.get() = msg.pose.header.frame_id;
+    scan->cloud_topic_.get() = msg.cloud_topic;
+    scan->object_pose_.get().pose_ = msg.pose.pose;
+    scan->scaled_model_id_.get() = msg.model_id;
+    scan->scan_bagfile_location_.get() = msg.bagfile_location;
+    scan->scan_source_.get() = msg.scan_source;
+    return scan;
+  }
+
+  //! Hands the scans over to the writer thread, or writes them right away if there is none
+  int saveScans(std::vector< boost::shared_ptr<household_objects_database::DatabaseScan> > &scans)
+  {
+    if (scan_writer_)
+    {
+      scan_writer_->enqueue(scans);
+      return DatabaseReturnCode::SUCCESS;
+    }
     if (!database_)
     {
       ROS_ERROR("SaveScan: database not connected");
-      response.return_code.code = DatabaseReturnCode::DATABASE_NOT_CONNECTED;
+      return DatabaseReturnCode::DATABASE_NOT_CONNECTED;
+    }
+    if (!database_->insertListIntoDatabase(scans))
+    {
+      //the insert is not repeated, but a lost connection should still be noticed
+      retryAfterFailure(false);
+      ROS_ERROR("SaveScan: failed to insert %u scans into database", (unsigned int)scans.size());
+      return DatabaseReturnCode::DATABASE_QUERY_ERROR;
+    }
+    return DatabaseReturnCode::SUCCESS;
+  }
+
+  bool saveScanCB(SaveScan::Request &request, SaveScan::Response &response)
+  {
+    household_objects_database_msgs::DatabaseScan msg;
+    msg.pose = request.ground_truth_pose;
+    msg.cloud_topic = request.cloud_topic;
+    msg.model_id = request.scaled_model_id;
+    msg.bagfile_location = request.bagfile_location;
+    msg.scan_source = request.scan_source;
+    std::vector< boost::shared_ptr<household_objects_database::DatabaseScan> > scans(1, scanFromMsg(msg));
+    response.return_code.code = saveScans(scans);
+    return true;
+  }
+
+  bool saveScanListCB(SaveScanList::Request &request, SaveScanList::Response &response)
+  {
+    std::vector< boost::shared_ptr<household_objects_database::DatabaseScan> > scans;
+    for (size_t i=0; i<request.scans.size(); i++) scans.push_back(scanFromMsg(request.scans[i]));
+    response.return_code.code = saveScans(scans);
+    return true;
+  }
+
+  bool scanQueueStatusCB(GetScanQueueStatus::Request &request, GetScanQueueStatus::Response &response)
+  {
+    if (!scan_writer_)
+    {
+      //scans are written synchronously, there is never anything pending
+      response.completed = true;
+      response.database_connected = (database_ != NULL);
       return true;
     }
-    household_objects_database::DatabaseScan scan;
-    scan.frame_id_.get() = request.ground_truth_pose.header.frame_id;
-    scan.cloud_topic_.get() = request.cloud_topic;
-    scan.object_pose_.get().pose_ = request.ground_truth_pose.pose;
-    scan.scaled_model_id_.get() = request.scaled_model_id;
-    scan.scan_bagfile_location_.get() = request.bagfile_location;
-    scan.scan_source_.get() = request.scan_source;
-    database_->insertIntoDatabase(&scan);
-    response.return_code.code = DatabaseReturnCode::SUCCESS;
+    ScanWriter::Status status;
+    response.completed = scan_writer_->getStatus(request.wait_for_completion, request.timeout, status);
+    response.pending = status.pending;
+    response.written = status.written;
+    response.spooled = status.spooled;
+    response.failed = status.failed;
+    response.database_connected = status.database_connected;
+    response.last_error = status.last_error;
     return true;
   }
 
@@ -295,6 +556,100 @@ private:
     ROS_INFO("Database grasp planner: pruned %d grasps for table collision or gripper angle above threshold", pruned);
   }
 
+  //! Whether two grasps are within the deduplication tolerances of each other
+  bool similarGrasps(const DatabaseGrasp &g1, const DatabaseGrasp &g2)
+  {
+    const geometry_msgs::Pose &p1 = g1.final_grasp_pose_.get().pose_;
+    const geometry_msgs::Pose &p2 = g2.final_grasp_pose_.get().pose_;
+    double dx = p1.position.x - p2.position.x;
+    double dy = p1.position.y - p2.position.y;
+    double dz = p1.position.z - p2.position.z;
+    if (dx*dx + dy*dy + dz*dz > dedup_position_tolerance_ * dedup_position_tolerance_) return false;
+    //angle between the orientations, from the dot product of the quaternions
+    double dot = fabs(p1.orientation.x * p2.orientation.x + p1.orientation.y * p2.orientation.y +
+                      p1.orientation.z * p2.orientation.z + p1.orientation.w * p2.orientation.w);
+    if (2.0 * acos(std::min(dot, 1.0)) > dedup_angle_tolerance_) return false;
+    const std::vector<double> &j1 = g1.final_grasp_posture_.get().joint_angles_;
+    const std::vector<double> &j2 = g2.final_grasp_posture_.get().joint_angles_;
+    if (j1.size() != j2.size()) return false;
+    for (size_t i=0; i<j1.size(); i++)
+    {
+      if (fabs(j1[i] - j2[i]) > dedup_posture_tolerance_) return false;
+    }
+    return true;
+  }
+
+  //! Removes grasps that are equivalent to, or very close to, other grasps in the list
+  /*! Compliant copies are dropped if their original grasp is also in the list. Then, going from
+    best to worst scaled quality, a grasp is dropped if it is similar to one already kept; kept
+    grasps are hashed on a grid with the position tolerance as cell size, so only the grasps in
+    neighboring cells need to be compared. The survivors keep their original order.
+  */
+  virtual void deduplicateGraspList(std::vector< boost::shared_ptr<DatabaseGrasp> > &grasps)
+  {
+    size_t initial_size = grasps.size();
+    std::vector<bool> keep(grasps.size(), true);
+
+    std::set<int> ids;
+    for (size_t i=0; i<grasps.size(); i++) ids.insert(grasps[i]->id_.get());
+    for (size_t i=0; i<grasps.size(); i++)
+    {
+      if (grasps[i]->compliant_copy_.get() && ids.count(grasps[i]->compliant_original_id_.get())) keep[i] = false;
+    }
+
+    if (dedup_position_tolerance_ > 0)
+    {
+      std::vector< std::pair<double, size_t> > order;
+      for (size_t i=0; i<grasps.size(); i++)
+      {
+        if (keep[i]) order.push_back( std::make_pair(-grasps[i]->scaled_quality_.get(), i) );
+      }
+      std::sort(order.begin(), order.end());
+
+      //grid cell coordinates are packed in a single key, 21 bits each
+      std::map<int64_t, std::vector<size_t> > grid;
+      for (size_t o=0; o<order.size(); o++)
+      {
+        size_t i = order[o].second;
+        const geometry_msgs::Point &position = grasps[i]->final_grasp_pose_.get().pose_.position;
+        int64_t cell[3] = { (int64_t)floor(position.x / dedup_position_tolerance_),
+                            (int64_t)floor(position.y / dedup_position_tolerance_),
+                            (int64_t)floor(position.z / dedup_position_tolerance_) };
+        for (int dx=-1; dx<=1 && keep[i]; dx++)
+        {
+          for (int dy=-1; dy<=1 && keep[i]; dy++)
+          {
+            for (int dz=-1; dz<=1 && keep[i]; dz++)
+            {
+              std::map<int64_t, std::vector<size_t> >::const_iterator it = 
+                grid.find(gridKey(cell[0]+dx, cell[1]+dy, cell[2]+dz));
+              if (it == grid.end()) continue;
+              for (size_t k=0; k<it->second.size() && keep[i]; k++)
+              {
+                if (similarGrasps(*grasps[i], *grasps[it->second[k]])) keep[i] = false;
+              }
+            }
+          }
+        }
+        if (keep[i]) grid[gridKey(cell[0], cell[1], cell[2])].push_back(i);
+      }
+    }
+
+    size_t kept = 0;
+    for (size_t i=0; i<grasps.size(); i++)
+    {
+      if (keep[i]) grasps[kept++] = grasps[i];
+    }
+    grasps.resize(kept);
+    ROS_INFO("Database grasp planner: removed %u duplicate grasps", (unsigned int)(initial_size - kept));
+  }
+
+  static int64_t gridKey(int64_t x, int64_t y, int64_t z)
+  {
+    const int64_t mask = (1 << 21) - 1;
+    return ((x & mask) << 42) | ((y & mask) << 21) | (z & mask);
+  }
+
   geometry_msgs::Pose multiplyPoses(const geometry_msgs::Pose &p1, 
                                     const geometry_msgs::Pose &p2)
   {
@@ -311,7 +666,7 @@ private:
   //! Callback for the get grasps service
   bool graspPlanningCB(GraspPlanning::Request &request, GraspPlanning::Response &response)
   {
-    if (!database_)
+    if (!database_ && !local_database_)
     {
       ROS_ERROR("Database grasp planning: database not connected");
       response.error_code.value = response.error_code.OTHER_ERROR;
@@ -337,7 +692,18 @@ private:
     
     //retrieve the raw grasps from the database
     std::vector< boost::shared_ptr<DatabaseGrasp> > grasps;
-    if (!database_->getClusterRepGrasps(model_id, hand_id, grasps))
+    bool success;
+    if (local_database_) success = local_database_->getClusterRepGrasps(model_id, hand_id, grasps);
+    else
+    {
+      success = database_->getClusterRepGrasps(model_id, hand_id, grasps);
+      if (!success && retryAfterFailure(true))
+      {
+        grasps.clear();
+        success = database_->getClusterRepGrasps(model_id, hand_id, grasps);
+      }
+    }
+    if (!success)
     {
       ROS_ERROR("Database grasp planning: database query error");
       response.error_code.value = response.error_code.OTHER_ERROR;
@@ -348,6 +714,9 @@ private:
     //prune the retrieved grasps
     pruneGraspList(grasps, prune_gripper_opening_, prune_table_clearance_);
 
+    //drop grasps that would just repeat the evaluation of another one
+    deduplicateGraspList(grasps);
+
     //convert to the Grasp data type
     std::vector< boost::shared_ptr<DatabaseGrasp> >::iterator it;
     for (it = grasps.begin(); it != grasps.end(); it++)
@@ -472,26 +841,78 @@ private:
   }
 
 public:
-  ObjectsDatabaseNode() : priv_nh_("~"), root_nh_("")
+  ObjectsDatabaseNode() : priv_nh_("~"), root_nh_(""), database_(NULL), local_database_(NULL),
+                          scan_writer_(NULL), scan_status_spinner_(NULL), connection_attempts_(0), connection_losses_(0),
+                          failed_queries_(0), retried_queries_(0), profiler_(new QueryProfiler)
   {
+    //if a local replica is given, serve model queries from it without connecting to the database
+    std::string local_database_file;
+    priv_nh_.param<std::string>("local_database_file", local_database_file, "");
+    if (!local_database_file.empty())
+    {
+      local_database_ = new LocalObjectsDatabase();
+      if (!local_database_->loadFromFile(local_database_file))
+      {
+        ROS_ERROR("ObjectsDatabaseNode: failed to load local database replica from %s. "
+                  "Falling back on database connection.", local_database_file.c_str());
+        delete local_database_; local_database_ = NULL;
+      }
+    }
+
     //initialize database connection
-    std::string database_host, database_port, database_user, database_pass, database_name;
-    root_nh_.param<std::string>("/household_objects_database/database_host", database_host, "");
-    int port_int;
-    root_nh_.param<int>("/household_objects_database/database_port", port_int, -1);
-    std::stringstream ss; ss << port_int; database_port = ss.str();
-    root_nh_.param<std::string>("/household_objects_database/database_user", database_user, "");
-    root_nh_.param<std::string>("/household_objects_database/database_pass", database_pass, "");
-    root_nh_.param<std::string>("/household_objects_database/database_name", database_name, "");
-    database_ = new ObjectsDatabase(database_host, database_port, database_user, database_pass, database_name);
-    if (!database_->isConnected())
-    {
-      ROS_ERROR("ObjectsDatabaseNode: failed to open model database on host "
-		"%s, port %s, user %s with password %s, database %s. Unable to do grasp "
-		"planning on database recognized objects. Exiting.",
-		database_host.c_str(), database_port.c_str(), 
-		database_user.c_str(), database_pass.c_str(), database_name.c_str());
-      delete database_; database_ = NULL;
+    ObjectsDatabase::getConnectionParams(database_host_, database_port_, database_user_, database_pass_, 
+                                         database_name_);
+    priv_nh_.param<double>("min_reconnect_delay", min_reconnect_delay_, 1.0);
+    priv_nh_.param<double>("max_reconnect_delay", max_reconnect_delay_, 60.0);
+    reconnect_delay_ = min_reconnect_delay_;
+    last_state_change_ = ros::Time::now();
+    bool profile_queries;
+    priv_nh_.param<bool>("profile_queries", profile_queries, false);
+    profiler_->setEnabled(profile_queries);
+    double slow_query_threshold;
+    priv_nh_.param<double>("slow_query_threshold", slow_query_threshold, 0.5);
+    profiler_->setSlowQueryThreshold(slow_query_threshold);
+    if (!local_database_)
+    {
+      if (!connectDatabase())
+      {
+        ROS_ERROR("ObjectsDatabaseNode: unable to do grasp planning on database recognized objects "
+                  "until the database can be reached");
+      }
+      //the connection is checked periodically, and re-established if it drops
+      double health_check_interval;
+      priv_nh_.param<double>("health_check_interval", health_check_interval, 5.0);
+      if (health_check_interval > 0)
+      {
+        health_check_timer_ = priv_nh_.createWallTimer(ros::WallDuration(health_check_interval),
+                                                       &ObjectsDatabaseNode::healthCheckCB, this);
+      }
+    }
+
+    //if enabled, saved scans are written from a separate thread and connection, and spooled locally
+    //while the database can not be reached; the save services then only report that the scans were
+    //accepted, and the outcome must be checked with the scan queue status service
+    //there is no database to write to when serving from a local replica
+    bool async_scan_writes;
+    priv_nh_.param<bool>("async_scan_writes", async_scan_writes, false);
+    if (async_scan_writes && local_database_)
+    {
+      ROS_WARN("ObjectsDatabaseNode: async_scan_writes ignored, scans can not be saved to a local replica");
+    }
+    else if (async_scan_writes)
+    {
+      std::string spool_file;
+      const char *ros_home = getenv("ROS_HOME");
+      const char *home = getenv("HOME");
+      std::string default_spool_file = (ros_home ? std::string(ros_home) : std::string(home ? home : "") + "/.ros") +
+        "/objects_database_scan_spool";
+      priv_nh_.param<std::string>("scan_spool_file", spool_file, default_spool_file);
+      int batch_size;
+      priv_nh_.param<int>("scan_batch_size", batch_size, 50);
+      double retry_interval;
+      priv_nh_.param<double>("scan_retry_interval", retry_interval, 5.0);
+      scan_writer_ = new ScanWriter(database_host_, database_port_, database_user_, database_pass_, database_name_,
+                                    spool_file, std::max(batch_size, 1), retry_interval);
     }
 
     //advertise services
@@ -506,14 +927,43 @@ public:
                                                &ObjectsDatabaseNode::getScansCB, this);
     save_scan_srv_ = priv_nh_.advertiseService(SAVE_SCAN_SERVICE_NAME,
                                                &ObjectsDatabaseNode::saveScanCB, this);
+    save_scan_list_srv_ = priv_nh_.advertiseService(SAVE_SCAN_LIST_SERVICE_NAME,
+                                                    &ObjectsDatabaseNode::saveScanListCB, this);
+    if (scan_writer_)
+    {
+      //waiting for the scan writer can take a while, so this service is served from its own 
+      //thread instead of holding up all the others
+      ros::AdvertiseServiceOptions options = ros::AdvertiseServiceOptions::create<GetScanQueueStatus>(
+        SCAN_QUEUE_STATUS_SERVICE_NAME, boost::bind(&ObjectsDatabaseNode::scanQueueStatusCB, this, _1, _2),
+        ros::VoidConstPtr(), &scan_status_queue_);
+      scan_queue_status_srv_ = priv_nh_.advertiseService(options);
+      scan_status_spinner_ = new ros::AsyncSpinner(1, &scan_status_queue_);
+      scan_status_spinner_->start();
+    }
+    else
+    {
+      scan_queue_status_srv_ = priv_nh_.advertiseService(SCAN_QUEUE_STATUS_SERVICE_NAME,
+                                                         &ObjectsDatabaseNode::scanQueueStatusCB, this);
+    }
+    connection_status_srv_ = priv_nh_.advertiseService(CONNECTION_STATUS_SERVICE_NAME,
+                                                       &ObjectsDatabaseNode::connectionStatusCB, this);
+    query_profile_srv_ = priv_nh_.advertiseService(QUERY_PROFILE_SERVICE_NAME,
+                                                   &ObjectsDatabaseNode::queryProfileCB, this);
 
     priv_nh_.param<double>("prune_gripper_opening", prune_gripper_opening_, 0.5);
     priv_nh_.param<double>("prune_table_clearance", prune_table_clearance_, 0.0);
+    priv_nh_.param<double>("dedup_position_tolerance", dedup_position_tolerance_, 0.005);
+    priv_nh_.param<double>("dedup_angle_tolerance", dedup_angle_tolerance_, 0.1);
+    priv_nh_.param<double>("dedup_posture_tolerance", dedup_posture_tolerance_, 0.05);
   }
 
   ~ObjectsDatabaseNode()
   {
+    delete scan_status_spinner_;
+    scan_queue_status_srv_.shutdown();
+    delete scan_writer_;
     delete database_;
+    delete local_database_;
   }
 };
 
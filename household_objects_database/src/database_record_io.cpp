@@ -0,0 +1,142 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "household_objects_database/database_record_io.h"
+
+#include <algorithm>
+
+#include <ros/ros.h>
+
+using namespace database_interface;
+
+namespace household_objects_database {
+
+//! Largest block read from a file in one go; lengths stored in files are not trusted for allocation
+static const size_t READ_CHUNK_SIZE = 1 << 16;
+
+void writeUInt(std::ostream &str, uint32_t value)
+{
+  str.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool readUInt(std::istream &str, uint32_t &value)
+{
+  str.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return str.good();
+}
+
+void writeBytes(std::ostream &str, const char *data, size_t length)
+{
+  writeUInt(str, length);
+  if (length) str.write(data, length);
+}
+
+bool readBytes(std::istream &str, std::string &data)
+{
+  uint32_t length;
+  if (!readUInt(str, length)) return false;
+  //a corrupt length runs into the end of the file after at most one extra chunk, rather than
+  //allocating the whole block up front
+  data.clear();
+  while (data.size() < length)
+  {
+    size_t offset = data.size();
+    size_t chunk = std::min<size_t>(length - offset, READ_CHUNK_SIZE);
+    data.resize(offset + chunk);
+    str.read(&data[offset], chunk);
+    if (!str.good()) return false;
+  }
+  return true;
+}
+
+//! Returns the primary key followed by all the other fields of \a entry
+static std::vector<DBFieldBase*> allFields(DBClass *entry)
+{
+  std::vector<DBFieldBase*> fields;
+  fields.push_back(entry->getPrimaryKeyField());
+  for (size_t i=0; i<entry->getNumFields(); i++) fields.push_back(entry->getField(i));
+  return fields;
+}
+
+bool writeRecord(std::ostream &str, DBClass *entry)
+{
+  std::vector<DBFieldBase*> fields = allFields(entry);
+  writeUInt(str, fields.size());
+  for (size_t i=0; i<fields.size(); i++)
+  {
+    writeBytes(str, fields[i]->getName().c_str(), fields[i]->getName().size());
+    if (fields[i]->getType() == DBFieldBase::BINARY)
+    {
+      const char *binary = NULL;
+      size_t length = 0;
+      if (!fields[i]->toBinary(binary, length)) return false;
+      writeBytes(str, binary, length);
+    }
+    else
+    {
+      std::string value;
+      if (!fields[i]->toString(value)) return false;
+      writeBytes(str, value.c_str(), value.size());
+    }
+  }
+  return true;
+}
+
+bool readRecord(std::istream &str, DBClass *entry)
+{
+  std::vector<DBFieldBase*> fields = allFields(entry);
+  uint32_t num_fields;
+  if (!readUInt(str, num_fields)) return false;
+  for (uint32_t f=0; f<num_fields; f++)
+  {
+    std::string name, value;
+    if (!readBytes(str, name) || !readBytes(str, value)) return false;
+    for (size_t i=0; i<fields.size(); i++)
+    {
+      if (fields[i]->getName() != name) continue;
+      bool success;
+      if (fields[i]->getType() == DBFieldBase::BINARY) success = fields[i]->fromBinary(value.data(), value.size());
+      else success = fields[i]->fromString(value.c_str());
+      if (!success)
+      {
+        ROS_ERROR("Database record: failed to parse value of field %s", name.c_str());
+        return false;
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+}//namespace
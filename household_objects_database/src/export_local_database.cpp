@@ -0,0 +1,78 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+//! Copies (part of) the objects database into a local read-only replica file
+//! which can then be served by the objects_database_node without network access
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <ros/ros.h>
+
+#include "household_objects_database/database_tool_utils.h"
+#include "household_objects_database/local_objects_database.h"
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "export_local_database", ros::init_options::AnonymousName);
+  if (argc < 2)
+  {
+    household_objects_database::printDatabaseToolUsage("export_local_database output_file [--vfh] [model_set ...]");
+    return -1;
+  }
+  std::string filename(argv[1]);
+  bool export_vfh = false;
+  std::vector<std::string> model_sets;
+  for (int i=2; i<argc; i++)
+  {
+    if (std::string(argv[i]) == "--vfh") export_vfh = true;
+    else model_sets.push_back(argv[i]);
+  }
+
+  boost::scoped_ptr<household_objects_database::ObjectsDatabase> 
+    database(household_objects_database::connectToDatabaseFromParams());
+  if (!database) return -1;
+
+  if (!household_objects_database::LocalObjectsDatabase::exportDatabase(*database, model_sets, 
+                                                                         export_vfh, filename))
+  {
+    std::cerr << "Export failed\n";
+    return -1;
+  }
+  std::cerr << "Export succeeded\n";
+  return 0;
+}
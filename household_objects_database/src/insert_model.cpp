@@ -221,16 +221,20 @@ int main(int argc, char **argv)
   //read in the geometry of the model from the ply file
   household_objects_database::DatabaseMesh mesh;
   household_objects_database::PLYModelLoader loader;
-  if (loader.readFromFile(geometry_filename, mesh.vertices_.data(), mesh.triangles_.data()) < 0)
+  std::vector<double> vertices;
+  std::vector<int> triangles;
+  if (loader.readFromFile(geometry_filename, vertices, triangles) < 0)
   {
     std::cerr << "Failed to read geometry from file\n";
     return -1;
   }
-  if (mesh.vertices_.data().empty() || mesh.triangles_.data().empty())
+  if (vertices.empty() || triangles.empty())
   {
     std::cerr << "No geometry read from file\n";
     return -1;
   }
+  mesh.vertices_.data().assign(vertices);
+  mesh.triangles_.data().assign(triangles);
   
   //the original model we will insert
   household_objects_database::DatabaseOriginalModel original_model;
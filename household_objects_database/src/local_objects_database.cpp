@@ -0,0 +1,382 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "household_objects_database/local_objects_database.h"
+#include "household_objects_database/database_record_io.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include <stdint.h>
+
+using namespace database_interface;
+
+namespace household_objects_database {
+
+//! Identifies replica files ("HODB")
+static const uint32_t LOCAL_DATABASE_MAGIC = 0x42444f48;
+
+//! Bumped whenever the layout of replica files changes
+static const uint32_t LOCAL_DATABASE_VERSION = 1;
+
+bool LocalObjectsDatabase::exportDatabase(ObjectsDatabase &database, const std::vector<std::string> &model_sets,
+                                          bool export_vfh, std::string filename)
+{
+  std::vector< boost::shared_ptr<DatabaseScaledModel> > models;
+  std::map<std::string, std::vector<int> > set_ids;
+  if (model_sets.empty())
+  {
+    if (!database.getScaledModelsList(models))
+    {
+      ROS_ERROR("Local database export: failed to get list of scaled models");
+      return false;
+    }
+  }
+  else
+  {
+    std::set<int> exported_ids;
+    for (size_t s=0; s<model_sets.size(); s++)
+    {
+      std::vector< boost::shared_ptr<DatabaseScaledModel> > set_models;
+      if (!database.getScaledModelsBySet(set_models, model_sets[s]))
+      {
+        ROS_ERROR("Local database export: failed to get models in set %s", model_sets[s].c_str());
+        return false;
+      }
+      std::vector<int> &ids = set_ids[model_sets[s]];
+      for (size_t i=0; i<set_models.size(); i++)
+      {
+        ids.push_back(set_models[i]->id_.data());
+        if (exported_ids.insert(set_models[i]->id_.data()).second) models.push_back(set_models[i]);
+      }
+    }
+  }
+
+  std::vector< boost::shared_ptr<DatabaseMesh> > meshes;
+  std::vector< boost::shared_ptr<DatabaseGrasp> > grasps;
+  std::set<int> original_ids;
+  for (size_t i=0; i<models.size(); i++)
+  {
+    int model_id = models[i]->id_.data();
+    if (original_ids.insert(models[i]->original_model_id_.data()).second)
+    {
+      boost::shared_ptr<DatabaseMesh> mesh(new DatabaseMesh);
+      if (!database.getScaledModelMesh(model_id, *mesh))
+      {
+        ROS_ERROR("Local database export: failed to get mesh for scaled model %d", model_id);
+        return false;
+      }
+      meshes.push_back(mesh);
+    }
+    std::vector< boost::shared_ptr<DatabaseGrasp> > model_grasps;
+    DatabaseGrasp example;
+    std::stringstream id;
+    id << model_id;
+    if (!database.getList<DatabaseGrasp>(model_grasps, example, "scaled_model_id=" + id.str()))
+    {
+      ROS_ERROR("Local database export: failed to get grasps for scaled model %d", model_id);
+      return false;
+    }
+    grasps.insert(grasps.end(), model_grasps.begin(), model_grasps.end());
+  }
+
+  std::vector< boost::shared_ptr<DatabaseVFH> > vfh;
+  if (export_vfh && !database.getVFHDescriptors(vfh))
+  {
+    ROS_ERROR("Local database export: failed to get VFH descriptors");
+    return false;
+  }
+
+  std::ofstream str(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!str.is_open())
+  {
+    ROS_ERROR("Local database export: failed to open file %s for writing", filename.c_str());
+    return false;
+  }
+  writeUInt(str, LOCAL_DATABASE_MAGIC);
+  writeUInt(str, LOCAL_DATABASE_VERSION);
+  bool success = writeList(str, models);
+  writeUInt(str, set_ids.size());
+  for (std::map<std::string, std::vector<int> >::const_iterator it=set_ids.begin(); it!=set_ids.end(); it++)
+  {
+    writeBytes(str, it->first.c_str(), it->first.size());
+    writeUInt(str, it->second.size());
+    for (size_t i=0; i<it->second.size(); i++) writeUInt(str, it->second[i]);
+  }
+  success = success && writeList(str, meshes) && writeList(str, grasps) && writeList(str, vfh);
+  str.close();
+  if (!success || str.fail())
+  {
+    ROS_ERROR("Local database export: failed to write file %s", filename.c_str());
+    return false;
+  }
+  ROS_INFO("Local database export: wrote %u models, %u meshes, %u grasps and %u VFH descriptors to %s",
+           (unsigned int)models.size(), (unsigned int)meshes.size(), (unsigned int)grasps.size(),
+           (unsigned int)vfh.size(), filename.c_str());
+  return true;
+}
+
+void LocalObjectsDatabase::clear()
+{
+  loaded_ = false;
+  models_.clear();
+  models_by_id_.clear();
+  model_sets_.clear();
+  meshes_.clear();
+  grasps_.clear();
+  vfh_.clear();
+}
+
+static void arrayToPose(const double *array, geometry_msgs::Pose &pose)
+{
+  pose.position.x = array[0]; pose.position.y = array[1]; pose.position.z = array[2];
+  pose.orientation.x = array[3]; pose.orientation.y = array[4]; pose.orientation.z = array[5];
+  pose.orientation.w = array[6];
+}
+
+/*! Models and grasps are small, so they are converted to database objects once, here. Meshes
+  are not copied; their blobs are views into the mapped file, and keep it mapped. */
+bool LocalObjectsDatabase::loadFromCatalogue(std::string filename)
+{
+  ModelCataloguePtr catalogue(new ModelCatalogue);
+  if (!catalogue->open(filename)) return false;
+  size_t num_grasps = 0;
+  for (size_t i=0; i<catalogue->numModels(); i++)
+  {
+    const CatalogueModel &entry = catalogue->model(i);
+    boost::shared_ptr<DatabaseScaledModel> model(new DatabaseScaledModel);
+    model->id_.data() = entry.scaled_model_id;
+    model->original_model_id_.data() = entry.original_model_id;
+    model->scale_.data() = entry.scale;
+    model->model_.data() = catalogue->getString(entry.name_offset);
+    model->maker_.data() = catalogue->getString(entry.maker_offset);
+    const uint64_t *tags = catalogue->array<uint64_t>(entry.tags_offset);
+    for (size_t t=0; t<entry.num_tags; t++) model->tags_.data().push_back(catalogue->getString(tags[t]));
+    models_.push_back(model);
+    models_by_id_[entry.scaled_model_id] = model;
+
+    if (!meshes_.count(entry.original_model_id))
+    {
+      boost::shared_ptr<DatabaseMesh> mesh(new DatabaseMesh);
+      mesh->id_.data() = entry.original_model_id;
+      mesh->vertices_.data() = DatabaseBlob(catalogue, reinterpret_cast<const char*>(catalogue->vertices(entry)), 
+                                            3 * entry.num_vertices * sizeof(double));
+      mesh->triangles_.data() = DatabaseBlob(catalogue, reinterpret_cast<const char*>(catalogue->triangles(entry)), 
+                                             3 * entry.num_triangles * sizeof(int32_t));
+      meshes_[entry.original_model_id] = mesh;
+    }
+
+    std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps = grasps_[entry.scaled_model_id];
+    const CatalogueGrasp *catalogue_grasps = catalogue->grasps(entry);
+    for (size_t g=0; g<entry.num_grasps; g++)
+    {
+      const CatalogueGrasp &cg = catalogue_grasps[g];
+      boost::shared_ptr<DatabaseGrasp> grasp(new DatabaseGrasp);
+      grasp->id_.data() = cg.grasp_id;
+      grasp->scaled_model_id_.data() = entry.scaled_model_id;
+      grasp->hand_name_.data() = catalogue->getString(cg.hand_name_offset);
+      grasp->cluster_rep_.data() = cg.cluster_rep;
+      grasp->compliant_copy_.data() = cg.compliant_copy;
+      grasp->compliant_original_id_.data() = cg.compliant_original_id;
+      grasp->fingertip_object_collision_.data() = cg.fingertip_object_collision;
+      grasp->quality_.data() = cg.quality;
+      grasp->scaled_quality_.data() = cg.scaled_quality;
+      grasp->pre_grasp_clearance_.data() = cg.pre_grasp_clearance;
+      grasp->table_clearance_.data() = cg.table_clearance;
+      arrayToPose(cg.pre_grasp_pose, grasp->pre_grasp_pose_.data().pose_);
+      arrayToPose(cg.final_grasp_pose, grasp->final_grasp_pose_.data().pose_);
+      const double *pre_posture = catalogue->array<double>(cg.pre_grasp_posture_offset);
+      grasp->pre_grasp_posture_.data().joint_angles_.assign(pre_posture, pre_posture + cg.num_pre_grasp_joints);
+      const double *final_posture = catalogue->array<double>(cg.final_grasp_posture_offset);
+      grasp->final_grasp_posture_.data().joint_angles_.assign(final_posture, final_posture + cg.num_final_grasp_joints);
+      grasps.push_back(grasp);
+    }
+    num_grasps += entry.num_grasps;
+  }
+  for (size_t s=0; s<catalogue->numModelSets(); s++)
+  {
+    const CatalogueModelSet &set = catalogue->modelSet(s);
+    const int32_t *ids = catalogue->array<int32_t>(set.ids_offset);
+    model_sets_[catalogue->getString(set.name_offset)].assign(ids, ids + set.num_ids);
+  }
+  ROS_INFO("Local objects database: loaded %u models and %u grasps from catalogue %s",
+           (unsigned int)models_.size(), (unsigned int)num_grasps, filename.c_str());
+  loaded_ = true;
+  return true;
+}
+
+bool LocalObjectsDatabase::loadFromFile(std::string filename)
+{
+  clear();
+  if (ModelCatalogue::isCatalogueFile(filename)) return loadFromCatalogue(filename);
+
+  std::ifstream str(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!str.is_open())
+  {
+    ROS_ERROR("Local objects database: failed to open file %s", filename.c_str());
+    return false;
+  }
+  uint32_t magic, version;
+  if (!readUInt(str, magic) || !readUInt(str, version) || magic != LOCAL_DATABASE_MAGIC)
+  {
+    ROS_ERROR("Local objects database: file %s is not a database replica", filename.c_str());
+    return false;
+  }
+  if (version != LOCAL_DATABASE_VERSION)
+  {
+    ROS_ERROR("Local objects database: file %s has version %u; expected version %u", filename.c_str(),
+              version, LOCAL_DATABASE_VERSION);
+    return false;
+  }
+
+  std::vector< boost::shared_ptr<DatabaseMesh> > meshes;
+  std::vector< boost::shared_ptr<DatabaseGrasp> > grasps;
+  bool success = readList(str, models_);
+  uint32_t num_sets;
+  success = success && readUInt(str, num_sets);
+  for (uint32_t s=0; success && s<num_sets; s++)
+  {
+    std::string name;
+    uint32_t num_ids;
+    success = readBytes(str, name) && readUInt(str, num_ids);
+    std::vector<int> &ids = model_sets_[name];
+    for (uint32_t i=0; success && i<num_ids; i++)
+    {
+      uint32_t id;
+      success = readUInt(str, id);
+      ids.push_back(id);
+    }
+  }
+  success = success && readList(str, meshes) && readList(str, grasps) && readList(str, vfh_);
+  if (!success)
+  {
+    ROS_ERROR("Local objects database: file %s is truncated or corrupted", filename.c_str());
+    return false;
+  }
+
+  for (size_t i=0; i<models_.size(); i++) models_by_id_[models_[i]->id_.data()] = models_[i];
+  for (size_t i=0; i<meshes.size(); i++) meshes_[meshes[i]->id_.data()] = meshes[i];
+  for (size_t i=0; i<grasps.size(); i++) grasps_[grasps[i]->scaled_model_id_.data()].push_back(grasps[i]);
+  ROS_INFO("Local objects database: loaded %u models, %u meshes, %u grasps and %u VFH descriptors from %s",
+           (unsigned int)models_.size(), (unsigned int)meshes.size(), (unsigned int)grasps.size(),
+           (unsigned int)vfh_.size(), filename.c_str());
+  loaded_ = true;
+  return true;
+}
+
+bool LocalObjectsDatabase::getScaledModelsList(std::vector<boost::shared_ptr<DatabaseScaledModel> > &models) const
+{
+  models = models_;
+  return true;
+}
+
+bool LocalObjectsDatabase::getScaledModelsBySet(std::vector<boost::shared_ptr<DatabaseScaledModel> > &models,
+                                                std::string model_set_name) const
+{
+  if (model_set_name.empty()) return getScaledModelsList(models);
+  std::map<std::string, std::vector<int> >::const_iterator it = model_sets_.find(model_set_name);
+  if (it == model_sets_.end())
+  {
+    ROS_ERROR("Local objects database: model set %s was not exported to this replica", model_set_name.c_str());
+    return false;
+  }
+  models.clear();
+  for (size_t i=0; i<it->second.size(); i++)
+  {
+    boost::shared_ptr<DatabaseScaledModel> model;
+    if (getScaledModel(it->second[i], model)) models.push_back(model);
+  }
+  return true;
+}
+
+bool LocalObjectsDatabase::getScaledModel(int scaled_model_id, boost::shared_ptr<DatabaseScaledModel> &model) const
+{
+  std::map<int, boost::shared_ptr<DatabaseScaledModel> >::const_iterator it = models_by_id_.find(scaled_model_id);
+  if (it == models_by_id_.end()) return false;
+  model = it->second;
+  return true;
+}
+
+bool LocalObjectsDatabase::getGrasps(int scaled_model_id, std::string hand_name,
+                                     std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps) const
+{
+  grasps.clear();
+  std::map<int, std::vector<boost::shared_ptr<DatabaseGrasp> > >::const_iterator it = grasps_.find(scaled_model_id);
+  if (it == grasps_.end()) return true;
+  for (size_t i=0; i<it->second.size(); i++)
+  {
+    if (it->second[i]->hand_name_.data() == hand_name) grasps.push_back(it->second[i]);
+  }
+  return true;
+}
+
+bool LocalObjectsDatabase::getClusterRepGrasps(int scaled_model_id, std::string hand_name,
+                                               std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps) const
+{
+  if (!getGrasps(scaled_model_id, hand_name, grasps)) return false;
+  std::vector<boost::shared_ptr<DatabaseGrasp> >::iterator it = grasps.begin();
+  while (it != grasps.end())
+  {
+    if (!(*it)->cluster_rep_.data()) it = grasps.erase(it);
+    else it++;
+  }
+  return true;
+}
+
+bool LocalObjectsDatabase::getScaledModelMesh(int scaled_model_id, arm_navigation_msgs::Shape &shape) const
+{
+  boost::shared_ptr<DatabaseScaledModel> model;
+  if (!getScaledModel(scaled_model_id, model))
+  {
+    ROS_ERROR("Local objects database: scaled model %d not found", scaled_model_id);
+    return false;
+  }
+  std::map<int, boost::shared_ptr<DatabaseMesh> >::const_iterator it = meshes_.find(model->original_model_id_.data());
+  if (it == meshes_.end())
+  {
+    ROS_ERROR("Local objects database: no mesh for scaled model %d, resolved to original model %d",
+              scaled_model_id, model->original_model_id_.data());
+    return false;
+  }
+  return ObjectsDatabase::meshToShape(*it->second, shape);
+}
+
+bool LocalObjectsDatabase::getVFHDescriptors(std::vector<boost::shared_ptr<DatabaseVFH> > &vfh) const
+{
+  vfh = vfh_;
+  return true;
+}
+
+}//namespace
@@ -0,0 +1,360 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "household_objects_database/model_catalogue.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <fstream>
+
+#include <ros/ros.h>
+
+namespace household_objects_database {
+
+//! Rounds up to the next multiple of 8
+static inline uint64_t align8(uint64_t offset)
+{
+  return (offset + 7) & ~((uint64_t)7);
+}
+
+static void poseToArray(const geometry_msgs::Pose &pose, double *array)
+{
+  array[0] = pose.position.x; array[1] = pose.position.y; array[2] = pose.position.z;
+  array[3] = pose.orientation.x; array[4] = pose.orientation.y; array[5] = pose.orientation.z;
+  array[6] = pose.orientation.w;
+}
+
+bool ModelCatalogue::isCatalogueFile(std::string filename)
+{
+  std::ifstream str(filename.c_str(), std::ios::in | std::ios::binary);
+  char magic[sizeof(CATALOGUE_MAGIC)];
+  str.read(magic, sizeof(magic));
+  return str.good() && !memcmp(magic, CATALOGUE_MAGIC, sizeof(magic));
+}
+
+bool ModelCatalogue::open(std::string filename)
+{
+  close();
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    ROS_ERROR("Model catalogue: failed to open file %s", filename.c_str());
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t)sizeof(CatalogueHeader))
+  {
+    ROS_ERROR("Model catalogue: file %s is too small to be a catalogue", filename.c_str());
+    ::close(fd);
+    return false;
+  }
+  void *mapping = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  //the mapping keeps its own reference to the file
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    ROS_ERROR("Model catalogue: failed to map file %s", filename.c_str());
+    return false;
+  }
+  data_ = static_cast<const char*>(mapping);
+  size_ = file_stat.st_size;
+  if (!validate())
+  {
+    ROS_ERROR("Model catalogue: file %s is not a valid catalogue", filename.c_str());
+    close();
+    return false;
+  }
+  ROS_INFO("Model catalogue: mapped %u models from %s", (unsigned int)numModels(), filename.c_str());
+  return true;
+}
+
+void ModelCatalogue::close()
+{
+  if (data_) munmap(const_cast<char*>(data_), size_);
+  data_ = NULL;
+  size_ = 0;
+  model_index_.clear();
+}
+
+bool ModelCatalogue::checkBlock(uint64_t offset, uint64_t count, size_t element_size) const
+{
+  if (!count) return true;
+  if (offset % 8 != 0 || offset > size_) return false;
+  return count <= (size_ - offset) / element_size;
+}
+
+bool ModelCatalogue::checkString(uint64_t offset) const
+{
+  if (offset >= size_) return false;
+  return memchr(data_ + offset, '\0', size_ - offset) != NULL;
+}
+
+bool ModelCatalogue::validate()
+{
+  const CatalogueHeader &hdr = header();
+  if (memcmp(hdr.magic, CATALOGUE_MAGIC, sizeof(CATALOGUE_MAGIC))) return false;
+  if (hdr.version != CATALOGUE_VERSION)
+  {
+    ROS_ERROR("Model catalogue: version %u found, version %u expected", hdr.version, CATALOGUE_VERSION);
+    return false;
+  }
+  if (hdr.model_entry_size != sizeof(CatalogueModel) || hdr.grasp_entry_size != sizeof(CatalogueGrasp) ||
+      hdr.file_size != size_)
+  {
+    ROS_ERROR("Model catalogue: layout mismatch; catalogue was written on a different architecture "
+              "or was truncated");
+    return false;
+  }
+  if (!checkBlock(hdr.models_offset, hdr.num_models, sizeof(CatalogueModel)) ||
+      !checkBlock(hdr.sets_offset, hdr.num_sets, sizeof(CatalogueModelSet))) return false;
+
+  for (size_t i=0; i<hdr.num_models; i++)
+  {
+    const CatalogueModel &m = model(i);
+    if (!checkString(m.name_offset) || !checkString(m.maker_offset) ||
+        !checkBlock(m.tags_offset, m.num_tags, sizeof(uint64_t)) ||
+        !checkBlock(m.vertices_offset, 3 * (uint64_t)m.num_vertices, sizeof(double)) ||
+        !checkBlock(m.triangles_offset, 3 * (uint64_t)m.num_triangles, sizeof(int32_t)) ||
+        !checkBlock(m.sampled_points_offset, 3 * (uint64_t)m.num_sampled_points, sizeof(float)) ||
+        !checkBlock(m.grasps_offset, m.num_grasps, sizeof(CatalogueGrasp))) return false;
+    for (size_t t=0; t<m.num_tags; t++)
+    {
+      if (!checkString(array<uint64_t>(m.tags_offset)[t])) return false;
+    }
+    const int32_t *tri = triangles(m);
+    for (size_t t=0; t<3*(size_t)m.num_triangles; t++)
+    {
+      if (tri[t] < 0 || (uint32_t)tri[t] >= m.num_vertices) return false;
+    }
+    const CatalogueGrasp *g = grasps(m);
+    for (size_t j=0; j<m.num_grasps; j++)
+    {
+      if (!checkString(g[j].hand_name_offset) ||
+          !checkBlock(g[j].pre_grasp_posture_offset, g[j].num_pre_grasp_joints, sizeof(double)) ||
+          !checkBlock(g[j].final_grasp_posture_offset, g[j].num_final_grasp_joints, sizeof(double))) return false;
+    }
+    model_index_[m.scaled_model_id] = i;
+  }
+  for (size_t i=0; i<hdr.num_sets; i++)
+  {
+    const CatalogueModelSet &s = modelSet(i);
+    if (!checkString(s.name_offset) || !checkBlock(s.ids_offset, s.num_ids, sizeof(int32_t))) return false;
+  }
+  return true;
+}
+
+const CatalogueModelSet* ModelCatalogue::findModelSet(std::string name) const
+{
+  for (size_t i=0; i<numModelSets(); i++)
+  {
+    if (name == getString(modelSet(i).name_offset)) return &modelSet(i);
+  }
+  return NULL;
+}
+
+bool ModelCatalogueWriter::addModel(const DatabaseScaledModel &model, const DatabaseMesh &mesh,
+                                    const std::vector<boost::shared_ptr<DatabaseGrasp> > &grasps,
+                                    const std::vector<float> &sampled_points)
+{
+  if (!mesh.isValid() || sampled_points.size() % 3 != 0)
+  {
+    ROS_ERROR("Model catalogue: mesh or sampled points for model %d are not made of 3D entries",
+              model.id_.data());
+    return false;
+  }
+  models_.push_back(ModelData());
+  ModelData &data = models_.back();
+  memset(&data.entry, 0, sizeof(data.entry));
+  data.entry.scaled_model_id = model.id_.data();
+  data.entry.original_model_id = model.original_model_id_.data();
+  data.entry.scale = model.scale_.data();
+  data.name = model.model_.data();
+  data.maker = model.maker_.data();
+  data.tags = model.tags_.data();
+  data.vertices.assign(mesh.vertices().begin(), mesh.vertices().end());
+  data.triangles.assign(mesh.triangles().begin(), mesh.triangles().end());
+  data.sampled_points = sampled_points;
+  for (size_t i=0; i<grasps.size(); i++)
+  {
+    const DatabaseGrasp &grasp = *grasps[i];
+    CatalogueGrasp entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.grasp_id = grasp.id_.data();
+    entry.compliant_original_id = grasp.compliant_original_id_.data();
+    entry.cluster_rep = grasp.cluster_rep_.data();
+    entry.compliant_copy = grasp.compliant_copy_.data();
+    entry.fingertip_object_collision = grasp.fingertip_object_collision_.data();
+    entry.quality = grasp.quality_.data();
+    entry.scaled_quality = grasp.scaled_quality_.data();
+    entry.pre_grasp_clearance = grasp.pre_grasp_clearance_.data();
+    entry.table_clearance = grasp.table_clearance_.data();
+    poseToArray(grasp.pre_grasp_pose_.data().pose_, entry.pre_grasp_pose);
+    poseToArray(grasp.final_grasp_pose_.data().pose_, entry.final_grasp_pose);
+    data.grasps.push_back(entry);
+    data.hand_names.push_back(grasp.hand_name_.data());
+    data.pre_grasp_postures.push_back(grasp.pre_grasp_posture_.data().joint_angles_);
+    data.final_grasp_postures.push_back(grasp.final_grasp_posture_.data().joint_angles_);
+  }
+  return true;
+}
+
+//! Accumulates the contents of a catalogue file, keeping all blocks 8-byte aligned
+class CatalogueBuffer
+{
+ private:
+  std::vector<char> data_;
+
+ public:
+  //! Appends a block and returns its offset
+  uint64_t append(const void *block, size_t length)
+  {
+    uint64_t offset = align8(data_.size());
+    data_.resize(offset + length, 0);
+    if (length) memcpy(&data_[offset], block, length);
+    return offset;
+  }
+
+  template <class T>
+  uint64_t appendVector(const std::vector<T> &vec)
+  {
+    if (vec.empty()) return align8(data_.size());
+    return append(&vec[0], vec.size() * sizeof(T));
+  }
+
+  uint64_t appendString(const std::string &str)
+  {
+    return append(str.c_str(), str.size() + 1);
+  }
+
+  //! Overwrites a block that has previously been appended
+  void overwrite(uint64_t offset, const void *block, size_t length)
+  {
+    memcpy(&data_[offset], block, length);
+  }
+
+  const std::vector<char>& data() const {return data_;}
+};
+
+bool ModelCatalogueWriter::write(std::string filename) const
+{
+  CatalogueHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CATALOGUE_MAGIC, sizeof(CATALOGUE_MAGIC));
+  header.version = CATALOGUE_VERSION;
+  header.model_entry_size = sizeof(CatalogueModel);
+  header.grasp_entry_size = sizeof(CatalogueGrasp);
+  header.num_models = models_.size();
+  header.num_sets = model_sets_.size();
+  header.sampling_resolution = sampling_resolution_;
+
+  //fixed-size tables first, filled in once all the offsets are known
+  CatalogueBuffer buffer;
+  buffer.append(&header, sizeof(header));
+  std::vector<CatalogueModel> model_entries(models_.size());
+  std::vector<CatalogueModelSet> set_entries(model_sets_.size());
+  header.models_offset = buffer.appendVector(model_entries);
+  header.sets_offset = buffer.appendVector(set_entries);
+
+  for (size_t i=0; i<models_.size(); i++)
+  {
+    const ModelData &data = models_[i];
+    CatalogueModel &entry = model_entries[i];
+    entry = data.entry;
+    entry.name_offset = buffer.appendString(data.name);
+    entry.maker_offset = buffer.appendString(data.maker);
+    std::vector<uint64_t> tag_offsets;
+    for (size_t t=0; t<data.tags.size(); t++) tag_offsets.push_back(buffer.appendString(data.tags[t]));
+    entry.tags_offset = buffer.appendVector(tag_offsets);
+    entry.num_tags = tag_offsets.size();
+    entry.vertices_offset = buffer.appendVector(data.vertices);
+    entry.num_vertices = data.vertices.size() / 3;
+    entry.triangles_offset = buffer.appendVector(data.triangles);
+    entry.num_triangles = data.triangles.size() / 3;
+    entry.sampled_points_offset = buffer.appendVector(data.sampled_points);
+    entry.num_sampled_points = data.sampled_points.size() / 3;
+
+    std::vector<CatalogueGrasp> grasps(data.grasps);
+    for (size_t g=0; g<grasps.size(); g++)
+    {
+      grasps[g].hand_name_offset = buffer.appendString(data.hand_names[g]);
+      grasps[g].pre_grasp_posture_offset = buffer.appendVector(data.pre_grasp_postures[g]);
+      grasps[g].num_pre_grasp_joints = data.pre_grasp_postures[g].size();
+      grasps[g].final_grasp_posture_offset = buffer.appendVector(data.final_grasp_postures[g]);
+      grasps[g].num_final_grasp_joints = data.final_grasp_postures[g].size();
+    }
+    entry.grasps_offset = buffer.appendVector(grasps);
+    entry.num_grasps = grasps.size();
+  }
+
+  size_t s = 0;
+  for (std::map<std::string, std::vector<int32_t> >::const_iterator it = model_sets_.begin();
+       it != model_sets_.end(); it++, s++)
+  {
+    set_entries[s].name_offset = buffer.appendString(it->first);
+    set_entries[s].ids_offset = buffer.appendVector(it->second);
+    set_entries[s].num_ids = it->second.size();
+  }
+
+  //pad the end of the file so that the last block is also a multiple of 8 bytes
+  buffer.append(NULL, 0);
+  header.file_size = buffer.data().size();
+  buffer.overwrite(0, &header, sizeof(header));
+  if (!model_entries.empty())
+    buffer.overwrite(header.models_offset, &model_entries[0], model_entries.size() * sizeof(CatalogueModel));
+  if (!set_entries.empty())
+    buffer.overwrite(header.sets_offset, &set_entries[0], set_entries.size() * sizeof(CatalogueModelSet));
+
+  std::ofstream str(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!str.is_open())
+  {
+    ROS_ERROR("Model catalogue: failed to open file %s for writing", filename.c_str());
+    return false;
+  }
+  str.write(&buffer.data()[0], buffer.data().size());
+  str.close();
+  if (str.fail())
+  {
+    ROS_ERROR("Model catalogue: failed to write file %s", filename.c_str());
+    return false;
+  }
+  ROS_INFO("Model catalogue: wrote %u models and %u model sets to %s", (unsigned int)models_.size(),
+           (unsigned int)model_sets_.size(), filename.c_str());
+  return true;
+}
+
+}//namespace
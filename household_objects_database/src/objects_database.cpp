@@ -36,6 +36,12 @@
 
 #include "household_objects_database/objects_database.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include <libpq-fe.h>
+
 #include <database_interface/db_filters.h>
 
 #include "household_objects_database/database_task.h"
@@ -44,38 +50,374 @@ using namespace database_interface;
 
 namespace household_objects_database {
 
+//! Clears a PGresult when it goes out of scope
+class PGresultGuard
+{
+ private:
+  PGresult *result_;
+ public:
+  PGresultGuard(PGresult *result) : result_(result) {}
+  ~PGresultGuard() {PQclear(result_);}
+  PGresult* get() {return result_;}
+};
+
+//! Executes a statement that returns no rows, such as BEGIN or COMMIT
+static bool execCommand(PGconn *connection, const char *command)
+{
+  PGresultGuard result(PQexec(connection, command));
+  return PQresultStatus(result.get()) == PGRES_COMMAND_OK;
+}
+
+//! Postgres limit on the number of parameters in a single statement
+static const size_t MAX_STATEMENT_PARAMS = 65535;
+
+//! Upper limit on the number of rows sent in a single INSERT statement
+static const size_t MAX_ROWS_PER_INSERT = 1000;
+
+//! Returns the primary key followed by all the other fields of \a entry
+static std::vector<DBFieldBase*> allFields(DBClass *entry)
+{
+  std::vector<DBFieldBase*> fields;
+  fields.push_back(entry->getPrimaryKeyField());
+  for (size_t i=0; i<entry->getNumFields(); i++) fields.push_back(entry->getField(i));
+  return fields;
+}
+
+//! Fills in the fields of \a entry that are read from the database from a row of a text-mode result
+/*! Columns are matched by name, so the result can contain the columns in any order. */
+static bool populateFromTextRow(DBClass *entry, PGresult *result, int row)
+{
+  std::vector<DBFieldBase*> fields = allFields(entry);
+  for (size_t i=0; i<fields.size(); i++)
+  {
+    if (!fields[i]->getReadFromDatabase()) continue;
+    int column = PQfnumber(result, fields[i]->getName().c_str());
+    if (column < 0)
+    {
+      ROS_ERROR("Database result is missing column %s", fields[i]->getName().c_str());
+      return false;
+    }
+    if (PQgetisnull(result, row, column)) continue;
+    if (!fields[i]->fromString(PQgetvalue(result, row, column)))
+    {
+      ROS_ERROR("Failed to parse value of column %s", fields[i]->getName().c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! libpq only updates the status of a connection when it is used, so a trivial query is
+  needed to find out if it is still alive. */
+bool ObjectsDatabase::ping() const
+{
+  PGresultGuard result(PQexec(connection_, "SELECT 1"));
+  return PQresultStatus(result.get()) == PGRES_TUPLES_OK;
+}
+
+void ObjectsDatabase::getConnectionParams(std::string &host, std::string &port, std::string &user, 
+                                          std::string &password, std::string &dbname)
+{
+  ros::NodeHandle root_nh("");
+  root_nh.param<std::string>("/household_objects_database/database_host", host, "");
+  int port_int;
+  root_nh.param<int>("/household_objects_database/database_port", port_int, -1);
+  port = boost::lexical_cast<std::string>(port_int);
+  root_nh.param<std::string>("/household_objects_database/database_user", user, "");
+  root_nh.param<std::string>("/household_objects_database/database_pass", password, "");
+  root_nh.param<std::string>("/household_objects_database/database_name", dbname, "");
+}
+
 bool ObjectsDatabase::acquireNextTask(std::vector< boost::shared_ptr<DatabaseTask> > &task)
 {
-  //first get and mark (atomically) the task id
-  DatabaseTaskID id_example;
-  std::vector< boost::shared_ptr<DatabaseTaskID> > id_vec;
-  if ( !getList<DatabaseTaskID>(id_vec, id_example, "") )
+  return acquireNextTasks(task, 1);
+}
+
+/*! The task selection and the RUNNING mark happen in the same statement, so there is no
+  window in which two workers can see the same TO_RUN task. Rows that are locked by another
+  worker's acquisition are skipped rather than waited on.
+
+  The statement runs in a transaction that is only committed once all the returned rows have
+  been parsed; if any of them fails, the RUNNING marks are rolled back and no tasks are returned.
+ */
+static bool acquireTasks(PGconn *connection, std::vector< boost::shared_ptr<DatabaseTask> > &tasks, size_t max_tasks)
+{
+  DatabaseTask example;
+  std::string columns = example.id_.getName();
+  for (size_t i=0; i<example.getNumFields(); i++)
   {
-    ROS_ERROR("Failed to get the id of the next task to be run");
+    columns += ", " + example.getField(i)->getName();
+  }
+  std::string query = 
+    "UPDATE dbase_task SET dbase_task_outcome_name = 'RUNNING' WHERE dbase_task_id IN "
+    "(SELECT dbase_task_id FROM dbase_task WHERE dbase_task_outcome_name = 'TO_RUN' "
+    "ORDER BY dbase_task_id LIMIT " + boost::lexical_cast<std::string>(max_tasks) + 
+    " FOR UPDATE SKIP LOCKED) RETURNING " + columns;
+
+  if (!execCommand(connection, "BEGIN"))
+  {
+    ROS_ERROR("Failed to acquire next tasks; could not begin transaction: %s", PQerrorMessage(connection));
     return false;
   }
-  if (id_vec.empty())
+  PGresultGuard result(PQexec(connection, query.c_str()));
+  if (PQresultStatus(result.get()) != PGRES_TUPLES_OK)
   {
-    //no task to be run
-    return true;
+    ROS_ERROR("Failed to acquire next tasks; database error: %s", PQerrorMessage(connection));
+    execCommand(connection, "ROLLBACK");
+    return false;
   }
-  if (id_vec.size() != 1)
+  int num_tuples = PQntuples(result.get());
+  for (int i=0; i<num_tuples; i++)
   {
-    ROS_ERROR("Next task acquisition returned more than one result");
+    boost::shared_ptr<DatabaseTask> task(new DatabaseTask);
+    if (!populateFromTextRow(task.get(), result.get(), i))
+    {
+      //put the tasks back to TO_RUN so they can be acquired again
+      ROS_ERROR("Acquire next tasks: failed to populate entry");
+      tasks.clear();
+      if (!execCommand(connection, "ROLLBACK"))
+      {
+        ROS_ERROR("Acquire next tasks: rollback failed: %s", PQerrorMessage(connection));
+      }
+      return false;
+    }
+    tasks.push_back(task);
+  }
+  if (!execCommand(connection, "COMMIT"))
+  {
+    ROS_ERROR("Failed to acquire next tasks; could not commit: %s", PQerrorMessage(connection));
+    tasks.clear();
     return false;
   }
-  //get the actual task id
-  int id = id_vec[0]->id_.get();
-  std::stringstream idstr;
-  idstr << id;
-  std::string where_clause("dbase_task_id=" + idstr.str());
-  //fill in the rest
-  if (!getList<DatabaseTask>(task, where_clause) || task.size() != 1 )
+  return true;
+}
+
+bool ObjectsDatabase::acquireNextTasks(std::vector< boost::shared_ptr<DatabaseTask> > &tasks, size_t max_tasks)
+{
+  tasks.clear();
+  if (!max_tasks) return true;
+  ProfiledQuery query(*profiler_);
+  bool success = acquireTasks(connection_, tasks, max_tasks);
+  if (!query.active()) return success;
+  size_t bytes = 0;
+  for (size_t i=0; i<tasks.size(); i++) bytes += QueryProfiler::encodedSize(tasks[i].get());
+  query.finish("acquireNextTasks:dbase_task", success, tasks.size(), bytes, "");
+  return success;
+}
+
+/*! Text fields are sent as text parameters and binary fields as binary parameters, so no
+  escaping is needed. Rows are split over as many statements as needed to stay under the
+  statement parameter limit.
+
+  Postgres does not guarantee that the rows returned by a multi-row INSERT ... RETURNING come
+  in the order of the VALUES list, so keys are not read back that way. Instead, if the primary
+  key is generated by the database, all the keys needed are drawn from its sequence first, set
+  in the instances, and then inserted explicitly along with the other fields.
+ */
+bool ObjectsDatabase::insertListIntoTable(const std::vector<DBClass*> &instances)
+{
+  if (instances.empty()) return true;
+
+  //the columns to be written are decided based on the first instance
+  std::vector<DBFieldBase*> example_fields = allFields(instances[0]);
+  DBFieldBase *key_field = instances[0]->getPrimaryKeyField();
+  std::string table_name = key_field->getTableName();
+  std::vector<size_t> write_fields;
+  for (size_t i=0; i<example_fields.size(); i++)
+  {
+    if (!example_fields[i]->getWriteToDatabase()) continue;
+    if (example_fields[i]->getTableName() != table_name)
+    {
+      ROS_ERROR("Batch insert: field %s is not in table %s; use insertIntoDatabase instead",
+                example_fields[i]->getName().c_str(), table_name.c_str());
+      return false;
+    }
+    write_fields.push_back(i);
+  }
+  if (write_fields.empty())
   {
-    ROS_ERROR("Acquire next task: failed to populate entry");
+    ROS_ERROR("Batch insert: no fields to write into table %s", table_name.c_str());
     return false;
   }
+
+  //allFields() puts the primary key first
+  if (!key_field->getWriteToDatabase())
+  {
+    std::string sequence = key_field->getSequenceName();
+    if (sequence.empty())
+    {
+      ROS_ERROR("Batch insert: primary key of table %s is neither written nor taken from a sequence; "
+                "use insertIntoDatabase instead", table_name.c_str());
+      return false;
+    }
+    std::string num_keys = boost::lexical_cast<std::string>(instances.size());
+    const char *key_params[2] = {sequence.c_str(), num_keys.c_str()};
+    PGresultGuard keys(PQexecParams(connection_, "SELECT nextval($1) FROM generate_series(1, $2::integer)", 
+                                    2, NULL, key_params, NULL, NULL, 0));
+    if (PQresultStatus(keys.get()) != PGRES_TUPLES_OK || PQntuples(keys.get()) != (int)instances.size())
+    {
+      ROS_ERROR("Batch insert: failed to get keys from sequence %s; database error: %s", sequence.c_str(),
+                PQerrorMessage(connection_));
+      return false;
+    }
+    for (size_t r=0; r<instances.size(); r++)
+    {
+      if (!instances[r]->getPrimaryKeyField()->fromString(PQgetvalue(keys.get(), r, 0)))
+      {
+        ROS_ERROR("Batch insert: failed to parse key from sequence %s", sequence.c_str());
+        return false;
+      }
+    }
+    write_fields.insert(write_fields.begin(), 0);
+  }
+
+  std::string columns;
+  for (size_t f=0; f<write_fields.size(); f++)
+  {
+    if (f) columns += ", ";
+    columns += example_fields[write_fields[f]]->getName();
+  }
+
+  size_t rows_per_statement = std::min(MAX_ROWS_PER_INSERT, MAX_STATEMENT_PARAMS / write_fields.size());
+  for (size_t start=0; start<instances.size(); start+=rows_per_statement)
+  {
+    size_t end = std::min(instances.size(), start + rows_per_statement);
+    size_t num_params = (end - start) * write_fields.size();
+
+    //text values must stay in place until the statement has been executed
+    std::vector<std::string> text_values(num_params);
+    std::vector<const char*> param_values(num_params, NULL);
+    std::vector<int> param_lengths(num_params, 0);
+    std::vector<int> param_formats(num_params, 0);
+
+    std::stringstream query;
+    query << "INSERT INTO " << table_name << " (" << columns << ") VALUES ";
+    size_t p = 0;
+    for (size_t r=start; r<end; r++)
+    {
+      std::vector<DBFieldBase*> fields = allFields(instances[r]);
+      if (fields.size() != example_fields.size())
+      {
+        ROS_ERROR("Batch insert: instances are not all of the same type");
+        return false;
+      }
+      query << (r == start ? "(" : ", (");
+      for (size_t f=0; f<write_fields.size(); f++, p++)
+      {
+        DBFieldBase *field = fields[write_fields[f]];
+        if (field->getType() == DBFieldBase::BINARY)
+        {
+          size_t length = 0;
+          if (!field->toBinary(param_values[p], length))
+          {
+            ROS_ERROR("Batch insert: failed to convert field %s to binary", field->getName().c_str());
+            return false;
+          }
+          param_lengths[p] = length;
+          param_formats[p] = 1;
+        }
+        else
+        {
+          if (!field->toString(text_values[p]))
+          {
+            ROS_ERROR("Batch insert: failed to convert field %s to string", field->getName().c_str());
+            return false;
+          }
+          param_values[p] = text_values[p].c_str();
+        }
+        query << (f ? ", $" : "$") << p+1;
+      }
+      query << ")";
+    }
+
+    PGresultGuard result(PQexecParams(connection_, query.str().c_str(), num_params, NULL,
+                                      &param_values[0], &param_lengths[0], &param_formats[0], 0));
+    if (PQresultStatus(result.get()) != PGRES_COMMAND_OK)
+    {
+      ROS_ERROR("Batch insert into %s failed; database error: %s", table_name.c_str(), 
+                PQerrorMessage(connection_));
+      return false;
+    }
+  }
   return true;
 }
 
+//! Parses a postgres array of doubles in text form, such as {0.1,-2,3e-05}
+static bool parseDoubleArray(const char *text, std::vector<double> &values)
+{
+  values.clear();
+  if (*text != '{') return false;
+  text++;
+  while (*text && *text != '}')
+  {
+    char *end;
+    values.push_back( strtod(text, &end) );
+    if (end == text) return false;
+    text = end;
+    if (*text == ',') text++;
+  }
+  return *text == '}';
+}
+
+/*! The result is retrieved in single row mode, so memory use does not include a copy of the
+  whole result set, and rows are appended to the cube as they arrive. Rows come in grasp id
+  order, which is the order in which the cube groups them.
+
+  Rows without deltas are stored with all deltas set to zero. Rows whose deltas can not be
+  parsed are skipped with a warning, rather than failing the whole load.
+ */
+bool ObjectsDatabase::loadPerturbationCube(const std::string &where_clause, PerturbationCube &cube)
+{
+  cube.clear();
+  ProfiledQuery profiled_query(*profiler_);
+  std::string query = "SELECT grasp_id, energy_function_id, score, deltas FROM grasp_analysis WHERE " +
+    where_clause + " ORDER BY grasp_id";
+  bool success = true;
+  if (!PQsendQuery(connection_, query.c_str()) || !PQsetSingleRowMode(connection_))
+  {
+    ROS_ERROR("Failed to query perturbations; database error: %s", PQerrorMessage(connection_));
+    //a query might have been sent, so its results still need to be consumed
+    success = false;
+  }
+
+  size_t skipped = 0;
+  std::vector<double> deltas;
+  //all results must be read, even after an error, before the connection can be used again
+  while (PGresult *raw_result = PQgetResult(connection_))
+  {
+    PGresultGuard result(raw_result);
+    ExecStatusType status = PQresultStatus(result.get());
+    if (status == PGRES_TUPLES_OK) continue;
+    if (status != PGRES_SINGLE_TUPLE)
+    {
+      ROS_ERROR("Failed to query perturbations; database error: %s", PQerrorMessage(connection_));
+      success = false;
+      continue;
+    }
+    if (!success) continue;
+    if (PQgetisnull(result.get(), 0, 0) || PQgetisnull(result.get(), 0, 2)) continue;
+    if (PQgetisnull(result.get(), 0, 3))
+    {
+      //missing deltas are stored as zeros
+      deltas.clear();
+    }
+    else if (!parseDoubleArray(PQgetvalue(result.get(), 0, 3), deltas))
+    {
+      ROS_WARN("Skipping perturbation of grasp %s with unparsable deltas %s", 
+               PQgetvalue(result.get(), 0, 0), PQgetvalue(result.get(), 0, 3));
+      skipped++;
+      continue;
+    }
+    cube.appendRow(atoi(PQgetvalue(result.get(), 0, 0)), atoi(PQgetvalue(result.get(), 0, 1)),
+                   strtod(PQgetvalue(result.get(), 0, 2), NULL),
+                   deltas.empty() ? NULL : &deltas[0], deltas.size());
+  }
+  if (!success) cube.clear();
+  if (skipped) ROS_WARN("Skipped %zu perturbations with unparsable deltas", skipped);
+  profiled_query.finish("loadPerturbationCube:grasp_analysis", success, cube.numRows(), 
+                        cube.numRows() * (2*sizeof(int) + (1+PerturbationCube::NUM_DELTAS)*sizeof(double)),
+                        where_clause);
+  return success;
+}
+
 }//namespace
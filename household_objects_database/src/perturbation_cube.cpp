@@ -0,0 +1,159 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "household_objects_database/perturbation_cube.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace household_objects_database
+{
+
+const size_t PerturbationCube::NUM_DELTAS;
+
+void PerturbationCube::clear()
+{
+  grasp_ids_.clear();
+  grasp_offsets_.assign(1, 0);
+  energy_function_ids_.clear();
+  scores_.clear();
+  deltas_.clear();
+}
+
+void PerturbationCube::reserve(size_t num_rows)
+{
+  energy_function_ids_.reserve(num_rows);
+  scores_.reserve(num_rows);
+  deltas_.reserve(num_rows * NUM_DELTAS);
+}
+
+bool PerturbationCube::appendRow(int grasp_id, int energy_function_id, double score,
+                                 const double *deltas, size_t num_deltas)
+{
+  if (grasp_ids_.empty() || grasp_ids_.back() < grasp_id)
+  {
+    grasp_ids_.push_back(grasp_id);
+    grasp_offsets_.push_back(grasp_offsets_.back());
+  }
+  else if (grasp_ids_.back() != grasp_id)
+  {
+    return false;
+  }
+  energy_function_ids_.push_back(energy_function_id);
+  scores_.push_back(score);
+  size_t copied = std::min(num_deltas, NUM_DELTAS);
+  deltas_.insert(deltas_.end(), deltas, deltas + copied);
+  deltas_.resize(deltas_.size() + NUM_DELTAS - copied, 0.0);
+  grasp_offsets_.back()++;
+  return true;
+}
+
+void PerturbationCube::setFromList(const std::vector<DatabasePerturbationPtr> &perturbations)
+{
+  clear();
+  std::vector< std::pair<int, size_t> > order;
+  order.reserve(perturbations.size());
+  for (size_t i=0; i<perturbations.size(); i++)
+  {
+    order.push_back( std::make_pair(perturbations[i]->grasp_id_.data(), i) );
+  }
+  //stable, so that the perturbations of a grasp stay in the order they were given
+  std::stable_sort(order.begin(), order.end());
+  reserve(order.size());
+  for (size_t i=0; i<order.size(); i++)
+  {
+    const DatabasePerturbation &p = *perturbations[order[i].second];
+    const std::vector<double> &deltas = p.deltas_.data();
+    appendRow(p.grasp_id_.data(), p.energy_function_id_.data(), p.score_.data(),
+              deltas.empty() ? NULL : &deltas[0], deltas.size());
+  }
+}
+
+int PerturbationCube::findGrasp(int grasp_id) const
+{
+  std::vector<int>::const_iterator it = std::lower_bound(grasp_ids_.begin(), grasp_ids_.end(), grasp_id);
+  if (it == grasp_ids_.end() || *it != grasp_id) return -1;
+  return it - grasp_ids_.begin();
+}
+
+void PerturbationCube::scoreStatistics(std::vector<double> &means, std::vector<double> &variances) const
+{
+  means.assign(numGrasps(), 0.0);
+  variances.assign(numGrasps(), 0.0);
+  const double *scores = scores_.empty() ? NULL : &scores_[0];
+  for (size_t g=0; g<numGrasps(); g++)
+  {
+    size_t begin = rowBegin(g), end = rowEnd(g);
+    //two passes, to avoid the cancellation problems of a single pass sum of squares
+    double sum = 0.0;
+    for (size_t r=begin; r<end; r++) sum += scores[r];
+    double mean = sum / (end - begin);
+    double sum_sq = 0.0;
+    for (size_t r=begin; r<end; r++) sum_sq += (scores[r] - mean) * (scores[r] - mean);
+    means[g] = mean;
+    variances[g] = sum_sq / (end - begin);
+  }
+}
+
+void PerturbationCube::successRates(double min_score, std::vector<double> &rates) const
+{
+  rates.assign(numGrasps(), 0.0);
+  const double *scores = scores_.empty() ? NULL : &scores_[0];
+  for (size_t g=0; g<numGrasps(); g++)
+  {
+    size_t begin = rowBegin(g), end = rowEnd(g);
+    size_t successes = 0;
+    for (size_t r=begin; r<end; r++) successes += (scores[r] >= min_score);
+    rates[g] = (double)successes / (end - begin);
+  }
+}
+
+void PerturbationCube::rankGrasps(double deviation_weight, std::vector<int> &grasp_ids) const
+{
+  std::vector<double> means, variances;
+  scoreStatistics(means, variances);
+  std::vector< std::pair<double, int> > ranking;
+  ranking.reserve(numGrasps());
+  for (size_t g=0; g<numGrasps(); g++)
+  {
+    ranking.push_back( std::make_pair(-(means[g] - deviation_weight * sqrt(variances[g])), grasp_ids_[g]) );
+  }
+  std::sort(ranking.begin(), ranking.end());
+  grasp_ids.clear();
+  grasp_ids.reserve(ranking.size());
+  for (size_t i=0; i<ranking.size(); i++) grasp_ids.push_back(ranking[i].second);
+}
+
+}//namespace
@@ -0,0 +1,100 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "household_objects_database/query_profiler.h"
+
+#include <algorithm>
+
+#include <ros/ros.h>
+
+using namespace database_interface;
+
+namespace household_objects_database
+{
+
+const std::vector<double>& QueryProfiler::histogramBounds()
+{
+  static const double bounds[] = {0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0, 5.0};
+  static const std::vector<double> bounds_vector(bounds, bounds + sizeof(bounds) / sizeof(double));
+  return bounds_vector;
+}
+
+QueryProfiler::Stats::Stats() : count(0), failures(0), rows(0), bytes(0), total_time(0.0), max_time(0.0),
+                                histogram(histogramBounds().size() + 1, 0)
+{}
+
+void QueryProfiler::record(const std::string &type, double seconds, bool success, size_t rows, size_t bytes,
+                           const std::string &where_clause)
+{
+  Stats &stats = stats_[type];
+  stats.count++;
+  if (!success) stats.failures++;
+  stats.rows += rows;
+  stats.bytes += bytes;
+  stats.total_time += seconds;
+  stats.max_time = std::max(stats.max_time, seconds);
+  const std::vector<double> &bounds = histogramBounds();
+  stats.histogram[ std::lower_bound(bounds.begin(), bounds.end(), seconds) - bounds.begin() ]++;
+  if (seconds > slow_query_threshold_)
+  {
+    ROS_WARN("Slow database query: %s took %.3f seconds, %u rows, %u bytes; WHERE %s", type.c_str(), seconds,
+             (unsigned int)rows, (unsigned int)bytes, where_clause.empty() ? "(none)" : where_clause.c_str());
+  }
+}
+
+size_t QueryProfiler::encodedSize(DBClass *entry)
+{
+  size_t size = encodedSize(entry->getPrimaryKeyField());
+  for (size_t i=0; i<entry->getNumFields(); i++)
+  {
+    size += encodedSize(entry->getField(i));
+  }
+  return size;
+}
+
+size_t QueryProfiler::encodedSize(const DBFieldBase *field)
+{
+  if (field->getType() == DBFieldBase::BINARY)
+  {
+    const char *binary; 
+    size_t length = 0;
+    if (field->toBinary(binary, length)) return length;
+    return 0;
+  }
+  std::string value;
+  if (field->toString(value)) return value.size();
+  return 0;
+}
+
+}//namespace
@@ -0,0 +1,292 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2026, cob_object_manipulation contributors
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holders nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include "household_objects_database/scan_writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <boost/bind.hpp>
+
+#include "household_objects_database/objects_database.h"
+#include "household_objects_database/database_record_io.h"
+
+namespace household_objects_database
+{
+
+//! Writes \a scans to \a filename, either appending to it or replacing its contents
+static bool writeScanFile(const std::string &filename, const ScanWriter::ScanList &scans, bool append)
+{
+  std::ofstream str(filename.c_str(), std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+  bool success = str.good();
+  for (size_t i=0; success && i<scans.size(); i++) success = writeRecord(str, scans[i].get());
+  str.flush();
+  return success && str.good();
+}
+
+ScanWriter::ScanWriter(std::string host, std::string port, std::string user, std::string pass, std::string name,
+                       std::string spool_file, size_t batch_size, double retry_interval) :
+  host_(host), port_(port), user_(user), pass_(pass), name_(name), database_(NULL),
+  spool_file_(spool_file), batch_size_(std::max<size_t>(batch_size, 1)), retry_interval_(retry_interval),
+  in_progress_(0), written_(0), spooled_(0), failed_(0), connected_(false), stop_(false)
+{
+  ScanList scans;
+  readSpool(scans);
+  spooled_ = scans.size();
+  if (spooled_)
+  {
+    ROS_INFO("Scan writer: found %u scans in spool file %s", spooled_, spool_file_.c_str());
+  }
+  thread_ = boost::thread(boost::bind(&ScanWriter::run, this));
+}
+
+ScanWriter::~ScanWriter()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  work_condition_.notify_all();
+  thread_.join();
+  delete database_;
+}
+
+void ScanWriter::setError(const std::string &error)
+{
+  ROS_ERROR("Scan writer: %s", error.c_str());
+  boost::mutex::scoped_lock lock(mutex_);
+  last_error_ = error;
+}
+
+void ScanWriter::setConnected(bool connected)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  connected_ = connected;
+}
+
+bool ScanWriter::connect()
+{
+  if (database_) return true;
+  if (ros::WallTime::now() < next_connection_attempt_) return false;
+  next_connection_attempt_ = ros::WallTime::now() + ros::WallDuration(retry_interval_);
+  database_ = new ObjectsDatabase(host_, port_, user_, pass_, name_);
+  if (!database_->isConnected())
+  {
+    delete database_; database_ = NULL;
+    setError("could not connect to database on host " + host_ + ", port " + port_);
+    return false;
+  }
+  ROS_INFO("Scan writer: connected to database");
+  setConnected(true);
+  return true;
+}
+
+void ScanWriter::disconnect()
+{
+  delete database_; database_ = NULL;
+  setConnected(false);
+}
+
+bool ScanWriter::writeScans(ScanList &scans)
+{
+  if (scans.empty()) return true;
+  if (!connect()) return false;
+  if (database_->insertListIntoDatabase(scans))
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    written_ += scans.size();
+    return true;
+  }
+  std::stringstream error;
+  if (!database_->isConnected())
+  {
+    error << "lost database connection while writing " << scans.size() << " scans";
+    setError(error.str());
+    disconnect();
+    return false;
+  }
+  error << "database refused " << scans.size() << " scans";
+  setError(error.str());
+  boost::mutex::scoped_lock lock(mutex_);
+  failed_ += scans.size();
+  return true;
+}
+
+void ScanWriter::spoolScans(const ScanList &scans)
+{
+  if (!writeScanFile(spool_file_, scans, true))
+  {
+    //some of the records might have made it, but a truncated tail is ignored when reading
+    setError("failed to write scans to spool file " + spool_file_);
+    boost::mutex::scoped_lock lock(mutex_);
+    failed_ += scans.size();
+    return;
+  }
+  boost::mutex::scoped_lock lock(mutex_);
+  spooled_ += scans.size();
+}
+
+void ScanWriter::readSpool(ScanList &scans)
+{
+  std::ifstream str(spool_file_.c_str(), std::ios::in | std::ios::binary);
+  if (!str.is_open()) return;
+  while (str.peek() != EOF)
+  {
+    boost::shared_ptr<DatabaseScan> scan(new DatabaseScan);
+    if (!readRecord(str, scan.get()))
+    {
+      ROS_WARN("Scan writer: ignoring truncated record at the end of spool file %s", spool_file_.c_str());
+      break;
+    }
+    scans.push_back(scan);
+  }
+}
+
+/*! The scans left over are written to a temporary file which then replaces the spool in a
+  single rename, so that a crash at any point leaves either the old or the new spool in place,
+  never a partial one. */
+bool ScanWriter::writeSpool()
+{
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (!spooled_) return true;
+  }
+  if (!connect()) return false;
+  ScanList scans;
+  readSpool(scans);
+  if (scans.empty())
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    spooled_ = 0;
+    return true;
+  }
+  size_t done = 0;
+  while (done < scans.size())
+  {
+    ScanList batch(scans.begin() + done, scans.begin() + std::min(done + batch_size_, scans.size()));
+    if (!writeScans(batch)) break;
+    done += batch.size();
+  }
+  if (!done) return false;
+
+  ScanList remaining(scans.begin() + done, scans.end());
+  if (remaining.empty())
+  {
+    if (std::remove(spool_file_.c_str()) != 0)
+    {
+      //the same scans would be written again next time
+      setError("failed to clear spool file " + spool_file_);
+      return false;
+    }
+  }
+  else
+  {
+    std::string temp_file = spool_file_ + ".tmp";
+    if (!writeScanFile(temp_file, remaining, false) || std::rename(temp_file.c_str(), spool_file_.c_str()) != 0)
+    {
+      //the scans already written would be written again next time
+      std::remove(temp_file.c_str());
+      setError("failed to replace spool file " + spool_file_);
+      return false;
+    }
+  }
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    spooled_ = remaining.size();
+  }
+  if (!remaining.empty()) return false;
+  ROS_INFO("Scan writer: wrote %u spooled scans to database", (unsigned int)done);
+  return true;
+}
+
+void ScanWriter::run()
+{
+  while (true)
+  {
+    ScanList batch;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (queue_.empty() && !stop_)
+      {
+        work_condition_.timed_wait(lock, boost::posix_time::milliseconds((long)(retry_interval_ * 1.0e3)));
+      }
+      if (stop_ && queue_.empty()) break;
+      while (!queue_.empty() && batch.size() < batch_size_)
+      {
+        batch.push_back(queue_.front());
+        queue_.pop_front();
+      }
+      in_progress_ = batch.size();
+    }
+    //spooled scans go first, so that scans reach the database in the order they were saved
+    bool spool_empty = writeSpool();
+    if (!batch.empty() && (!spool_empty || !writeScans(batch)))
+    {
+      spoolScans(batch);
+    }
+    boost::mutex::scoped_lock lock(mutex_);
+    in_progress_ = 0;
+    if (queue_.empty()) idle_condition_.notify_all();
+  }
+}
+
+void ScanWriter::enqueue(const ScanList &scans)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  queue_.insert(queue_.end(), scans.begin(), scans.end());
+  work_condition_.notify_all();
+}
+
+bool ScanWriter::getStatus(bool wait_for_completion, ros::Duration timeout, Status &status)
+{
+  boost::mutex::scoped_lock lock(mutex_);
+  boost::system_time deadline = boost::get_system_time() +
+    boost::posix_time::milliseconds((long)(timeout.toSec() * 1.0e3));
+  while (wait_for_completion && (!queue_.empty() || in_progress_))
+  {
+    if (timeout.toSec() <= 0) idle_condition_.wait(lock);
+    else if (!idle_condition_.timed_wait(lock, deadline)) break;
+  }
+  status.pending = queue_.size() + in_progress_;
+  status.written = written_;
+  status.spooled = spooled_;
+  status.failed = failed_;
+  status.database_connected = connected_;
+  status.last_error = last_error_;
+  return status.pending == 0;
+}
+
+} //namespace
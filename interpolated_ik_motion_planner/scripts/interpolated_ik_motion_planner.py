@@ -52,6 +52,10 @@
 
 # Parameters can be changed by calling the r_interpolated_ik_motion_plan_set_params service (or l_inter...)
 
+# Several plans can be requested in a single call to the r_interpolated_ik_motion_plan_batch service (or l_inter...),
+# using GetInterpolatedIKMotionPlanBatch.srv. Each request there carries its own num_steps, 
+# collision_check_resolution and start_from_end values, which are not kept for later requests.
+
 
 # The main service message is GetMotionPlan.srv, in arm_navigation_msgs.  Parts that were hijacked 
 # for the relevant inputs and outputs:
@@ -98,6 +102,8 @@ from arm_navigation_msgs.msg import ArmNavigationErrorCodes, RobotState
 from geometry_msgs.msg import PoseStamped, PointStamped, QuaternionStamped, Pose, Point, Quaternion
 from trajectory_msgs.msg import JointTrajectoryPoint
 from interpolated_ik_motion_planner.srv import SetInterpolatedIKMotionPlanParams, SetInterpolatedIKMotionPlanParamsResponse
+from interpolated_ik_motion_planner.srv import GetInterpolatedIKMotionPlanBatch, GetInterpolatedIKMotionPlanBatchResponse
+from interpolated_ik_motion_planner.msg import InterpolatedIKMotionPlan
 from sensor_msgs.msg import JointState
 
 # class to provide the interpolated ik motion planner service
@@ -158,6 +164,10 @@ class InterpolatedIKService:
         s2 = rospy.Service(which_arm+'_interpolated_ik_motion_plan_set_params', \
                 SetInterpolatedIKMotionPlanParams, self.set_params_callback)
 
+        #advertise batch interpolated IK service
+        s3 = rospy.Service(which_arm+'_interpolated_ik_motion_plan_batch', \
+                GetInterpolatedIKMotionPlanBatch, self.interpolated_ik_motion_plan_batch_callback)
+
 
     ##add a header to a message with a 0 timestamp (good for getting the latest TF transform)
     def add_header(self, msg, frame):
@@ -188,10 +198,44 @@ class InterpolatedIKService:
 
     ##callback for get_interpolated_ik_motion_plan service
     def interpolated_ik_motion_planner_callback(self, req):
+        return self.plan(req.motion_plan_request, self.num_steps, self.collision_check_resolution, self.start_from_end)
+
+
+    ##callback for the batch service: plans each request in turn, with its own num_steps, 
+    #collision_check_resolution and start_from_end values
+    def interpolated_ik_motion_plan_batch_callback(self, req):
+        num_requests = len(req.motion_plan_requests)
+        if len(req.num_steps) != num_requests or len(req.collision_check_resolution) != num_requests or \
+                len(req.start_from_end) != num_requests:
+            rospy.logerr("num_steps, collision_check_resolution and start_from_end need to be the same length as motion_plan_requests!  Quitting")
+            return 0
+        res = GetInterpolatedIKMotionPlanBatchResponse()
+        for ind in range(num_requests):
+            plan = InterpolatedIKMotionPlan()
+            #a request that can not be planned must not take the rest of the batch down with it
+            try:
+                plan_res = self.plan(req.motion_plan_requests[ind], req.num_steps[ind], \
+                                     req.collision_check_resolution[ind], req.start_from_end[ind])
+            except Exception, e:
+                rospy.logerr("interpolated IK batch: request %d failed: %s"%(ind, str(e)))
+                plan_res = 0
+            if plan_res:
+                plan.trajectory = plan_res.trajectory
+                plan.error_code = plan_res.error_code
+                plan.trajectory_error_codes = plan_res.trajectory_error_codes
+            else:
+                plan.error_code.val = ArmNavigationErrorCodes.PLANNING_FAILED
+            res.plans.append(plan)
+        return res
+
+
+    ##plans a single request; the params that can change from one request to the next are passed in, 
+    #so that batch requests do not modify the ones set through the set_params service
+    def plan(self, motion_plan_request, num_steps, collision_check_resolution, start_from_end):
 
         #names and angles for the joints in their desired order
-        joint_names = req.motion_plan_request.start_state.joint_state.name
-        start_angles = req.motion_plan_request.start_state.joint_state.position
+        joint_names = motion_plan_request.start_state.joint_state.name
+        start_angles = motion_plan_request.start_state.joint_state.position
 
         #sanity-checking: joint_names and start_angles should be the same length, if any start_angles are specified
         if start_angles and len(joint_names) != len(start_angles):
@@ -247,26 +291,26 @@ class InterpolatedIKService:
             IK_robot_state.joint_state.position = additional_joint_angles
 
         #check that the desired link is in the list of possible IK links (only r/l_wrist_roll_link for now)
-        link_name = req.motion_plan_request.start_state.multi_dof_joint_state.child_frame_ids[0]
+        link_name = motion_plan_request.start_state.multi_dof_joint_state.child_frame_ids[0]
         if link_name != self.ik_utils.link_name:
             rospy.logerr("link_name not allowed: %s"%link_name)
             return 0
 
         #the start pose for that link
-        start_pose = req.motion_plan_request.start_state.multi_dof_joint_state.poses[0]
+        start_pose = motion_plan_request.start_state.multi_dof_joint_state.poses[0]
 
         #the frame that start pose is in
-        frame_id = req.motion_plan_request.start_state.multi_dof_joint_state.frame_ids[0]
+        frame_id = motion_plan_request.start_state.multi_dof_joint_state.frame_ids[0]
 
         #turn it into a PoseStamped
         start_pose_stamped = self.add_header(PoseStamped(), frame_id)
         start_pose_stamped.pose = start_pose
 
         #the desired goal position
-        goal_pos = req.motion_plan_request.goal_constraints.position_constraints[0].position         
+        goal_pos = motion_plan_request.goal_constraints.position_constraints[0].position         
         
         #the frame that goal position is in
-        goal_pos_frame = req.motion_plan_request.goal_constraints.position_constraints[0].header.frame_id
+        goal_pos_frame = motion_plan_request.goal_constraints.position_constraints[0].header.frame_id
 
         #convert the position to base_link frame
         goal_ps = self.add_header(PointStamped(), goal_pos_frame)
@@ -274,10 +318,10 @@ class InterpolatedIKService:
         goal_pos_list = self.ik_utils.point_stamped_to_list(goal_ps, 'base_link')
 
         #the desired goal orientation
-        goal_quat = req.motion_plan_request.goal_constraints.orientation_constraints[0].orientation
+        goal_quat = motion_plan_request.goal_constraints.orientation_constraints[0].orientation
 
         #the frame that goal orientation is in
-        goal_quat_frame = req.motion_plan_request.goal_constraints.orientation_constraints[0].header.frame_id 
+        goal_quat_frame = motion_plan_request.goal_constraints.orientation_constraints[0].header.frame_id 
 
         #convert the quaternion to base_link frame
         goal_qs = self.add_header(QuaternionStamped(), goal_quat_frame)
@@ -289,27 +333,27 @@ class InterpolatedIKService:
         goal_pose_stamped.pose = Pose(Point(*goal_pos_list), Quaternion(*goal_quat_list))
 
         #get the ordered collision operations, if there are any
-        ordered_collision_operations = None #req.motion_plan_request.ordered_collision_operations
+        ordered_collision_operations = None #motion_plan_request.ordered_collision_operations
         #if ordered_collision_operations.collision_operations == []:
         #    ordered_collision_operations = None
 
         #get the link paddings, if there are any
-        link_padding = None #req.motion_plan_request.link_padding
+        link_padding = None #motion_plan_request.link_padding
         #if link_padding == []:
         #    link_padding = None
 
         #RUN!  Check the Cartesian path for consistent, non-colliding IK solutions
         (trajectory, error_codes) = self.ik_utils.check_cartesian_path(start_pose_stamped, \
                  goal_pose_stamped, reordered_start_angles, self.pos_spacing, self.rot_spacing, \
-                 self.consistent_angle, self.collision_aware, self.collision_check_resolution, \
-                 self.steps_before_abort, self.num_steps, ordered_collision_operations, \
-                 self.start_from_end, IK_robot_state, link_padding)
+                 self.consistent_angle, self.collision_aware, collision_check_resolution, \
+                 self.steps_before_abort, num_steps, ordered_collision_operations, \
+                 start_from_end, IK_robot_state, link_padding)
 
         #find appropriate velocities and times for the valid part of the resulting joint path (invalid parts set to 0)
         #if we're searching from the end, keep the end; if we're searching from the start, keep the start
         start_ind = 0
         stop_ind = len(error_codes)
-        if self.start_from_end:
+        if start_from_end:
             for ind in range(len(error_codes)-1, 0, -1):
                 if error_codes[ind]:
                     start_ind = ind+1
@@ -72,6 +72,17 @@ class GraspExecutor
   //! The result of interpolated IK from grasp to lift
   trajectory_msgs::JointTrajectory interpolated_lift_trajectory_; 
 
+  //! The interpolated IK request for the path from the grasp to lift the object
+  MechanismInterface::InterpolatedIKRequest 
+    liftIKRequest(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                  const object_manipulation_msgs::Grasp &grasp,
+                  const std::vector<double> &grasp_joint_angles);
+
+  //! Checks if the path found for lifting the object is long enough
+  object_manipulation_msgs::GraspResult 
+    liftIKResult(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                 const MechanismInterface::InterpolatedIKResult &ik_result);
+
   //! Calls the interpolated IK service to find a path from the grasp to lift the object
   object_manipulation_msgs::GraspResult 
     getInterpolatedIKForLift(const object_manipulation_msgs::PickupGoal &pickup_goal,
@@ -119,6 +130,24 @@ class GraspExecutor
   object_manipulation_msgs::GraspResult 
     checkAndExecuteGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
 			 const object_manipulation_msgs::Grasp &grasp);
+
+  //! Only checks if the grasp is feasible, without executing anything
+  /*! Returns the result of prepareGrasp(). The information that prepareGrasp() generates is stored in
+    the executor, so grasps that are checked at the same time must use different executors. Meant to be 
+    used on executors that do not publish markers. */
+  object_manipulation_msgs::GraspResult 
+    checkGraspFeasibility(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                          const object_manipulation_msgs::Grasp &grasp)
+  {
+    return prepareGrasp(pickup_goal, grasp);
+  }
+
+  //! Executes and lifts a grasp that has already been found feasible by checkGraspFeasibility()
+  /*! Must be called on the same executor that performed the check, as it uses the information 
+    generated then. Called by checkAndExecuteGrasp() after prepareGrasp() succeeds. */
+  object_manipulation_msgs::GraspResult 
+    executePreparedGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                         const object_manipulation_msgs::Grasp &grasp);
   
   //! Called if the grasp fails to retreat the gripper
   /*! By default, a grasp executor does not know how to do this.
@@ -64,6 +64,26 @@ class GraspExecutorWithApproach : public GraspExecutor
   //! The result of interpolated IK from pre-grasp to grasp
   trajectory_msgs::JointTrajectory interpolated_grasp_trajectory_;
 
+  //! The interpolated IK request for the path from grasp back to pre-grasp
+  MechanismInterface::InterpolatedIKRequest 
+    approachIKRequest(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                      const object_manipulation_msgs::Grasp &grasp);
+
+  //! Checks if the path found between pre-grasp and grasp has enough points
+  object_manipulation_msgs::GraspResult 
+    approachIKResult(const object_manipulation_msgs::Grasp &grasp,
+                     const MechanismInterface::InterpolatedIKResult &ik_result);
+
+  //! Checks that the start of the grasp trajectory is also valid with default padding
+  object_manipulation_msgs::GraspResult 
+    checkPreGraspValidity(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                          const trajectory_msgs::JointTrajectory &grasp_trajectory);
+
+  //! Checks that the end of the lift trajectory is also valid with default padding
+  object_manipulation_msgs::GraspResult 
+    checkLiftValidity(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                      const trajectory_msgs::JointTrajectory &lift_trajectory);
+
   //! Computes an interpolated IK trajectory between pre_grasp and grasp and checks if it has enough points
   object_manipulation_msgs::GraspResult 
     getInterpolatedIKForGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
@@ -92,6 +112,15 @@ class GraspExecutorWithApproach : public GraspExecutor
   //! Also adds a grasp marker at the pre-grasp location
   GraspExecutorWithApproach(GraspMarkerPublisher *pub) : GraspExecutor(pub) {}
 
+  //! Checks the feasibility of a whole list of grasps, without executing anything
+  /*! Performs the same checks as prepareGrasp(), but the interpolated IK paths for all the grasps 
+    are computed in two exchanges with the server: one for all the approach paths, then one for all 
+    the lift paths. Returns one result for each grasp, in the same order. The trajectories are not 
+    kept, so the grasps must be prepared again to be executed. Does not change grasp markers. */
+  void checkGraspsFeasibility(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                              const std::vector<object_manipulation_msgs::Grasp> &grasps,
+                              std::vector<object_manipulation_msgs::GraspResult> &results);
+
   //! Retreats along the gripper approach direction
   virtual object_manipulation_msgs::GraspResult 
     retreat(const object_manipulation_msgs::PickupGoal &pickup_goal,
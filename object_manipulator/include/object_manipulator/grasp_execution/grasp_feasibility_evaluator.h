@@ -0,0 +1,67 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef _GRASP_FEASIBILITY_EVALUATOR_H_
+#define _GRASP_FEASIBILITY_EVALUATOR_H_
+
+#include "object_manipulation_msgs/Grasp.h"
+#include "object_manipulation_msgs/GraspResult.h"
+#include "object_manipulation_msgs/PickupGoal.h"
+
+#include "object_manipulator/tools/feasibility_evaluator.h"
+
+namespace object_manipulator {
+
+class GraspExecutor;
+
+//! Checks the feasibility of a list of grasps ahead of execution, using a pool of worker threads
+/*! Calls checkGraspFeasibility() on the executors of the workers; a grasp found feasible can be 
+  executed right away by calling executePreparedGrasp() on the executor returned by 
+  takePreparedExecutor().
+
+  Checks can continue while the caller executes a grasp (speculatively preparing the next ones in 
+  case it fails), as long as the execution does not rely on state that the checks change on the 
+  servers; the mechanism interface guards the planning scene for move arm calls.
+*/
+class GraspFeasibilityEvaluator : 
+  public FeasibilityEvaluator<GraspExecutor, object_manipulation_msgs::PickupGoal, 
+                              object_manipulation_msgs::Grasp, object_manipulation_msgs::GraspResult>
+{
+ public:
+  //! Starts the worker threads
+  GraspFeasibilityEvaluator(size_t num_workers, ExecutorFactory executor_factory);
+};
+
+} //namespace object_manipulator
+
+#endif
@@ -0,0 +1,145 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef _GRASP_PRESCREENER_H_
+#define _GRASP_PRESCREENER_H_
+
+#include <ros/ros.h>
+
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <tf/transform_datatypes.h>
+
+#include "object_manipulation_msgs/Grasp.h"
+#include "object_manipulation_msgs/GraspResult.h"
+#include "object_manipulation_msgs/PickupGoal.h"
+
+#include "object_manipulator/tools/reachability_map.h"
+
+namespace object_manipulator {
+
+//! Rejects obviously infeasible grasps using simple geometric tests, before any IK is attempted
+/*! The tests only use information in the pickup goal, plus a few transforms looked up once per 
+  pickup, so they take microseconds per grasp. They are meant to be conservative: a grasp is only 
+  rejected if it can clearly not be executed. A test is skipped if the information it needs is 
+  not available.
+
+  - reach: if a reachability map is available for the arm, the grasp position must fall in a 
+  voxel where at least one gripper orientation was found reachable. Otherwise, the grasp position 
+  must be within a given distance from the origin of a frame on the arm (e.g. the shoulder), given 
+  by the private params prescreen/<arm_name>/reach_frame and prescreen/<arm_name>/max_reach; 
+  skipped if they are not set either.
+
+  - support surface: the support surface is taken to be the plane perpendicular to the lift 
+  direction passing through the lowest point of the object cluster. The gripper frame must be 
+  above it by at least the prescreen/surface_clearance param, and so must the pre-grasp position
+  (backed up along the approach direction by the desired approach distance). Skipped if there is 
+  no cluster, or if the pickup goal allows collisions between the gripper and the support surface.
+*/
+class GraspPrescreener
+{
+ public:
+  //! Counts of grasps checked and rejected by each test
+  struct Statistics
+  {
+    unsigned int grasps_checked;
+    unsigned int rejected_out_of_reach;
+    unsigned int rejected_surface_collision;
+    unsigned int rejected_approach_through_surface;
+    //! Total time spent in the tests, in seconds
+    double time;
+    Statistics() : grasps_checked(0), rejected_out_of_reach(0), rejected_surface_collision(0),
+                   rejected_approach_through_surface(0), time(0.0) {}
+  };
+
+ private:
+  //! The private node handle used to read the params
+  ros::NodeHandle priv_nh_;
+
+  //! Statistics accumulated since construction
+  Statistics statistics_;
+
+  //! Protects the statistics, which can be read from other threads
+  boost::mutex statistics_mutex_;
+
+  //! The parameters of all the tests for one pickup goal, expressed in the frame of the grasps
+  struct Tests
+  {
+    bool check_reach;
+    tf::Vector3 reach_center;
+    double max_reach;
+
+    //! If set, used instead of the reach envelope
+    boost::shared_ptr<const ReachabilityMap> reachability_map;
+    //! Transforms grasp positions into the frame of the reachability map
+    tf::Transform reachability_map_transform;
+
+    bool check_surface;
+    //! Normal of the support surface, pointing away from it
+    tf::Vector3 surface_normal;
+    //! Height of the support surface along its normal
+    double surface_height;
+    double surface_clearance;
+
+    //! The approach direction of the hand, in the gripper frame
+    tf::Vector3 approach_direction;
+  };
+
+  //! Sets up the tests for a given pickup goal
+  Tests setupTests(const object_manipulation_msgs::PickupGoal &pickup_goal);
+
+  //! Runs the tests on one grasp; returns SUCCESS if it passes all of them
+  int testGrasp(const Tests &tests, const object_manipulation_msgs::PickupGoal &pickup_goal,
+                const object_manipulation_msgs::Grasp &grasp, Statistics &statistics);
+
+ public:
+  GraspPrescreener() : priv_nh_("~") {}
+
+  //! Removes the grasps that fail any of the tests from the list
+  /*! The grasps that are removed are appended to rejected_grasps, and the reasons they were rejected to
+    rejected_results. The order of the remaining grasps is preserved. */
+  void prescreen(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                 std::vector<object_manipulation_msgs::Grasp> &grasps,
+                 std::vector<object_manipulation_msgs::Grasp> &rejected_grasps,
+                 std::vector<object_manipulation_msgs::GraspResult> &rejected_results);
+
+  //! Returns the statistics accumulated so far
+  Statistics getStatistics();
+};
+
+} //namespace object_manipulator
+
+#endif
@@ -52,6 +52,9 @@ class ReactiveGraspExecutor;
 class GraspExecutorWithApproach;
 class UnsafeGraspExecutor;
 class GraspMarkerPublisher;
+class GraspFeasibilityEvaluator;
+class PlaceFeasibilityEvaluator;
+class GraspPrescreener;
 
 //! Oversees the grasping app; bundles together functionality in higher level calls
 /*! Also wraps the functionality in action replies, with the actual server passed in 
@@ -86,6 +89,31 @@ private:
   //! Instance of the executor used for grasping without considering collisions
   UnsafeGraspExecutor* unsafe_grasp_executor_;
 
+  //! Rejects obviously infeasible grasps before any of them is checked or executed
+  GraspPrescreener* grasp_prescreener_;
+
+  //! Whether grasps should be prescreened
+  bool prescreen_grasps_;
+
+  //! Whether grasps and place locations should be tried in order of decreasing reachability
+  /*! Only has an effect for arms that have a reachability map. */
+  bool sort_by_reachability_;
+
+  //! Width of the reachability bands used for sorting; the original order is kept within a band
+  double reachability_band_;
+
+  //! Checks grasp feasibility ahead of execution on multiple threads, or NULL if disabled
+  /*! Uses the same type of executor as grasp_executor_with_approach_ */
+  GraspFeasibilityEvaluator* feasibility_evaluator_;
+
+  //! Checks place location feasibility ahead of execution on multiple threads, or NULL if disabled
+  /*! Only used with place_executor_; the reactive place executor checks locations one at a time */
+  PlaceFeasibilityEvaluator* place_feasibility_evaluator_;
+
+  //! How many of the following grasps are checked in the background while a grasp is being executed
+  /*! If 0, background checks are stopped during execution. */
+  int speculative_grasp_lookahead_;
+
   //! Instance of the executor used for placing objects
   PlaceExecutor* place_executor_;
 
@@ -114,6 +142,9 @@ public:
   void place(const object_manipulation_msgs::PlaceGoal::ConstPtr &place_goal,
 	     actionlib::SimpleActionServer<object_manipulation_msgs::PlaceAction> *action_server);
 
+  //! Returns the grasp prescreener, to allow its statistics to be read
+  GraspPrescreener& getGraspPrescreener() {return *grasp_prescreener_;}
+
 };
 
 } //namespace grasping_app_executive
@@ -80,9 +80,6 @@ protected:
   //! The interpolated trajectory used to retreat after place
   trajectory_msgs::JointTrajectory retreat_trajectory_;
 
-  //! Transform listener 
-  tf::TransformListener listener_;
-
   //! Computes the gripper pose for a desired object place location
   geometry_msgs::PoseStamped computeGripperPose(geometry_msgs::PoseStamped place_location, 
 						geometry_msgs::Pose grasp_pose,
@@ -109,10 +106,29 @@ public:
   PlaceExecutor(GraspMarkerPublisher *marker_publisher) : marker_publisher_(marker_publisher), marker_id_(-1)
   {}
   
+  virtual ~PlaceExecutor() {}
+
   //! Places a grasped object at a specified location
   object_manipulation_msgs::PlaceLocationResult 
     place(const object_manipulation_msgs::PlaceGoal &place_goal, 
 	  const geometry_msgs::PoseStamped &place_location);
+
+  //! Only checks if the location is feasible, without executing anything
+  /*! If it is, the trajectories needed for placing are kept in this executor, and 
+    executePreparedPlace() can be called next. Does not move the robot. */
+  object_manipulation_msgs::PlaceLocationResult 
+    checkPlaceFeasibility(const object_manipulation_msgs::PlaceGoal &place_goal, 
+                          const geometry_msgs::PoseStamped &place_location)
+  {
+    return prepareInterpolatedTrajectories(place_goal, place_location);
+  }
+
+  //! Places the object at a location that has already been found feasible by checkPlaceFeasibility()
+  /*! Must be called on the same executor that performed the check, as it uses the trajectories 
+    computed then. Called by place() after the check succeeds. */
+  object_manipulation_msgs::PlaceLocationResult 
+    executePreparedPlace(const object_manipulation_msgs::PlaceGoal &place_goal, 
+                         const geometry_msgs::PoseStamped &place_location);
 };
 
 //! Uses a reactive version of the move from pre-place to place
@@ -0,0 +1,64 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef _PLACE_FEASIBILITY_EVALUATOR_H_
+#define _PLACE_FEASIBILITY_EVALUATOR_H_
+
+#include <geometry_msgs/PoseStamped.h>
+
+#include "object_manipulation_msgs/PlaceGoal.h"
+#include "object_manipulation_msgs/PlaceLocationResult.h"
+
+#include "object_manipulator/tools/feasibility_evaluator.h"
+
+namespace object_manipulator {
+
+class PlaceExecutor;
+
+//! Checks the feasibility of a list of place locations ahead of execution, using a pool of worker threads
+/*! Calls checkPlaceFeasibility() on the executors of the workers; a location found feasible can be 
+  used right away by calling executePreparedPlace() on the executor returned by takePreparedExecutor().
+  Call stop() before executing a place, so that no checks are left running while the robot moves.
+*/
+class PlaceFeasibilityEvaluator : 
+  public FeasibilityEvaluator<PlaceExecutor, object_manipulation_msgs::PlaceGoal, 
+                              geometry_msgs::PoseStamped, object_manipulation_msgs::PlaceLocationResult>
+{
+ public:
+  //! Starts the worker threads
+  PlaceFeasibilityEvaluator(size_t num_workers, ExecutorFactory executor_factory);
+};
+
+} //namespace object_manipulator
+
+#endif
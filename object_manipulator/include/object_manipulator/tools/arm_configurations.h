@@ -36,82 +36,140 @@
 #include <ros/ros.h>
 
 #include <cmath>
+#include <map>
+
+#include <boost/thread/mutex.hpp>
 
 #include <geometry_msgs/Vector3.h>
 
 #include "object_manipulator/tools/exceptions.h"
+#include "object_manipulator/tools/compiled_param.h"
+#include "object_manipulator/tools/param_helpers.h"
 
 namespace object_manipulator {
 
 class ArmConfigurations
 {
+ public:
+  typedef std::map<std::string, CompiledParam< std::vector<double> > > PositionMap;
+  typedef std::map<std::string, CompiledParam< std::vector< std::vector<double> > > > TrajectoryMap;
+
+  //! The configurations of one arm read so far, by configuration name
+  /*! Configurations are read from the parameter server the first time they are asked for. An entry 
+    that was missing then is read again the next time it is asked for. */
+  struct Arm
+  {
+    PositionMap positions;
+    TrajectoryMap trajectories;
+  };
+
  private:
+  typedef std::map<std::string, Arm> ArmMap;
+
   //! Node handle in the root namespace
   ros::NodeHandle root_nh_;
 
-  inline std::string getStringParam(std::string name)
+  //! The configurations read so far, by arm name
+  ArmMap arms_;
+
+  boost::mutex arms_mutex_;
+
+  static inline std::vector<double> getPositionParam(const ros::NodeHandle &nh, const std::string &name)
   {
-    std::string value;
-    if (!root_nh_.getParamCached(name, value)) throw MissingParamException(name);
-    //ROS_INFO_STREAM("Hand description param " << name << " resolved to " << value);
-    return value;
+    std::vector<double> values = getVectorDoubleParam(nh, name);
+    if ( values.size() != 7 )  throw BadParamException(name);
+    return values;
   }
 
-  inline std::vector<std::string> getVectorParam(std::string name)
+  static inline std::vector< std::vector<double> > getTrajectoryParam(const ros::NodeHandle &nh, 
+                                                                      const std::string &name)
   {
-    XmlRpc::XmlRpcValue list;
-    if (!root_nh_.getParamCached(name, list)) throw MissingParamException(name);
-    if (list.getType() != XmlRpc::XmlRpcValue::TypeArray) throw BadParamException(name);
-    //ROS_INFO_STREAM("Hand description vector param " << name << " resolved to:");
-    std::vector<std::string> values;
-    for (int32_t i=0; i<list.size(); i++)
+    std::vector<double> values = getVectorDoubleParam(nh, name);
+    if ( values.size() % 7 != 0 )  throw BadParamException(name);
+    std::vector< std::vector<double> > traj;
+    int waypoints = values.size() / 7;
+    traj.resize( waypoints );
+    for(int i = 0; i < waypoints; i++)
     {
-      if (list[i].getType() != XmlRpc::XmlRpcValue::TypeString) throw BadParamException(name);
-      values.push_back( static_cast<std::string>(list[i]) );
-      //ROS_INFO_STREAM("  " << values.back());
+      traj[i].assign( values.begin() + i*7, values.begin() + (i+1)*7 );
     }
-    return values;	
+    return traj;
   }
 
-  inline std::vector<double> getVectorDoubleParam(std::string name)
+  inline CompiledParam< std::vector<double> > compilePosition(const std::string &arm_name, 
+                                                              const std::string &position)
+  {
+    return compileParam(root_nh_, "/arm_configurations/" + position + "/position/" + arm_name, 
+                        &ArmConfigurations::getPositionParam);
+  }
+
+  inline CompiledParam< std::vector< std::vector<double> > > compileTrajectory(const std::string &arm_name, 
+                                                                                const std::string &position)
+  {
+    return compileParam(root_nh_, "/arm_configurations/" + position + "/trajectory/" + arm_name, 
+                        &ArmConfigurations::getTrajectoryParam);
+  }
+
+  //! Returns a configuration from one of the maps of an arm, reading it first if needed
+  /*! The parameter server is read without holding the mutex. */
+  template <class T>
+  inline T lookup(std::map<std::string, CompiledParam<T> > Arm::*configurations, 
+                  const std::string &arm_name, const std::string &position,
+                  CompiledParam<T> (ArmConfigurations::*compile)(const std::string&, const std::string&))
   {
-    XmlRpc::XmlRpcValue list;
-    if (!root_nh_.getParamCached(name, list)) throw MissingParamException(name);
-    if (list.getType() != XmlRpc::XmlRpcValue::TypeArray) throw BadParamException(name);
-    std::vector<double> values;
-    for (int32_t i=0; i<list.size(); i++)
     {
-      if (list[i].getType() != XmlRpc::XmlRpcValue::TypeDouble) throw BadParamException(name);
-      values.push_back( static_cast<double>(list[i]) );
+      boost::mutex::scoped_lock lock(arms_mutex_);
+      std::map<std::string, CompiledParam<T> > &entries = arms_[arm_name].*configurations;
+      typename std::map<std::string, CompiledParam<T> >::iterator it = entries.find(position);
+      if (it != entries.end() && !it->second.missing()) return it->second.get();
     }
-    return values;	
+    CompiledParam<T> param = (this->*compile)(arm_name, position);
+    {
+      boost::mutex::scoped_lock lock(arms_mutex_);
+      (arms_[arm_name].*configurations)[position] = param;
+    }
+    return param.get();
   }
 
  public:
  ArmConfigurations() : root_nh_("~") {}
 
-  inline std::vector< double > position(std::string arm_name, std::string position)
+  //! Reads all the configurations asked for so far from the parameter server again
+  /*! The new configurations replace the old ones all at once; lookups never see a mix of the two. Only
+    called on request (see the reload_params service of the object manipulator node). */
+  inline void reload()
   {
-    std::string name = "/arm_configurations/" + position + "/position/" + arm_name;
-    std::vector<double> values = getVectorDoubleParam(name);
-    if ( values.size() != 7 )  throw BadParamException(name);
-    return values;
+    std::vector< std::pair<std::string, std::string> > positions, trajectories;
+    {
+      boost::mutex::scoped_lock lock(arms_mutex_);
+      for (ArmMap::iterator it = arms_.begin(); it != arms_.end(); it++)
+      {
+        for (PositionMap::iterator pit = it->second.positions.begin(); pit != it->second.positions.end(); pit++)
+          positions.push_back( std::make_pair(it->first, pit->first) );
+        for (TrajectoryMap::iterator tit = it->second.trajectories.begin(); 
+             tit != it->second.trajectories.end(); tit++)
+          trajectories.push_back( std::make_pair(it->first, tit->first) );
+      }
+    }
+    ArmMap arms;
+    for (size_t i=0; i<positions.size(); i++)
+      arms[positions[i].first].positions[positions[i].second] = 
+        compilePosition(positions[i].first, positions[i].second);
+    for (size_t i=0; i<trajectories.size(); i++)
+      arms[trajectories[i].first].trajectories[trajectories[i].second] = 
+        compileTrajectory(trajectories[i].first, trajectories[i].second);
+    boost::mutex::scoped_lock lock(arms_mutex_);
+    arms_.swap(arms);
   }
 
-  inline std::vector< std::vector<double> > trajectory(std::string arm_name, std::string position)
+  inline std::vector< double > position(const std::string &arm_name, const std::string &position)
   {
-    std::string name = "/arm_configurations/" + position + "/trajectory/" + arm_name;
-    std::vector<double> values = getVectorDoubleParam(name);
-    if ( values.size() % 7 != 0 )  throw BadParamException(name);
-    std::vector< std::vector<double> > traj;
-    int waypoints = values.size() / 7;
-    traj.resize( waypoints );
-    for(int i = 0; i < waypoints; i++)
-    {
-      std::vector<double> pos;
-      traj[i].insert(pos.begin(), values.begin() + i*7, values.begin() + (i+1)*7 );
-    }
-    return traj;
+    return lookup(&Arm::positions, arm_name, position, &ArmConfigurations::compilePosition);
+  }
+
+  inline std::vector< std::vector<double> > trajectory(const std::string &arm_name, const std::string &position)
+  {
+    return lookup(&Arm::trajectories, arm_name, position, &ArmConfigurations::compileTrajectory);
   }
 
 };
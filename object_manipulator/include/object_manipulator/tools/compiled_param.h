@@ -0,0 +1,99 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef _COMPILED_PARAM_H_
+#define _COMPILED_PARAM_H_
+
+#include <string>
+
+#include <ros/ros.h>
+
+#include "object_manipulator/tools/exceptions.h"
+
+namespace object_manipulator {
+
+//! A value read from the parameter server once, along with the reason it could not be read, if any
+/*! The exception that reading the parameter would have thrown is thrown when the value is asked for,
+  so that a missing parameter is only an error for those that actually need it. */
+template <class T>
+class CompiledParam
+{
+ public:
+  enum Status {VALID, MISSING, BAD};
+
+ private:
+  T value_;
+  std::string name_;
+  Status status_;
+
+ public:
+ CompiledParam() : status_(MISSING) {}
+
+  inline void set(const std::string &name, const T &value) {name_ = name; value_ = value; status_ = VALID;}
+
+  inline void setError(const std::string &name, Status status) {name_ = name; status_ = status;}
+
+  //! True if the parameter was not set when it was read; it might have been set since
+  inline bool missing() const {return status_ == MISSING;}
+
+  inline const T& get() const
+  {
+    if (status_ == MISSING) throw MissingParamException(name_);
+    if (status_ == BAD) throw BadParamException(name_);
+    return value_;
+  }
+};
+
+//! Reads one parameter into a compiled one, using one of the functions in param_helpers.h or similar
+template <class T>
+inline CompiledParam<T> compileParam(const ros::NodeHandle &nh, const std::string &name, 
+                                     T (*read)(const ros::NodeHandle&, const std::string&))
+{
+  CompiledParam<T> param;
+  try
+  {
+    param.set(name, read(nh, name));
+  }
+  catch (MissingParamException &)
+  {
+    param.setError(name, CompiledParam<T>::MISSING);
+  }
+  catch (BadParamException &)
+  {
+    param.setError(name, CompiledParam<T>::BAD);
+  }
+  return param;
+}
+
+} //namespace object_manipulator
+
+#endif
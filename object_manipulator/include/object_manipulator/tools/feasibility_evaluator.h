@@ -0,0 +1,332 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef _FEASIBILITY_EVALUATOR_H_
+#define _FEASIBILITY_EVALUATOR_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <ros/ros.h>
+
+#include "object_manipulator/tools/mechanism_interface.h"
+
+namespace object_manipulator {
+
+//! Checks the feasibility of a list of candidates ahead of execution, using a pool of worker threads
+/*! The candidates are e.g. grasps or place locations. Each worker has its own executor (created using the factory passed in at construction) and runs
+  the check function on it for the candidates it is handed. Candidates are handed out in list order,
+  so the results for the first candidates in the list are generally available first. The time each 
+  check took is recorded along with its result.
+
+  Each worker thread uses its own service clients; the mechanism interface takes care of keeping
+  the state held by the servers (planning scene, interpolated IK params) consistent between workers.
+
+  When a check succeeds, the executor that performed it (which now holds the trajectories needed
+  for execution) is kept for that candidate and the worker gets a new one. The caller can then take 
+  it using takePreparedExecutor() and execute the candidate right away.
+
+  Only feasibility checks are run concurrently: nothing here moves the robot. Use setLimit() to 
+  control how far ahead the checks go, or stop() to have no checks in progress at all.
+
+  The Result type must have a result_code field and a SUCCESS constant, like the GraspResult and 
+  PlaceLocationResult messages.
+*/
+template <class Executor, class Goal, class Candidate, class Result>
+class FeasibilityEvaluator
+{
+ public:
+  typedef boost::function<Executor*()> ExecutorFactory;
+  typedef boost::function<Result(Executor*, const Goal&, const Candidate&)> CheckFunction;
+
+  //! The state of the check for a single candidate
+  enum Status {PENDING, DONE, NOT_EVALUATED};
+
+ private:
+  //! Creates new executors for the workers
+  ExecutorFactory executor_factory_;
+
+  //! Checks a single candidate using a given executor
+  CheckFunction check_function_;
+
+  //! What the candidates are, for log messages
+  std::string candidate_name_;
+
+  //! The executors used by the workers, one per worker
+  std::vector<Executor*> executors_;
+
+  //! For each candidate found feasible, the executor that checked it, until taken by the caller
+  std::vector<Executor*> prepared_executors_;
+
+  //! The worker threads
+  boost::thread_group workers_;
+
+  //! The goal the current candidates are checked for
+  boost::shared_ptr<const Goal> goal_;
+
+  //! The candidates currently being checked
+  boost::shared_ptr<const std::vector<Candidate> > candidates_;
+
+  //! The status of the check for each candidate
+  std::vector<Status> status_;
+
+  //! The result of the check for each candidate, valid if the status is DONE
+  std::vector<Result> results_;
+
+  //! How long the check for each candidate took, valid if the status is DONE
+  std::vector<ros::WallDuration> check_times_;
+
+  //! The next candidate to be handed out to a worker
+  size_t next_candidate_;
+
+  //! Candidates from this one on are not handed out
+  size_t limit_;
+
+  //! The number of checks currently in progress
+  size_t checks_in_progress_;
+
+  //! Incremented for every new list of candidates, so that late results for an old list are discarded
+  unsigned int list_id_;
+
+  //! Set when the workers must exit
+  bool shutdown_;
+
+  boost::mutex mutex_;
+
+  //! Signaled when there are new candidates to be checked
+  boost::condition_variable work_condition_;
+
+  //! Signaled when a check is done
+  boost::condition_variable result_condition_;
+
+  static void deleteExecutors(std::vector<Executor*> &executors)
+  {
+    for (size_t i=0; i<executors.size(); i++)
+    {
+      delete executors[i];
+    }
+    executors.clear();
+  }
+
+  //! The main function of each worker thread
+  void workerThread(size_t worker)
+  {
+    //the transforms are kept for all the checks on the same list of candidates
+    boost::scoped_ptr<MechanismInterface::ScopedTransformSnapshot> transform_snapshot;
+    unsigned int snapshot_list_id = 0;
+    while (1)
+    {
+      boost::shared_ptr<const Goal> goal;
+      boost::shared_ptr<const std::vector<Candidate> > candidates;
+      size_t index;
+      unsigned int list_id;
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        while (!shutdown_ && next_candidate_ >= limit_) work_condition_.wait(lock);
+        if (shutdown_) return;
+        goal = goal_;
+        candidates = candidates_;
+        index = next_candidate_++;
+        list_id = list_id_;
+        checks_in_progress_++;
+      }
+
+      Status status = DONE;
+      Result result;
+      ros::WallTime start_time = ros::WallTime::now();
+      try
+      {
+        if (!transform_snapshot || snapshot_list_id != list_id)
+        {
+          transform_snapshot.reset();
+          transform_snapshot.reset(new MechanismInterface::ScopedTransformSnapshot(mechInterface()));
+          snapshot_list_id = list_id;
+        }
+        result = check_function_(executors_[worker], *goal, candidates->at(index));
+      }
+      catch (std::exception &ex)
+      {
+        //leave it to the caller to check this candidate again and deal with the problem
+        ROS_DEBUG_NAMED("manipulation", "Feasibility check for %s %d threw exception: %s", 
+                        candidate_name_.c_str(), (int)index, ex.what());
+        status = NOT_EVALUATED;
+      }
+      ros::WallDuration check_time = ros::WallTime::now() - start_time;
+
+      //the executor that found a candidate feasible is handed over along with the trajectories it 
+      //has prepared, so this worker will need a new one; creating it can take a while, so it is 
+      //not done with the mutex locked
+      Executor *replacement = NULL;
+      if (status == DONE && result.result_code == Result::SUCCESS) replacement = executor_factory_();
+
+      {
+        boost::mutex::scoped_lock lock(mutex_);
+        checks_in_progress_--;
+        if (list_id == list_id_)
+        {
+          status_[index] = status;
+          results_[index] = result;
+          check_times_[index] = check_time;
+          if (replacement)
+          {
+            prepared_executors_[index] = executors_[worker];
+            executors_[worker] = replacement;
+            replacement = NULL;
+          }
+        }
+        result_condition_.notify_all();
+      }
+      //the list was abandoned while we were checking, the old executor is kept
+      delete replacement;
+    }
+  }
+
+ public:
+  //! Starts the worker threads
+  FeasibilityEvaluator(size_t num_workers, ExecutorFactory executor_factory, CheckFunction check_function,
+                       std::string candidate_name) :
+    executor_factory_(executor_factory), check_function_(check_function), candidate_name_(candidate_name),
+    next_candidate_(0), limit_(0), checks_in_progress_(0), list_id_(0), shutdown_(false)
+  {
+    for (size_t i=0; i<num_workers; i++)
+    {
+      executors_.push_back(executor_factory_());
+    }
+    for (size_t i=0; i<num_workers; i++)
+    {
+      workers_.create_thread(boost::bind(&FeasibilityEvaluator::workerThread, this, i));
+    }
+  }
+
+  //! Stops the worker threads and deletes the executors, including prepared ones not taken
+  virtual ~FeasibilityEvaluator()
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      shutdown_ = true;
+      work_condition_.notify_all();
+    }
+    workers_.join_all();
+    deleteExecutors(executors_);
+    deleteExecutors(prepared_executors_);
+  }
+
+  //! Starts checking a new list of candidates; returns immediately
+  /*! Anything left of a previous list is abandoned. */
+  void start(const Goal &goal, const std::vector<Candidate> &candidates)
+  {
+    std::vector<Executor*> abandoned_executors;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      list_id_++;
+      goal_.reset(new Goal(goal));
+      candidates_.reset(new std::vector<Candidate>(candidates));
+      status_.assign(candidates.size(), PENDING);
+      results_.assign(candidates.size(), Result());
+      check_times_.assign(candidates.size(), ros::WallDuration());
+      abandoned_executors.swap(prepared_executors_);
+      prepared_executors_.resize(candidates.size(), NULL);
+      next_candidate_ = 0;
+      limit_ = candidates.size();
+      work_condition_.notify_all();
+    }
+    deleteExecutors(abandoned_executors);
+  }
+
+  //! Waits until the check for a candidate is done, or until it is known that it will not be done
+  /*! Returns NOT_EVALUATED if the check was not started and is beyond the current limit, or if it 
+    threw an exception; in that case the caller should check the candidate itself. Otherwise returns 
+    DONE and sets the result and the time the check took. */
+  Status waitForResult(size_t index, Result &result, ros::WallDuration &check_time)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (index >= status_.size()) return NOT_EVALUATED;
+    //wait if the check is in progress or will be started
+    while (status_[index] == PENDING && (index < next_candidate_ || index < limit_)) result_condition_.wait(lock);
+    if (status_[index] != DONE) return NOT_EVALUATED;
+    result = results_[index];
+    check_time = check_times_[index];
+    return DONE;
+  }
+
+  //! Same as above, for callers that do not need the time the check took
+  Status waitForResult(size_t index, Result &result)
+  {
+    ros::WallDuration check_time;
+    return waitForResult(index, result, check_time);
+  }
+
+  //! Returns the executor that found a candidate feasible, ready to execute it
+  /*! The caller takes ownership. Returns NULL if the candidate was not found feasible, or if its 
+    executor has already been taken. */
+  Executor* takePreparedExecutor(size_t index)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (index >= prepared_executors_.size()) return NULL;
+    Executor *executor = prepared_executors_[index];
+    prepared_executors_[index] = NULL;
+    return executor;
+  }
+
+  //! Only candidates before end will be handed out from now on
+  /*! Checks already in progress are not affected. The limit can be raised again later. */
+  void setLimit(size_t end)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    limit_ = std::min(end, status_.size());
+    work_condition_.notify_all();
+    result_condition_.notify_all();
+  }
+
+  //! Stops handing out candidates and waits for the checks in progress to finish
+  void stop()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    limit_ = next_candidate_;
+    result_condition_.notify_all();
+    while (checks_in_progress_ > 0) result_condition_.wait(lock);
+  }
+};
+
+} //namespace object_manipulator
+
+#endif
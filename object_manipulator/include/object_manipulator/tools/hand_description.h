@@ -36,127 +36,203 @@
 #include <ros/ros.h>
 
 #include <cmath>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <geometry_msgs/Vector3.h>
 
 #include "object_manipulator/tools/exceptions.h"
+#include "object_manipulator/tools/compiled_param.h"
+#include "object_manipulator/tools/param_helpers.h"
 
 namespace object_manipulator {
 
 class HandDescription
 {
+ public:
+  //! Everything known about the hand of one arm, read from the parameter server at once
+  struct Arm
+  {
+    CompiledParam<std::string> gripper_frame;
+    CompiledParam<std::string> robot_frame;
+    CompiledParam<std::string> attached_name;
+    CompiledParam<std::string> attach_link_name;
+    CompiledParam<std::string> gripper_collision_name;
+    CompiledParam<std::string> arm_group;
+    CompiledParam<std::string> hand_database_name;
+    CompiledParam< std::vector<std::string> > hand_joint_names;
+    CompiledParam< std::vector<std::string> > gripper_touch_link_names;
+    CompiledParam< std::vector<std::string> > fingertip_links;
+    CompiledParam<geometry_msgs::Vector3> approach_direction;
+    CompiledParam< std::vector<std::string> > arm_joint_names;
+
+    //! True if any of the parameters above was not set when the description was read
+    bool missing_params;
+  };
+
+  typedef boost::shared_ptr<const Arm> ArmPtr;
+
  private:
+  typedef std::map<std::string, ArmPtr> ArmMap;
+
   //! Node handle in the root namespace
   ros::NodeHandle root_nh_;
 
-  inline std::string getStringParam(std::string name)
+  //! The descriptions read so far, by arm name
+  ArmMap arms_;
+
+  boost::mutex arms_mutex_;
+
+  static inline geometry_msgs::Vector3 getDirectionParam(const ros::NodeHandle &nh, const std::string &name)
+  {
+    std::vector<double> values = getVectorDoubleParam(nh, name);
+    if ( values.size() != 3 )  throw BadParamException(name);
+    double length = sqrt( values[0]*values[0] + values[1]*values[1] + values[2]*values[2] );
+    if ( fabs(length) < 1.0e-5 ) throw BadParamException(name);
+    geometry_msgs::Vector3 app;
+    app.x = values[0] / length;
+    app.y = values[1] / length;
+    app.z = values[2] / length;
+    return app;
+  }
+
+  //! Reads the whole description of an arm from the parameter server
+  inline ArmPtr compileArm(const std::string &arm_name)
+  {
+    boost::shared_ptr<Arm> arm(new Arm);
+    std::string prefix = "/hand_description/" + arm_name;
+    arm->gripper_frame = compileParam(root_nh_, prefix + "/hand_frame", &getStringParam);
+    arm->robot_frame = compileParam(root_nh_, prefix + "/robot_frame", &getStringParam);
+    arm->attached_name = compileParam(root_nh_, prefix + "/attached_objects_name", &getStringParam);
+    arm->attach_link_name = compileParam(root_nh_, prefix + "/attach_link", &getStringParam);
+    arm->gripper_collision_name = compileParam(root_nh_, prefix + "/hand_group_name", &getStringParam);
+    arm->arm_group = compileParam(root_nh_, prefix + "/arm_group_name", &getStringParam);
+    arm->hand_database_name = compileParam(root_nh_, prefix + "/hand_database_name", &getStringParam);
+    arm->hand_joint_names = compileParam(root_nh_, prefix + "/hand_joints", &getVectorStringParam);
+    arm->gripper_touch_link_names = compileParam(root_nh_, prefix + "/hand_touch_links", &getVectorStringParam);
+    arm->fingertip_links = compileParam(root_nh_, prefix + "/hand_fingertip_links", &getVectorStringParam);
+    arm->approach_direction = compileParam(root_nh_, prefix + "/hand_approach_direction", 
+                                           &HandDescription::getDirectionParam);
+    arm->arm_joint_names = compileParam(root_nh_, prefix + "/arm_joints", &getVectorStringParam);
+    arm->missing_params = arm->gripper_frame.missing() || arm->robot_frame.missing() || 
+      arm->attached_name.missing() || arm->attach_link_name.missing() || arm->gripper_collision_name.missing() ||
+      arm->arm_group.missing() || arm->hand_database_name.missing() || arm->hand_joint_names.missing() || 
+      arm->gripper_touch_link_names.missing() || arm->fingertip_links.missing() || 
+      arm->approach_direction.missing() || arm->arm_joint_names.missing();
+    return arm;
+  }
+
+  //! Reads the description of an arm again and replaces the one held so far
+  inline ArmPtr recompileArm(const std::string &arm_name)
+  {
+    ArmPtr arm = compileArm(arm_name);
+    boost::mutex::scoped_lock lock(arms_mutex_);
+    arms_[arm_name] = arm;
+    return arm;
+  }
+
+  //! Returns one value from the description of an arm
+  template <class T>
+  inline T get(const std::string &arm_name, CompiledParam<T> Arm::*param)
   {
-    std::string value;
-    if (!root_nh_.getParamCached(name, value)) throw MissingParamException(name);
-    //ROS_INFO_STREAM("Hand description param " << name << " resolved to " << value);
-    return value;
+    return ((*arm(arm_name)).*param).get();
   }
 
-  inline std::vector<std::string> getVectorParam(std::string name)
+ public:
+ HandDescription() : root_nh_("~") {}
+
+  //! Returns the description of an arm, reading it from the parameter server the first time it is asked for
+  /*! The description does not change once returned, even if reload() is called meanwhile, so callers 
+    that need several values can hold on to it and use references into it without copying. A 
+    description with missing parameters is read again on every call, in case they have been set 
+    since. */
+  inline ArmPtr arm(const std::string &arm_name)
   {
-    XmlRpc::XmlRpcValue list;
-    if (!root_nh_.getParamCached(name, list)) throw MissingParamException(name);
-    if (list.getType() != XmlRpc::XmlRpcValue::TypeArray) throw BadParamException(name);
-    //ROS_INFO_STREAM("Hand description vector param " << name << " resolved to:");
-    std::vector<std::string> values;
-    for (int32_t i=0; i<list.size(); i++)
     {
-      if (list[i].getType() != XmlRpc::XmlRpcValue::TypeString) throw BadParamException(name);
-      values.push_back( static_cast<std::string>(list[i]) );
-      //ROS_INFO_STREAM("  " << values.back());
+      boost::mutex::scoped_lock lock(arms_mutex_);
+      ArmMap::iterator it = arms_.find(arm_name);
+      if (it != arms_.end() && !it->second->missing_params) return it->second;
     }
-    return values;	
+    return recompileArm(arm_name);
   }
 
-  inline std::vector<double> getVectorDoubleParam(std::string name)
+  //! Reads the descriptions of all the arms seen so far from the parameter server again
+  /*! The new descriptions replace the old ones all at once; lookups never see a mix of the two. Only
+    called on request (see the reload_params service of the object manipulator node). */
+  inline void reload()
   {
-    XmlRpc::XmlRpcValue list;
-    if (!root_nh_.getParamCached(name, list)) throw MissingParamException(name);
-    if (list.getType() != XmlRpc::XmlRpcValue::TypeArray) throw BadParamException(name);
-    std::vector<double> values;
-    for (int32_t i=0; i<list.size(); i++)
+    std::vector<std::string> arm_names;
     {
-      if (list[i].getType() != XmlRpc::XmlRpcValue::TypeDouble) throw BadParamException(name);
-      values.push_back( static_cast<double>(list[i]) );
+      boost::mutex::scoped_lock lock(arms_mutex_);
+      for (ArmMap::iterator it = arms_.begin(); it != arms_.end(); it++) arm_names.push_back(it->first);
     }
-    return values;	
+    ArmMap arms;
+    for (size_t i=0; i<arm_names.size(); i++) arms[arm_names[i]] = compileArm(arm_names[i]);
+    boost::mutex::scoped_lock lock(arms_mutex_);
+    arms_.swap(arms);
   }
 
- public:
- HandDescription() : root_nh_("~") {}
-
-  inline std::string gripperFrame(std::string arm_name)
+  //! The accessors below return copies; code that runs often should hold on to arm() instead
+  inline std::string gripperFrame(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/hand_frame");
+    return get(arm_name, &Arm::gripper_frame);
   }
 
-  inline std::string robotFrame(std::string arm_name)
+  inline std::string robotFrame(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/robot_frame");
+    return get(arm_name, &Arm::robot_frame);
   }
   
-  inline std::string attachedName(std::string arm_name)
+  inline std::string attachedName(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/attached_objects_name");
+    return get(arm_name, &Arm::attached_name);
   }
   
-  inline std::string attachLinkName(std::string arm_name)
+  inline std::string attachLinkName(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/attach_link");
+    return get(arm_name, &Arm::attach_link_name);
   }
   
-  inline std::string gripperCollisionName(std::string arm_name)
+  inline std::string gripperCollisionName(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/hand_group_name");
+    return get(arm_name, &Arm::gripper_collision_name);
   }
   
-  inline std::string armGroup(std::string arm_name)
+  inline std::string armGroup(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/arm_group_name");    
+    return get(arm_name, &Arm::arm_group);
   }
   
-  inline std::string handDatabaseName(std::string arm_name)
+  inline std::string handDatabaseName(const std::string &arm_name)
   {
-    return getStringParam("/hand_description/" + arm_name + "/hand_database_name");
+    return get(arm_name, &Arm::hand_database_name);
   }
   
-  inline std::vector<std::string> handJointNames(std::string arm_name)
+  inline std::vector<std::string> handJointNames(const std::string &arm_name)
   {
-    return getVectorParam("/hand_description/" + arm_name + "/hand_joints");
+    return get(arm_name, &Arm::hand_joint_names);
   }
   
-  inline std::vector<std::string> gripperTouchLinkNames(std::string arm_name)
+  inline std::vector<std::string> gripperTouchLinkNames(const std::string &arm_name)
   {
-    return getVectorParam("/hand_description/" + arm_name + "/hand_touch_links");
+    return get(arm_name, &Arm::gripper_touch_link_names);
   }
   
-  inline std::vector<std::string> fingertipLinks(std::string arm_name)
+  inline std::vector<std::string> fingertipLinks(const std::string &arm_name)
   {
-    return getVectorParam("/hand_description/" + arm_name + "/hand_fingertip_links");
+    return get(arm_name, &Arm::fingertip_links);
   }
 
-  inline geometry_msgs::Vector3 approachDirection(std::string arm_name)
+  inline geometry_msgs::Vector3 approachDirection(const std::string &arm_name)
   {
-    std::string name = "/hand_description/" + arm_name + "/hand_approach_direction";
-    std::vector<double> values = getVectorDoubleParam(name);
-    if ( values.size() != 3 )  throw BadParamException(name);
-    double length = sqrt( values[0]*values[0] + values[1]*values[1] + values[2]*values[2] );
-    if ( fabs(length) < 1.0e-5 ) throw BadParamException(name);
-    geometry_msgs::Vector3 app;
-    app.x = values[0] / length;
-    app.y = values[1] / length;
-    app.z = values[2] / length;
-    return app;
+    return get(arm_name, &Arm::approach_direction);
   }
 
-  inline std::vector<std::string> armJointNames(std::string arm_name)
+  inline std::vector<std::string> armJointNames(const std::string &arm_name)
   {
-    return getVectorParam("/hand_description/" + arm_name + "/arm_joints");
+    return get(arm_name, &Arm::arm_joint_names);
   }
 
 };
@@ -33,6 +33,11 @@
 #ifndef _MECHANISM_INTERFACE_H_
 #define _MECHANISM_INTERFACE_H_
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/tss.hpp>
+
 #include <ros/ros.h>
 
 #include <actionlib/client/simple_action_client.h>
@@ -45,6 +50,8 @@
 
 #include <geometry_msgs/Vector3.h>
 
+#include <sensor_msgs/JointState.h>
+
 #include <kinematics_msgs/GetKinematicSolverInfo.h>
 #include <kinematics_msgs/GetConstraintAwarePositionIK.h>
 #include <kinematics_msgs/GetPositionFK.h>
@@ -65,6 +72,7 @@
 #include <arm_navigation_msgs/GetRobotState.h>
 
 #include <interpolated_ik_motion_planner/SetInterpolatedIKMotionPlanParams.h>
+#include <interpolated_ik_motion_planner/GetInterpolatedIKMotionPlanBatch.h>
 
 #include <arm_navigation_msgs/AttachedCollisionObject.h>
 
@@ -79,13 +87,40 @@
 
 #include "object_manipulator/tools/exceptions.h"
 #include "object_manipulator/tools/service_action_wrappers.h"
+#include "object_manipulator/tools/server_state_gate.h"
+#include "object_manipulator/tools/reachability_map.h"
 
+namespace planning_environment {
+class CollisionModelsInterface;
+}
 
 namespace object_manipulator {
 
 //! A collection of ROS service and action clients needed for grasp execution
 class MechanismInterface
 {
+ public:
+  //! One request in a batch of interpolated IK computations
+  /*! The fields have the same meaning as the arguments of getInterpolatedIK(...) */
+  struct InterpolatedIKRequest
+  {
+    geometry_msgs::PoseStamped start_pose;
+    geometry_msgs::Vector3Stamped direction;
+    float desired_trajectory_length;
+    std::vector<double> seed_joint_position;
+    sensor_msgs::JointState joint_state;
+    bool reverse_trajectory;
+  };
+
+  //! The result of one interpolated IK computation
+  struct InterpolatedIKResult
+  {
+    //! The error code of the first failed step, or SUCCESS
+    int error_code;
+    trajectory_msgs::JointTrajectory trajectory;
+    float actual_trajectory_length;
+  };
+
  private:
   //! The root namespace node handle
   ros::NodeHandle root_nh_;
@@ -96,12 +131,45 @@ class MechanismInterface
   //! Transform listener 
   tf::TransformListener listener_;
 
+  //! The transforms looked up so far in a transform snapshot, by target and source frame
+  typedef std::map<std::pair<std::string, std::string>, tf::StampedTransform> TransformSnapshotData;
+
+  //! The transform snapshot of each thread, if one is in use
+  boost::thread_specific_ptr<TransformSnapshotData> transform_snapshot_;
+
   //! Publisher for attached objects
   ros::Publisher attached_object_pub_;
 
   //! Name of the topic on which JointState messages come (for the current arm angles)
   std::string joint_states_topic_;
 
+  //! Subscriber for the JointState messages, used as a cache for the current robot state
+  ros::Subscriber joint_states_sub_;
+
+  //! The latest position received for each joint, along with the time stamp of the message it came in
+  /*! Several publishers might each send some of the joints, so the values from all messages are merged. */
+  std::map<std::string, std::pair<double, ros::Time> > joint_positions_;
+
+  //! The joint positions above as a single JointState message, stamped with the oldest of their time stamps
+  /*! Assembled on request and reset when new positions arrive; never modified once assembled. */
+  sensor_msgs::JointState::ConstPtr last_joint_state_;
+
+  //! Joint positions older than this (in seconds) are not used; the robot state is requested instead
+  /*! Negative if the cache is disabled, which is the default. */
+  double joint_state_max_age_;
+
+  //! The number of times the robot state was read from the latest JointState message (hits) or requested (misses)
+  unsigned int joint_state_hits_, joint_state_misses_;
+
+  //! Protects the joint positions, the assembled JointState message and the counters above
+  boost::mutex joint_state_mutex_;
+
+  //! Stores the joint positions from a JointState message
+  void jointStatesCallback(const sensor_msgs::JointState::ConstPtr &joint_state);
+
+  //! Returns the latest joint positions, or an empty pointer if the ones needed are too old or missing
+  sensor_msgs::JointState::ConstPtr getRecentJointState(const std::vector<std::string> &joint_names);
+
   //! Names for the arm controllers (only needed when used)
   //! Values are taken from the params arm_name_joint_controller and arm_name_cartesian_controller (for each arm_name)
   std::map<std::string, std::string> joint_controller_names_; 
@@ -110,29 +178,195 @@ class MechanismInterface
   //! Values are taken from the params arm_name_joint_controller and arm_name_cartesian_controller (for each arm_name)
   std::map<std::string, std::string> cartesian_controller_names_; 
 
-  //! Caches the last requested collision operations
-  arm_navigation_msgs::OrderedCollisionOperations collision_operations_cache_;
+  //! The state of each controller (true if running), as of the last time they were queried
+  std::map<std::string, bool> controller_running_;
+
+  //! When the controller states were last queried; zero if they are not known
+  ros::Time controller_states_stamp_;
+
+  //! Controller states older than this (in seconds) are queried again before being relied on
+  /*! Controllers switched by other nodes in the meantime will go unnoticed for this long. */
+  double controller_state_max_age_;
+
+  //! How long (in seconds) an arm is left in Cartesian control after a Cartesian move, in case another 
+  //! one follows; 0 switches back to joint control right away
+  double cartesian_switch_back_delay_;
 
-  //! Caches the last requested link padding
-  std::vector<arm_navigation_msgs::LinkPadding> link_padding_cache_;
+  //! A pending switch back to joint control
+  struct DeferredSwitch
+  {
+    ros::Timer timer;
+    //! Lets a timer callback that was already running when its switch got cancelled see that it is stale
+    unsigned int generation;
+  };
+
+  //! The pending switches back to joint control, by arm name
+  std::map<std::string, DeferredSwitch> deferred_joint_switches_;
+
+  //! Incremented for each switch that is deferred
+  unsigned int deferred_switch_generation_;
+
+  //! Protects the controller states and the pending switches; also serializes controller switching
+  boost::recursive_mutex controllers_mutex_;
+
+  //! Queries the state of all controllers
+  void updateControllerStates();
+
+  //! Gets the state of a controller, if it is known and recent enough
+  bool knownControllerState(std::string controller, bool &running);
+
+  //! Returns true if the controllers are known to be running and stopped, respectively
+  bool controllersInState(const std::vector<std::string> &running_controllers,
+                          const std::vector<std::string> &stopped_controllers);
+
+  //! Starts and stops the given controllers, unless they are already in that state
+  bool switchControllers(const std::vector<std::string> &start_controllers,
+                         const std::vector<std::string> &stop_controllers);
+
+  //! Schedules a switch back to joint control after cartesian_switch_back_delay_
+  void deferSwitchToJoint(std::string arm_name);
+
+  //! Removes a pending switch back to joint control and hands out its timer; returns false if there was none
+  /*! If generation is not 0, only removes the switch with that generation. Must be called with 
+    controllers_mutex_ locked. The timer must be stopped after unlocking it: stopping a timer waits 
+    for its callback to finish if it is running, and the callback locks the mutex. */
+  bool takeDeferredSwitchToJoint(std::string arm_name, unsigned int generation, ros::Timer &timer);
 
-  //! Keeps track of whether planning scene caching has been called at all
-  bool planning_scene_cache_empty_;
+  //! Cancels a pending switch back to joint control; returns false if there was none
+  /*! If the switch is already being done by the timer callback, waits for it to finish. Must not be 
+    called with controllers_mutex_ locked. */
+  bool cancelDeferredSwitchToJoint(std::string arm_name);
+
+  //! Switches an arm to joint control, trying a few times before giving up
+  bool switchToJointRetrying(std::string arm_name);
+
+  //! Timer callback for a deferred switch back to joint control
+  /*! Does nothing if the switch it was scheduled for has been cancelled or replaced meanwhile. Keeps 
+    controllers_mutex_ locked until the switch is done, so that cancelling or finishing the switch 
+    meanwhile waits for it. */
+  void deferredSwitchToJointCallback(const ros::TimerEvent &, std::string arm_name, unsigned int generation);
+
+  //! The collision operations and link padding sent to the environment server as a planning scene diff
+  struct PlanningSceneState
+  {
+    arm_navigation_msgs::OrderedCollisionOperations collision_operations;
+    std::vector<arm_navigation_msgs::LinkPadding> link_padding;
+    //! Hash of the contents, so that most different scenes can be told apart without comparing them
+    size_t hash;
+  };
+
+  //! The parameters sent to the interpolated IK server of an arm
+  struct InterpolatedIKParams
+  {
+    std::string arm_name;
+    int num_steps;
+    int collision_check_resolution;
+    bool start_from_end;
+  };
+
+  //! Whether interpolated IK requests are sent to the batch service, which takes the server params along 
+  //! with each request; otherwise, the params are set separately before each request
+  bool use_interpolated_ik_batch_;
 
   //! Used to disable planning scene caching altogether
   bool cache_planning_scene_;
 
+  //! Keeps the planning scene fixed while calls that rely on it are in progress
+  /*! Also acts as the planning scene cache: a new diff is only sent when the requested 
+    collision operations or link padding are different from the last ones. */
+  ServerStateGate<PlanningSceneState> planning_scene_gate_;
+
+  //! Keeps the interpolated IK params fixed while calls that rely on them are in progress
+  /*! Always acquire the planning scene first if both are needed. */
+  ServerStateGate<InterpolatedIKParams> interpolated_ik_params_gate_;
+
   //! Sets the parameters for the interpolated IK server
-  void setInterpolatedIKParams(std::string arm_name, int num_steps, 
-			       int collision_check_resolution, bool start_from_end);
+  void setInterpolatedIKParams(const InterpolatedIKParams &params);
+
+  //! Checks if two sets of interpolated IK params are identical
+  static bool compareInterpolatedIKParams(const InterpolatedIKParams &p1, const InterpolatedIKParams &p2);
+
+  //! Local mirror of the planning scene held by the environment server, used for state validity checks
+  /*! Only created if the param local_collision_checking is set. */
+  boost::shared_ptr<planning_environment::CollisionModelsInterface> collision_models_;
+
+  //! The number of planning scenes the local mirror has received from the environment server
+  unsigned int local_scene_updates_;
+
+  //! Whether the local mirror has received the planning scene last sent to the environment server
+  bool local_scene_valid_;
+
+  //! Protects the counter and flag above
+  boost::mutex local_scene_mutex_;
+
+  //! Called by the local mirror when it receives a new planning scene from the environment server
+  void localSceneUpdated();
+
+  //! Checks the validity of arm states against the local mirror of the planning scene
+  /*! Returns false if the mirror is not up to date with the planning scene on the server, in which 
+    case the states have not been checked. The planning scene must be held by the caller. */
+  bool checkStateValidityLocal(std::string arm_name, const std::vector< std::vector<double> > &joint_values,
+                               std::vector<bool> &valid);
+
+  //! Checks the validity of a single arm state using the state validity service
+  /*! The planning scene must be held by the caller. */
+  bool checkStateValidityService(std::string arm_name, const std::vector<double> &joint_values);
+
+  //! Whether trajectories are unnormalized locally rather than by the trajectory normalizer service
+  bool local_unnormalization_;
+
+  //! The continuous joints (the ones without position limits) of each arm, queried on first use
+  std::map<std::string, std::vector<std::string> > continuous_joints_;
+
+  //! Protects the continuous joints
+  boost::mutex continuous_joints_mutex_;
+
+  //! Returns the names of the continuous joints of an arm
+  std::vector<std::string> getContinuousJoints(std::string arm_name);
+
+  //! Unwraps the continuous joints of a trajectory so that it starts from the current robot state
+  /*! Returns false if the current position of one of the continuous joints is not known, in which 
+    case the trajectory has not been unnormalized. */
+  bool unnormalizeTrajectoryLocal(std::string arm_name, const trajectory_msgs::JointTrajectory &input_trajectory,
+                                  trajectory_msgs::JointTrajectory &normalized_trajectory);
+
+  //! Reachability maps by arm name, loaded on first use; empty pointers for arms without a map
+  std::map<std::string, boost::shared_ptr<const ReachabilityMap> > reachability_maps_;
+
+  //! Protects the reachability maps
+  boost::mutex reachability_maps_mutex_;
+
+  //! Assembles the motion plan request sent to the interpolated IK server
+  /*! Also returns the number of steps in the trajectory, and the size of each step. */
+  void interpolatedIKMotionPlanRequest(std::string arm_name, const InterpolatedIKRequest &request,
+                                       arm_navigation_msgs::MotionPlanRequest &motion_plan_request,
+                                       unsigned int &num_steps, float &actual_step_size);
+
+  //! Extracts the valid part of a trajectory received from the interpolated IK server
+  void interpolatedIKResult(const trajectory_msgs::JointTrajectory &planned_trajectory,
+                            const std::vector<arm_navigation_msgs::ArmNavigationErrorCodes> &error_codes,
+                            bool reverse_trajectory, float actual_step_size, InterpolatedIKResult &result);
+
+  //! Sends one interpolated IK request to the regular interpolated IK service
+  void getInterpolatedIKSingle(std::string arm_name, const InterpolatedIKRequest &request,
+                               const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+                               const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+                               InterpolatedIKResult &result);
 
   //! Calls the switch_controllers service
   bool callSwitchControllers(std::vector<std::string> start_controllers, std::vector<std::string> stop_controllers);
   
-  //! Checks if the planning scene is the same as the last one requested, to avoid unnecessary calls
-  /*! Returns true if the collision operations and link paddings are identical to the last ones requested. */
-  bool cachePlanningScene(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
-                          const std::vector<arm_navigation_msgs::LinkPadding> &link_padding);
+  //! Sends the planning scene diff to the environment server
+  void setPlanningScene(const PlanningSceneState &state);
+
+  //! Checks if two planning scenes are identical, to avoid unnecessary calls
+  /*! Returns true if the collision operations and link paddings are identical, and caching is enabled. 
+    Scenes with different hashes are rejected without comparing their contents. */
+  bool comparePlanningScenes(const PlanningSceneState &s1, const PlanningSceneState &s2);
+
+  //! Convenience function for assembling a planning scene state
+  static PlanningSceneState planningSceneState(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
+                                               const std::vector<arm_navigation_msgs::LinkPadding> &link_padding);
 
  public:
 
@@ -154,6 +388,10 @@ class MechanismInterface
   MultiArmServiceWrapper<interpolated_ik_motion_planner::SetInterpolatedIKMotionPlanParams> 
     interpolated_ik_set_params_client_;
 
+  //! Client for the Interpolated IK batch service
+  MultiArmServiceWrapper<interpolated_ik_motion_planner::GetInterpolatedIKMotionPlanBatch> 
+    interpolated_ik_batch_service_client_;
+
   //! Client for service that queries if a graps is currently active
   MultiArmServiceWrapper<object_manipulation_msgs::GraspStatus> grasp_status_client_;
 
@@ -212,16 +450,51 @@ class MechanismInterface
 
   //------------------------------ Functionality -------------------------------
 
+  //! While in scope, transformPose(...) uses the same transforms every time on the current thread
+  /*! Each transform is looked up in tf the first time it is needed and then reused until the snapshot
+    goes out of scope, which saves the tf lookups and gives consistent results when many poses are 
+    transformed (e.g. while evaluating a list of grasps). Only use it around code that does not move 
+    the robot, as transforms that change in the meantime are not updated. Nested snapshots reuse the 
+    outermost one. The current pose of the gripper is never taken from the snapshot. */
+  class ScopedTransformSnapshot
+  {
+  private:
+    MechanismInterface &interface_;
+    bool owner_;
+  public:
+    ScopedTransformSnapshot(MechanismInterface &interface) : interface_(interface), owner_(false)
+    {
+      if (!interface_.transform_snapshot_.get())
+      {
+        interface_.transform_snapshot_.reset(new TransformSnapshotData());
+        owner_ = true;
+      }
+    }
+    ~ScopedTransformSnapshot()
+    {
+      if (owner_) interface_.transform_snapshot_.reset();
+    }
+  };
+
   //! Initializes all clients, then calls getIKInformation() and sets default interpolated IK params
   MechanismInterface();
 
   //------------- IK -------------
 
   //! Gets the current robot state
+  /*! Only the joint state is filled in if the latest joint positions are recent enough; otherwise, 
+    the full robot state is requested from the environment server. */
   void getRobotState(arm_navigation_msgs::RobotState& state);
 
+  //! Gets the current robot state, for a caller that only needs the given joints
+  /*! As above, but only the positions of \a joint_names need to be recent enough to be used. */
+  void getRobotState(arm_navigation_msgs::RobotState& state, const std::vector<std::string> &joint_names);
+
   //! Sends the requsted collision operations and link padding to the environment server as a diff
   //! from the current planning scene on the server
+  /*! Note that when using the mechanism interface from multiple threads, another thread might
+    change the planning scene as soon as this returns. The functions below that rely on the 
+    planning scene (IK, interpolated IK, state validity) hold it fixed until they are done. */
   void getPlanningScene(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
                         const std::vector<arm_navigation_msgs::LinkPadding> &link_padding);
 
@@ -230,6 +503,14 @@ class MechanismInterface
                           const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
                           const std::vector<arm_navigation_msgs::LinkPadding> &link_padding);
 
+  //! Checks if several arm states are valid, all with the same collision operations and link padding
+  /*! Returns one result for each state, in the same order. With local collision checking, all the 
+    states are checked against the local mirror of the planning scene without any service calls. */
+  void checkStateValidityBatch(std::string arm_name, const std::vector< std::vector<double> > &joint_values,
+                               const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+                               const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+                               std::vector<bool> &valid);
+
   //! Checks if a given arm state is valid with no collision operations or link paddings
   bool checkStateValidity(std::string arm_name, const std::vector<double> &joint_values)
   {
@@ -263,6 +544,14 @@ class MechanismInterface
 			trajectory_msgs::JointTrajectory &trajectory,
 			float &actual_trajectory_length);
 
+  //! Computes several interpolated IK paths in a single exchange with the server
+  /*! All the paths are computed using the same collision operations and link padding. Returns one 
+    result for each request, in the same order. */
+  void getInterpolatedIKBatch(std::string arm_name, const std::vector<InterpolatedIKRequest> &requests,
+                              const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+                              const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+                              std::vector<InterpolatedIKResult> &results);
+
   //------ traj controller  ------
 
   //! Uses the joint trajectory action to execute the desired trajectory
@@ -279,6 +568,8 @@ class MechanismInterface
 			 float time_per_segment);
 
   //! Normalizes a trajectory (joint angle wrap-around)
+  /*! Done locally if the param local_unnormalization is set (off by default), with the trajectory 
+    normalizer service as a fallback; otherwise, always done by the service. */
   void unnormalizeTrajectory(std::string arm_name, const trajectory_msgs::JointTrajectory &input_trajectory,
 			   trajectory_msgs::JointTrajectory &normalized_trajectory);
 
@@ -325,6 +616,11 @@ class MechanismInterface
   //! Gets the current pose of the gripper in the frame_id specified in the gripper_pose.header
   geometry_msgs::PoseStamped getGripperPose(std::string arm_name, std::string frame_id);
 
+  //! Gets the first gripper pose received by tf after a given time, waiting at most max_wait for it
+  /*! Returns false if no new pose arrived in time; the latest known pose is returned anyway. */
+  bool getNewGripperPose(std::string arm_name, std::string frame_id, const ros::Time &after, 
+                         ros::Duration max_wait, geometry_msgs::PoseStamped &gripper_pose);
+
   //! Computes the gripper pose transformed by a certain translation
   geometry_msgs::PoseStamped translateGripperPose(geometry_msgs::Vector3Stamped translation,
 						  geometry_msgs::PoseStamped start_pose,
@@ -334,6 +630,26 @@ class MechanismInterface
   geometry_msgs::PoseStamped transformPose(const std::string target_frame, 
 					   const geometry_msgs::PoseStamped &stamped_in);
 
+  //! Logs the call counts and latency histograms of the services called most often
+  /*! Only calls made since startup are included. Also logs the planning scene and robot state cache statistics. */
+  void logServiceCallStatistics();
+
+  //! The number of times the planning scene needed by a call was already set (hits), or had to be sent (misses)
+  void getPlanningSceneCacheStatistics(unsigned int &hits, unsigned int &misses)
+  {
+    planning_scene_gate_.getStatistics(hits, misses);
+  }
+
+  //! Returns the reachability map for an arm, or an empty pointer if none is available
+  /*! The map is loaded on first use from the file given by the private param 
+    reachability_map/<arm_name>. */
+  boost::shared_ptr<const ReachabilityMap> getReachabilityMap(std::string arm_name);
+
+  //! Looks up the reachability and manipulability of a gripper pose in the reachability map of an arm
+  /*! Returns false if no map is available for the arm. Poses outside the map get 0 for both. */
+  bool getReachability(std::string arm_name, const geometry_msgs::PoseStamped &gripper_pose,
+                       double &reachability, double &manipulability);
+
   //! Transforms a cloud from one frame to another; just passes through to the tf::Listener
   void transformPointCloud(std::string target_frame, 
 			   const sensor_msgs::PointCloud &cloud_in,
@@ -397,6 +713,12 @@ class MechanismInterface
   //! Switch one arm from Cartesian to joint control
   bool switchToJoint(std::string arm_name);
 
+  //! If a switch back to joint control is pending for an arm, does it right away
+  /*! Must be called before using the joint controllers of an arm through any other channel than the 
+    functions in this class. If the switch is already in progress, waits for it to finish. Must not 
+    be called with controllers_mutex_ locked. */
+  bool finishDeferredSwitchToJoint(std::string arm_name);
+
   //! Get the name of the Cartesian controller for arm_name, returns an empty string if not found
   std::string cartesianControllerName(std::string arm_name);
 
@@ -421,6 +743,7 @@ class MechanismInterface
 
   //! Ask the wrist to go incrementally towards a PoseStamped using the Cartesian controller until it gets there
   // (to within tolerances) or times out (returns 0 for error, 1 for got there, -1 for timed out)
+  // A new command is sent as soon as tf has a new gripper pose, or after timestep if it does not get one
   int moveArmToPoseCartesian(std::string arm_name, const geometry_msgs::PoseStamped &desired_pose,
 			      ros::Duration timeout, double dist_tol = .015, double angle_tol = .09,
                              double clip_dist = .02, double clip_angle = .16, double timestep = 0.1,
@@ -449,6 +772,19 @@ class MechanismInterface
                                              const std::vector<double> &goal_posture_suggestion,
                                              std::vector<double> &clipped_posture_goal);
 
+  //! Clip a desired pose to be no more than clip_dist/clip_angle away from a given gripper pose
+  geometry_msgs::PoseStamped clipDesiredPose(const geometry_msgs::PoseStamped &current_pose,
+                                             const geometry_msgs::PoseStamped &desired_pose, 
+                                             double clip_dist, double clip_angle, double &resulting_clip_fraction);
+
+  //! Clip a desired pose to be no more than clip_dist/clip_angle away from a given gripper pose
+  // and clip an optional goal posture suggestion (arm angles) by the same amount
+  geometry_msgs::PoseStamped clipDesiredPose(std::string arm_name, const geometry_msgs::PoseStamped &current_pose,
+                                             const geometry_msgs::PoseStamped &desired_pose, 
+                                             double clip_dist, double clip_angle, double &resulting_clip_fraction,
+                                             const std::vector<double> &goal_posture_suggestion,
+                                             std::vector<double> &clipped_posture_goal);
+
   //! Returns the joint names for the arm we are using
   std::vector<std::string> getJointNames(std::string arm_name);
 
@@ -486,7 +822,8 @@ class MechanismInterface
 /*! Due to problems with waitForServer, it is not recommended to use multiple instances
   of the MechanismInterface in the same node. This function provides a singleton.
 
-  CAREFUL WITH MULTI-THREADED CODE!!!
+  CAREFUL WITH MULTI-THREADED CODE!!! The service clients and the IK and state validity checks
+  can be used from multiple threads; executing arm or gripper motions can not.
 */
 inline MechanismInterface& mechInterface()
 {
@@ -0,0 +1,92 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef _PARAM_HELPERS_H_
+#define _PARAM_HELPERS_H_
+
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include "object_manipulator/tools/exceptions.h"
+
+namespace object_manipulator {
+
+//! Reads a string from the parameter server
+/*! Throws MissingParamException if the parameter is not set. */
+inline std::string getStringParam(const ros::NodeHandle &nh, const std::string &name)
+{
+  std::string value;
+  if (!nh.getParam(name, value)) throw MissingParamException(name);
+  return value;
+}
+
+//! Reads a list of strings from the parameter server
+/*! Throws MissingParamException if the parameter is not set, and BadParamException if it is not a 
+  list of strings. */
+inline std::vector<std::string> getVectorStringParam(const ros::NodeHandle &nh, const std::string &name)
+{
+  XmlRpc::XmlRpcValue list;
+  if (!nh.getParam(name, list)) throw MissingParamException(name);
+  if (list.getType() != XmlRpc::XmlRpcValue::TypeArray) throw BadParamException(name);
+  std::vector<std::string> values;
+  for (int32_t i=0; i<list.size(); i++)
+  {
+    if (list[i].getType() != XmlRpc::XmlRpcValue::TypeString) throw BadParamException(name);
+    values.push_back( static_cast<std::string>(list[i]) );
+  }
+  return values;
+}
+
+//! Reads a list of numbers from the parameter server
+/*! Integers are accepted as well. Throws MissingParamException if the parameter is not set, and 
+  BadParamException if it is not a list of numbers. */
+inline std::vector<double> getVectorDoubleParam(const ros::NodeHandle &nh, const std::string &name)
+{
+  XmlRpc::XmlRpcValue list;
+  if (!nh.getParam(name, list)) throw MissingParamException(name);
+  if (list.getType() != XmlRpc::XmlRpcValue::TypeArray) throw BadParamException(name);
+  std::vector<double> values;
+  for (int32_t i=0; i<list.size(); i++)
+  {
+    if (list[i].getType() == XmlRpc::XmlRpcValue::TypeDouble) values.push_back( static_cast<double>(list[i]) );
+    else if (list[i].getType() == XmlRpc::XmlRpcValue::TypeInt) values.push_back( static_cast<int>(list[i]) );
+    else throw BadParamException(name);
+  }
+  return values;
+}
+
+} //namespace object_manipulator
+
+#endif
@@ -0,0 +1,114 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#ifndef _REACHABILITY_MAP_H_
+#define _REACHABILITY_MAP_H_
+
+#include <string>
+#include <vector>
+
+#include <tf/transform_datatypes.h>
+
+namespace object_manipulator {
+
+//! A voxelized map of how well an arm can reach positions of the gripper frame
+/*! Each voxel holds two values, both in [0,1]:
+  - reachability: the fraction of the sampled gripper orientations at the voxel center for which
+  an IK solution was found
+  - manipulability: the manipulability measure of the arm at the best solution found, relative to
+  the largest one found in the whole map
+
+  Positions are expressed in the frame given by frameId(), generally the robot frame of the arm.
+  Positions outside the map are considered unreachable, so the map must cover the whole workspace
+  of the arm. Lookups are O(1).
+
+  Maps are generated offline by the build_reachability_map node and stored in a compact binary 
+  file: a short header followed by one byte per voxel for each of the two values.
+*/
+class ReachabilityMap
+{
+ private:
+  //! The frame the map is expressed in
+  std::string frame_id_;
+
+  //! The lower corner of the map
+  tf::Vector3 origin_;
+
+  //! The size of a voxel
+  double resolution_;
+
+  //! The number of voxels along each axis
+  unsigned int size_x_, size_y_, size_z_;
+
+  //! Reachability values, quantized to a byte
+  std::vector<unsigned char> reachability_;
+
+  //! Manipulability values, quantized to a byte
+  std::vector<unsigned char> manipulability_;
+
+  //! Returns the index of the voxel a point falls in, or -1 if it is outside the map
+  long int voxelIndex(const tf::Vector3 &point) const;
+
+ public:
+  //! Creates an empty map, to be loaded from a file
+  ReachabilityMap() : resolution_(0.0), size_x_(0), size_y_(0), size_z_(0) {}
+
+  //! Creates a map covering the box between two corners, with all voxels unreachable
+  ReachabilityMap(std::string frame_id, const tf::Vector3 &min_corner, const tf::Vector3 &max_corner,
+                  double resolution);
+
+  //! Loads a map from a file; returns false on failure
+  bool load(std::string filename);
+
+  //! Saves the map to a file; returns false on failure
+  bool save(std::string filename) const;
+
+  //! The frame the map is expressed in
+  const std::string& frameId() const {return frame_id_;}
+
+  //! The total number of voxels
+  size_t numVoxels() const {return reachability_.size();}
+
+  //! The center of a voxel, given its index
+  tf::Vector3 voxelCenter(size_t index) const;
+
+  //! Sets the values of a voxel, given its index; values are clamped to [0,1]
+  void setVoxel(size_t index, double reachability, double manipulability);
+
+  //! Looks up the values for a position; returns false if the position is outside the map
+  bool lookup(const tf::Vector3 &point, double &reachability, double &manipulability) const;
+};
+
+} //namespace object_manipulator
+
+#endif
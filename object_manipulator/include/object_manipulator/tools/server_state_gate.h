@@ -0,0 +1,208 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#ifndef _SERVER_STATE_GATE_H_
+#define _SERVER_STATE_GATE_H_
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace object_manipulator {
+
+//! Serializes changes to a piece of state that is held by a server and shared by all its clients
+/*! Some of the servers we use keep state between calls (e.g. the planning scene of the environment
+  server, or the parameters of the interpolated IK server) and later calls implicitly use it. When
+  several threads use such a server at the same time, one of them could change the state while 
+  another one is in the middle of a call that relies on it.
+
+  The gate allows any number of holders as long as they all need the same state. A caller that needs
+  a different state waits until all current holders are done, then applies its own state using the
+  apply function passed in at construction. Callers that need the current state but arrive while
+  someone else is waiting for a change also wait, so that a change can not be postponed forever.
+
+  The compare function decides if two states are the same; it can always return false to force the
+  state to be applied on every acquisition. If applying the state throws, the state held by the
+  server is considered unknown and the exception is passed on to the caller.
+
+  Callers that change the state through some other channel (e.g. an action that sends its own 
+  state to the server as part of its goal) must use acquireExclusive() instead.
+*/
+template <class State>
+class ServerStateGate
+{
+ public:
+  typedef boost::function<bool(const State&, const State&)> CompareFunction;
+  typedef boost::function<void(const State&)> ApplyFunction;
+
+  //! Holds the gate with a given state for as long as it is in scope
+  class ScopedHolder
+  {
+  private:
+    ServerStateGate<State> &gate_;
+  public:
+    ScopedHolder(ServerStateGate<State> &gate, const State &state) : gate_(gate) {gate_.acquire(state);}
+    ~ScopedHolder() {gate_.release();}
+  };
+
+  //! Holds the gate exclusively for as long as it is in scope
+  class ScopedExclusiveHolder
+  {
+  private:
+    ServerStateGate<State> &gate_;
+  public:
+    ScopedExclusiveHolder(ServerStateGate<State> &gate) : gate_(gate) {gate_.acquireExclusive();}
+    ~ScopedExclusiveHolder() {gate_.release();}
+  };
+
+ private:
+  //! Used to check if a requested state is the one currently held by the server
+  CompareFunction compare_function_;
+  
+  //! Used to send a new state to the server
+  ApplyFunction apply_function_;
+
+  //! The state the server currently holds, if known
+  State state_;
+
+  //! False until a state has been successfully applied, or after applying a state has failed
+  bool state_known_;
+
+  //! The number of callers currently relying on state_
+  unsigned int holders_;
+
+  //! The number of callers waiting to be let in
+  unsigned int waiting_;
+
+  //! Incremented each time the gate is opened by a caller that found no holders
+  /*! Waiting callers that need the state chosen at that point are let in together. */
+  unsigned int phase_;
+
+  //! The number of acquisitions that found the requested state already applied
+  unsigned int hits_;
+
+  //! The number of acquisitions that had to apply the requested state
+  unsigned int misses_;
+
+  boost::mutex mutex_;
+  boost::condition_variable condition_;
+
+  //! Must be called with the mutex locked
+  bool matches(const State &state)
+  {
+    return state_known_ && compare_function_(state, state_);
+  }
+
+ public:
+  ServerStateGate(CompareFunction compare_function, ApplyFunction apply_function) :
+    compare_function_(compare_function), apply_function_(apply_function),
+    state_known_(false), holders_(0), waiting_(0), phase_(0), hits_(0), misses_(0)
+  {}
+
+  //! Waits until the server holds the requested state and registers the caller as a holder
+  /*! Every successful call must be matched by a call to release(). */
+  void acquire(const State &state)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (waiting_ == 0 && matches(state))
+    {
+      hits_++;
+      holders_++;
+      return;
+    }
+    waiting_++;
+    unsigned int phase = phase_;
+    while ( holders_ > 0 && !(phase_ != phase && matches(state)) ) condition_.wait(lock);
+    waiting_--;
+    if (holders_ == 0)
+    {
+      //start a new phase, with the state this caller needs
+      phase_++;
+      if (!matches(state))
+      {
+        misses_++;
+        try
+        {
+          apply_function_(state);
+        }
+        catch (...)
+        {
+          state_known_ = false;
+          condition_.notify_all();
+          throw;
+        }
+        state_ = state;
+        state_known_ = true;
+      }
+      else hits_++;
+      condition_.notify_all();
+    }
+    else hits_++;
+    holders_++;
+  }
+
+  //! Waits until there are no other holders, then keeps everyone else out until released
+  /*! Also forgets the current state, as the caller is expected to change it in ways the gate does
+    not know about. Must be matched by a call to release(). */
+  void acquireExclusive()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    waiting_++;
+    while (holders_ > 0) condition_.wait(lock);
+    waiting_--;
+    phase_++;
+    //nobody's state can match an unknown one, so others will wait for us to release
+    state_known_ = false;
+    holders_++;
+  }
+
+  //! The number of acquisitions that found the requested state already applied (hits), or had to apply it (misses)
+  /*! Exclusive acquisitions are not counted. */
+  void getStatistics(unsigned int &hits, unsigned int &misses)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    hits = hits_;
+    misses = misses_;
+  }
+
+  //! Unregisters a holder; the state may be changed once the last holder is gone
+  void release()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (holders_ > 0) holders_--;
+    if (holders_ == 0) condition_.notify_all();
+  }
+};
+
+} //namespace object_manipulator
+
+#endif
@@ -36,44 +36,183 @@
 #include <ros/ros.h>
 #include <actionlib/client/simple_action_client.h>
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
 #include <string>
+#include <sstream>
 #include <map>
+#include <set>
 
 #include "object_manipulator/tools/exceptions.h"
 
 namespace object_manipulator {
 
+//! Histogram of the latencies of the calls made to a service
+class ServiceCallStatistics
+{
+ public:
+  //! The number of bins in the histogram
+  static const size_t NUM_BINS = 8;
+
+  //! The upper bounds of the bins, in milliseconds; the last bin has no upper bound
+  static double binLimit(size_t bin)
+  {
+    static const double limits[NUM_BINS-1] = {1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0};
+    return limits[bin];
+  }
+
+  //! The number of calls in each bin
+  unsigned int bins[NUM_BINS];
+  //! The total number of calls
+  unsigned int calls;
+  //! The number of calls that failed
+  unsigned int failures;
+  //! The number of times the connection had to be re-established
+  unsigned int reconnections;
+  //! The total time spent in calls, in seconds
+  double total_time;
+
+  ServiceCallStatistics() : calls(0), failures(0), reconnections(0), total_time(0.0)
+  {
+    for (size_t i=0; i<NUM_BINS; i++) bins[i] = 0;
+  }
+
+  //! Adds a call to the histogram
+  void addCall(double seconds, bool success)
+  {
+    size_t bin = 0;
+    while (bin < NUM_BINS-1 && seconds * 1.0e3 > binLimit(bin)) bin++;
+    bins[bin]++;
+    calls++;
+    if (!success) failures++;
+    total_time += seconds;
+  }
+
+  //! A one-line summary, for printing
+  std::string toString() const
+  {
+    std::ostringstream str;
+    str << calls << " calls, " << failures << " failed, " << reconnections << " reconnections";
+    if (calls) str << ", mean " << 1.0e3 * total_time / calls << " ms";
+    str << "; latency histogram (ms):";
+    for (size_t i=0; i<NUM_BINS; i++)
+    {
+      if (i < NUM_BINS-1) str << " <" << binLimit(i) << ":" << bins[i];
+      else str << " >" << binLimit(i-1) << ":" << bins[i];
+    }
+    return str.str();
+  }
+};
+
 //! Wrapper class for service clients to perform initialization on first use
 /*! When the client is first used, it will check for the existence of the service
   and wait until the service becomes available.
+
+  Can be used from multiple threads; each thread gets its own client, so that calls
+  from different threads are independent of each other.
+
+  Calls made through call() are timed and added to a latency histogram. If the wrapper is set to
+  use persistent connections, a dropped connection is re-established and, if the call failed 
+  because of it, the call is tried again once. Calls made directly on the client returned by 
+  client() bypass both.
  */
 template <class ServiceDataType>
 class ServiceWrapper
 {
  private:
-  //! Has the service client been initialized or not
+  //! Has the service been found or not
   bool initialized_;
   //! The name of the service
   std::string service_name_;
   //! The node handle to be used when initializing services
   ros::NodeHandle nh_;
-  //! The actual client handle
-  ros::ServiceClient client_;
+
+  typedef std::map<boost::thread::id, ros::ServiceClient> map_type;
+
+  //! The actual client handles, one for each thread that has used the service
+  map_type clients_;
   //! Function used to check for interrupts
   boost::function<bool()> interrupt_function_;
+  //! Protects the initialization and the list of clients
+  boost::mutex mutex_;
+  //! Whether clients keep their connection open between calls
+  bool persistent_;
+  //! Latencies of the calls made through call()
+  ServiceCallStatistics statistics_;
+  //! Protects the statistics
+  boost::mutex statistics_mutex_;
  public:
  ServiceWrapper(std::string service_name) : initialized_(false), 
     service_name_(service_name),
-    nh_("")
+    nh_(""),
+    persistent_(false)
     {}
   
   //! Sets the interrupt function
   void setInterruptFunction(boost::function<bool()> f){interrupt_function_ = f;}
 
+  //! Sets whether clients keep their connection open between calls; must be called before first use
+  void setPersistent(bool persistent) {persistent_ = persistent;}
+
+  //! Returns a copy of the call statistics
+  ServiceCallStatistics statistics()
+  {
+    boost::mutex::scoped_lock lock(statistics_mutex_);
+    return statistics_;
+  }
+
+  //! Calls the service, reconnecting if needed; on first use, initializes (and waits for) the client
+  bool call(typename ServiceDataType::Request &request, typename ServiceDataType::Response &response)
+  {
+    ros::ServiceClient &service_client = client();
+    ros::WallTime start_time = ros::WallTime::now();
+    bool reconnected = false;
+    if (persistent_ && !service_client.isValid())
+    {
+      reconnect(service_client);
+      reconnected = true;
+    }
+    bool success = service_client.call(request, response);
+    if (!success && persistent_ && !reconnected && !service_client.isValid())
+    {
+      //the connection was dropped, e.g. because the server was restarted since it was opened;
+      //a call that failed on a live connection was refused by the server, and is not repeated
+      reconnect(service_client);
+      reconnected = true;
+      success = service_client.call(request, response);
+    }
+    boost::mutex::scoped_lock lock(statistics_mutex_);
+    statistics_.addCall( (ros::WallTime::now() - start_time).toSec(), success );
+    if (reconnected) statistics_.reconnections++;
+    return success;
+  }
+
+  //! Convenience version of call() for service data
+  bool call(ServiceDataType &service_data) {return call(service_data.request, service_data.response);}
+
+ private:
+  //! Replaces a client of this thread with a new one
+  void reconnect(ros::ServiceClient &service_client)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    ROS_DEBUG_STREAM("Reconnecting to service " << service_name_);
+    service_client = nh_.serviceClient<ServiceDataType>(service_name_, persistent_);
+  }
+
+ public:
+
   //! Returns reference to client. On first use, initializes (and waits for) client. 
+  /*! The mutex is not held while waiting for the service, so that threads that already have
+    a client are not blocked by a thread that is still waiting. */
   ros::ServiceClient& client(ros::Duration timeout = ros::Duration(5.0)) 
   {
-    if (!initialized_)
+    bool initialized;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      initialized = initialized_;
+    }
+    if (!initialized)
     {
       ros::Duration ping_time = ros::Duration(1.0);
       if (timeout >= ros::Duration(0) && ping_time > timeout) ping_time = timeout;
@@ -88,10 +227,17 @@ class ServiceWrapper
 	if (timeout >= ros::Duration(0) && current_time - start_time >= timeout) 
 	  throw ServiceNotFoundException(service_name_);
       }
-      client_ = nh_.serviceClient<ServiceDataType>(service_name_);	
-      initialized_ = true;
     }
-    return client_;
+    boost::mutex::scoped_lock lock(mutex_);
+    initialized_ = true;
+    typename map_type::iterator it = clients_.find(boost::this_thread::get_id());
+    if (it == clients_.end())
+    {
+      it = clients_.insert(std::pair<boost::thread::id, ros::ServiceClient>
+                           (boost::this_thread::get_id(), 
+                            nh_.serviceClient<ServiceDataType>(service_name_, persistent_))).first;
+    }
+    return it->second;
   }
 };
 
@@ -104,6 +250,11 @@ class ServiceWrapper
   name is first requested, it will wait for the service, then create the client and return it. 
   It will also remember the client, so that on subsequent calls the client is returned directly
   without additional waiting.
+
+  Can be used from multiple threads; each thread gets its own client for each arm.
+
+  As for ServiceWrapper, calls made through call() are timed, and can use persistent connections
+  that are re-established if dropped. Statistics are kept separately for each service.
  */
 template <class ServiceDataType>
 class MultiArmServiceWrapper
@@ -116,10 +267,12 @@ class MultiArmServiceWrapper
   //! Suffix attached to arm name to get service name
   std::string suffix_;
  
-  typedef std::map<std::string, ros::ServiceClient> map_type; 
+  typedef std::map<std::pair<std::string, boost::thread::id>, ros::ServiceClient> map_type; 
 
-  //! The list of clients already created, mapped to service names
+  //! The list of clients already created, mapped to service names and the threads using them
   map_type clients_;
+  //! The names of the services that have already been found
+  std::set<std::string> available_services_;
   //! Whether the resulting name should first be resolved using the node handle
   /*! Use this if you are remapping service names. */
   bool resolve_names_;
@@ -127,15 +280,88 @@ class MultiArmServiceWrapper
   //! Function used to check for interrupts
   boost::function<bool()> interrupt_function_;
 
+  //! Protects the list of clients
+  boost::mutex mutex_;
+
+  //! Whether clients keep their connection open between calls
+  bool persistent_;
+
+  //! Latencies of the calls made through call(), mapped to service names
+  std::map<std::string, ServiceCallStatistics> statistics_;
+
+  //! Protects the statistics
+  boost::mutex statistics_mutex_;
+
+  //! Computes the name of the service used for an arm
+  std::string serviceName(std::string client_name)
+  {
+    if (resolve_names_) return nh_.resolveName(client_name);
+    return client_name;
+  }
+
+  //! Replaces a client of this thread with a new one
+  void reconnect(std::string arm_name, ros::ServiceClient &service_client)
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    std::string service_name = serviceName(prefix_ + arm_name + suffix_);
+    ROS_DEBUG_STREAM("Reconnecting to service " << service_name);
+    service_client = nh_.serviceClient<ServiceDataType>(service_name, persistent_);
+  }
+
  public:
   //! Sets the node handle, prefix and suffix
  MultiArmServiceWrapper(std::string prefix, std::string suffix, bool resolve_names) : 
-  nh_(""), prefix_(prefix), suffix_(suffix), resolve_names_(resolve_names)
+  nh_(""), prefix_(prefix), suffix_(suffix), resolve_names_(resolve_names), persistent_(false)
   {}
 
   //! Sets the interrupt function
   void setInterruptFunction(boost::function<bool()> f){interrupt_function_ = f;}
 
+  //! Sets whether clients keep their connection open between calls; must be called before first use
+  void setPersistent(bool persistent) {persistent_ = persistent;}
+
+  //! Returns a copy of the call statistics, mapped to the names of the services used so far
+  std::map<std::string, ServiceCallStatistics> statistics()
+  {
+    boost::mutex::scoped_lock lock(statistics_mutex_);
+    return statistics_;
+  }
+
+  //! Calls the service for the requested arm, reconnecting if needed
+  /*! On first use for a given arm, initializes (and waits for) the client, as client() does. */
+  bool call(std::string arm_name, 
+            typename ServiceDataType::Request &request, typename ServiceDataType::Response &response)
+  {
+    ros::ServiceClient &service_client = client(arm_name);
+    ros::WallTime start_time = ros::WallTime::now();
+    bool reconnected = false;
+    if (persistent_ && !service_client.isValid())
+    {
+      reconnect(arm_name, service_client);
+      reconnected = true;
+    }
+    bool success = service_client.call(request, response);
+    if (!success && persistent_ && !reconnected && !service_client.isValid())
+    {
+      //the connection was dropped, e.g. because the server was restarted since it was opened;
+      //a call that failed on a live connection was refused by the server, and is not repeated
+      reconnect(arm_name, service_client);
+      reconnected = true;
+      success = service_client.call(request, response);
+    }
+    boost::mutex::scoped_lock lock(statistics_mutex_);
+    ServiceCallStatistics &statistics = statistics_[prefix_ + arm_name + suffix_];
+    statistics.addCall( (ros::WallTime::now() - start_time).toSec(), success );
+    if (reconnected) statistics.reconnections++;
+    return success;
+  }
+
+  //! Convenience version of call() for service data
+  bool call(std::string arm_name, ServiceDataType &service_data) 
+  {
+    return call(arm_name, service_data.request, service_data.response);
+  }
+
   //! Returns a service client for the requested arm
   /*! Service name is obtained as prefix + arm_name + suffix.
     On first request for a given arm, a service client will be initialized, and the service will
@@ -145,36 +371,47 @@ class MultiArmServiceWrapper
     {
       //compute the name of the service
       std::string client_name = prefix_ + arm_name + suffix_;
+      std::pair<std::string, boost::thread::id> key(client_name, boost::this_thread::get_id());
 
-      //check if the service is already there
-      map_type::iterator it = clients_.find(client_name);
-      if ( it != clients_.end() ) 
+      bool available;
       {
-	return it->second;
+        boost::mutex::scoped_lock lock(mutex_);
+        //check if the service is already there
+        typename map_type::iterator it = clients_.find(key);
+        if ( it != clients_.end() ) 
+        {
+          return it->second;
+        }
+        available = available_services_.count(client_name);
       }
 
-      std::string service_name = client_name;
-      if (resolve_names_) service_name = nh_.resolveName(client_name);
+      std::string service_name = serviceName(client_name);
 
-      //new service; wait for it
-      ros::Duration ping_time = ros::Duration(1.0);
-      if (timeout >= ros::Duration(0) && ping_time > timeout) ping_time = timeout;
-      ros::Time start_time = ros::Time::now();
-      while(1)
+      //new service; wait for it, unless another thread has already done so
+      //the mutex is not held while waiting, so that other threads and arms are not blocked
+      if (!available)
       {
-	if (ros::service::waitForService(service_name, ping_time)) break;
-        if (interrupt_function_ && interrupt_function_()) throw InterruptRequestedException();
-	if (!ros::ok()) throw ServiceNotFoundException(client_name + " remapped to " + service_name);
-	ros::Time current_time = ros::Time::now();
-	if (timeout >= ros::Duration(0) && current_time - start_time >= timeout) 
-	  throw ServiceNotFoundException(client_name + " remapped to " + service_name);
-	ROS_INFO_STREAM("Waiting for service " << client_name << " remapped to " << service_name);
+        ros::Duration ping_time = ros::Duration(1.0);
+        if (timeout >= ros::Duration(0) && ping_time > timeout) ping_time = timeout;
+        ros::Time start_time = ros::Time::now();
+        while(1)
+        {
+          if (ros::service::waitForService(service_name, ping_time)) break;
+          if (interrupt_function_ && interrupt_function_()) throw InterruptRequestedException();
+          if (!ros::ok()) throw ServiceNotFoundException(client_name + " remapped to " + service_name);
+          ros::Time current_time = ros::Time::now();
+          if (timeout >= ros::Duration(0) && current_time - start_time >= timeout) 
+            throw ServiceNotFoundException(client_name + " remapped to " + service_name);
+          ROS_INFO_STREAM("Waiting for service " << client_name << " remapped to " << service_name);
+        }
       }
 
-      //insert new service in list
-      std::pair<map_type::iterator, bool> new_pair;
-      new_pair = clients_.insert(std::pair<std::string, ros::ServiceClient>
-				 (client_name, nh_.serviceClient<ServiceDataType>(service_name) ) );
+      //insert new service in list; the key is only used by this thread, so it can not have been added meanwhile
+      boost::mutex::scoped_lock lock(mutex_);
+      available_services_.insert(client_name);
+      std::pair<typename map_type::iterator, bool> new_pair;
+      new_pair = clients_.insert(std::pair<std::pair<std::string, boost::thread::id>, ros::ServiceClient>
+				 (key, nh_.serviceClient<ServiceDataType>(service_name, persistent_) ) );
 
       //and return it
       return new_pair.first->second;
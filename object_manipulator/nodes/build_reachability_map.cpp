@@ -0,0 +1,273 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+//! Builds the reachability map of an arm, to be used by the object manipulator
+/*! For the center of each voxel in a box around the robot, tries to find IK solutions for a set 
+  of gripper orientations, and records the fraction that succeeded along with the best 
+  manipulability found. IK is called without any collision operations, so this should be run 
+  with an empty environment. Manipulability is computed from the arm Jacobian of the robot model
+  in robot_description, without any FK calls. Takes a long time; the result only depends on the 
+  robot model, so it only needs to be done once per arm.
+
+  Private params:
+  - arm_name: the arm to build the map for
+  - output_file: where to save the map
+  - min_corner, max_corner: the box covered by the map, in the robot frame of the arm
+  - resolution: the size of a voxel
+  - num_rolls: the number of rotations of the gripper around each of the sampled approach directions
+  - ik_timeout: how long IK may search for each sample; most samples are not reachable, so this
+    dominates the time the whole build takes
+*/
+
+#include <algorithm>
+
+#include <ros/ros.h>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include <tf/transform_datatypes.h>
+
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl_parser/kdl_parser.hpp>
+
+#include "object_manipulator/tools/exceptions.h"
+#include "object_manipulator/tools/hand_description.h"
+#include "object_manipulator/tools/mechanism_interface.h"
+#include "object_manipulator/tools/param_helpers.h"
+#include "object_manipulator/tools/reachability_map.h"
+
+namespace object_manipulator {
+
+//! Reads an optional list of 3 numbers from the param server, returning the default if it is not set
+static tf::Vector3 getCornerParam(const ros::NodeHandle &nh, std::string name, const tf::Vector3 &default_value)
+{
+  if (!nh.hasParam(name)) return default_value;
+  std::vector<double> values = getVectorDoubleParam(nh, name);
+  if (values.size() != 3) throw BadParamException(name);
+  return tf::Vector3(values[0], values[1], values[2]);
+}
+
+//! Returns the rotation taking the unit vector from onto the unit vector to
+static tf::Quaternion rotationBetween(const tf::Vector3 &from, const tf::Vector3 &to)
+{
+  tf::Vector3 axis = from.cross(to);
+  double cos_angle = std::max(-1.0, std::min(1.0, (double)from.dot(to)));
+  if (axis.length() < 1.0e-6)
+  {
+    if (cos_angle > 0) return tf::Quaternion(0, 0, 0, 1);
+    //opposite vectors: rotate by pi around any axis perpendicular to them
+    axis = from.cross(tf::Vector3(1,0,0));
+    if (axis.length() < 1.0e-6) axis = from.cross(tf::Vector3(0,1,0));
+  }
+  return tf::Quaternion(axis.normalized(), acos(cos_angle));
+}
+
+//! Returns the sampled gripper orientations, in the robot frame
+/*! The approach direction of the gripper is aligned with the faces and the corners of a cube, 
+  and for each of those the gripper is rolled around it num_rolls times. */
+static std::vector<tf::Quaternion> sampleOrientations(std::string arm_name, int num_rolls)
+{
+  tf::Vector3 approach;
+  tf::vector3MsgToTF(handDescription().approachDirection(arm_name), approach);
+  std::vector<tf::Vector3> directions;
+  for (int axis=0; axis<3; axis++)
+  {
+    for (int sign=-1; sign<=1; sign+=2)
+    {
+      tf::Vector3 direction(0,0,0);
+      direction[axis] = sign;
+      directions.push_back(direction);
+    }
+  }
+  for (int x=-1; x<=1; x+=2)
+    for (int y=-1; y<=1; y+=2)
+      for (int z=-1; z<=1; z+=2)
+        directions.push_back(tf::Vector3(x,y,z).normalized());
+
+  std::vector<tf::Quaternion> orientations;
+  for (size_t i=0; i<directions.size(); i++)
+  {
+    tf::Quaternion align = rotationBetween(approach, directions[i]);
+    for (int r=0; r<num_rolls; r++)
+    {
+      tf::Quaternion roll(directions[i], 2.0 * M_PI * r / num_rolls);
+      orientations.push_back(roll * align);
+    }
+  }
+  return orientations;
+}
+
+//! Computes the manipulability measure sqrt(det(J J^T)) for the position part of the arm Jacobian
+/*! The Jacobian is computed from the kinematic chain between the robot frame and the gripper 
+  frame of the arm. Only the columns of the arm joints are used; other joints in the chain (e.g.
+  a torso) are held at 0, which only moves the arm as a whole and does not change those columns. */
+class ManipulabilitySolver
+{
+ private:
+  KDL::Chain chain_;
+  boost::shared_ptr<KDL::ChainJntToJacSolver> solver_;
+  //! The names of the moving joints of the chain, in chain order
+  std::vector<std::string> joint_names_;
+
+ public:
+  ManipulabilitySolver(std::string arm_name)
+  {
+    KDL::Tree tree;
+    if (!kdl_parser::treeFromParam("robot_description", tree)) 
+      throw GraspException("failed to parse the robot model from robot_description");
+    std::string root = handDescription().robotFrame(arm_name), tip = handDescription().gripperFrame(arm_name);
+    if (!tree.getChain(root, tip, chain_)) 
+      throw GraspException("robot model has no kinematic chain from " + root + " to " + tip);
+    solver_.reset(new KDL::ChainJntToJacSolver(chain_));
+    for (unsigned int s=0; s<chain_.getNrOfSegments(); s++)
+    {
+      const KDL::Joint &joint = chain_.getSegment(s).getJoint();
+      if (joint.getType() != KDL::Joint::None) joint_names_.push_back(joint.getName());
+    }
+  }
+
+  //! Only the joints in \a joint_state are considered arm joints
+  double compute(const sensor_msgs::JointState &joint_state) const
+  {
+    KDL::JntArray positions(joint_names_.size());
+    std::vector<size_t> columns;
+    for (size_t j=0; j<joint_names_.size(); j++)
+    {
+      std::vector<std::string>::const_iterator it = 
+        std::find(joint_state.name.begin(), joint_state.name.end(), joint_names_[j]);
+      size_t index = it - joint_state.name.begin();
+      if (index >= joint_state.position.size()) continue;
+      positions(j) = joint_state.position[index];
+      columns.push_back(j);
+    }
+    KDL::Jacobian jacobian(joint_names_.size());
+    if (columns.empty() || solver_->JntToJac(positions, jacobian) < 0) return 0.0;
+    Eigen::MatrixXd position_jacobian(3, columns.size());
+    for (size_t c=0; c<columns.size(); c++)
+      for (int i=0; i<3; i++) position_jacobian(i,c) = jacobian(i, columns[c]);
+    double determinant = (position_jacobian * position_jacobian.transpose()).determinant();
+    return determinant > 0.0 ? sqrt(determinant) : 0.0;
+  }
+};
+
+} //namespace object_manipulator
+
+using namespace object_manipulator;
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "build_reachability_map");
+  ros::NodeHandle priv_nh("~");
+
+  std::string arm_name, output_file;
+  double resolution, ik_timeout;
+  int num_rolls;
+  priv_nh.param<std::string>("arm_name", arm_name, "right_arm");
+  priv_nh.param<std::string>("output_file", output_file, arm_name + "_reachability.map");
+  priv_nh.param<double>("resolution", resolution, 0.05);
+  priv_nh.param<int>("num_rolls", num_rolls, 4);
+  priv_nh.param<double>("ik_timeout", ik_timeout, 0.05);
+  if (resolution <= 0.0 || num_rolls < 1 || ik_timeout <= 0.0)
+  {
+    ROS_ERROR("Reachability map: resolution, num_rolls and ik_timeout must be positive");
+    return 1;
+  }
+
+  try
+  {
+    tf::Vector3 min_corner = getCornerParam(priv_nh, "min_corner", tf::Vector3(-0.5, -1.2, 0.0));
+    tf::Vector3 max_corner = getCornerParam(priv_nh, "max_corner", tf::Vector3(1.3, 1.2, 1.8));
+    std::string frame_id = handDescription().robotFrame(arm_name);
+    std::vector<tf::Quaternion> orientations = sampleOrientations(arm_name, num_rolls);
+    ReachabilityMap map(frame_id, min_corner, max_corner, resolution);
+    ROS_INFO("Reachability map: building map for %s in frame %s, with %zd voxels and %zd orientations per voxel",
+             arm_name.c_str(), frame_id.c_str(), map.numVoxels(), orientations.size());
+    size_t num_samples = map.numVoxels() * orientations.size();
+    ROS_INFO("Reachability map: %zd IK samples in total, up to %.1f hours with an IK timeout of %.3f s",
+             num_samples, num_samples * ik_timeout / 3600.0, ik_timeout);
+
+    //manipulability is normalized once the largest value is known
+    std::vector<double> reachability(map.numVoxels(), 0.0), manipulability(map.numVoxels(), 0.0);
+    double max_manipulability = 0.0;
+    ManipulabilitySolver manipulability_solver(arm_name);
+
+    //this is the only client, so the empty planning scene set here stays in place for all IK calls
+    arm_navigation_msgs::OrderedCollisionOperations empty;
+    std::vector<arm_navigation_msgs::LinkPadding> also_empty;
+    mechInterface().getPlanningScene(empty, also_empty);
+    //most poses are not reachable, so IK is called directly, without logging each failure
+    kinematics_msgs::GetConstraintAwarePositionIK::Request ik_request;
+    ik_request.ik_request.ik_link_name = handDescription().gripperFrame(arm_name);
+    ik_request.ik_request.pose_stamped.header.frame_id = frame_id;
+    ik_request.ik_request.pose_stamped.header.stamp = ros::Time(0);
+    ik_request.ik_request.ik_seed_state.joint_state.name = mechInterface().getJointNames(arm_name);
+    ik_request.ik_request.ik_seed_state.joint_state.position.resize(
+      ik_request.ik_request.ik_seed_state.joint_state.name.size(), 0.0);
+    ik_request.timeout = ros::Duration(ik_timeout);
+
+    for (size_t v=0; v<map.numVoxels() && ros::ok(); v++)
+    {
+      tf::pointTFToMsg(map.voxelCenter(v), ik_request.ik_request.pose_stamped.pose.position);
+      int num_reachable = 0;
+      for (size_t o=0; o<orientations.size(); o++)
+      {
+        tf::quaternionTFToMsg(orientations[o], ik_request.ik_request.pose_stamped.pose.orientation);
+        kinematics_msgs::GetConstraintAwarePositionIK::Response ik_response;
+        if (!mechInterface().ik_service_client_.call(arm_name, ik_request, ik_response))
+          throw MechanismException("IK Service Call failed altogether");
+        if (ik_response.error_code.val != ik_response.error_code.SUCCESS) continue;
+        num_reachable++;
+        manipulability[v] = std::max(manipulability[v], 
+                                     manipulability_solver.compute(ik_response.solution.joint_state));
+      }
+      reachability[v] = (double)num_reachable / orientations.size();
+      max_manipulability = std::max(max_manipulability, manipulability[v]);
+      if ( (v+1) % 100 == 0 ) ROS_INFO("Reachability map: %zd of %zd voxels done", v+1, map.numVoxels());
+    }
+    if (!ros::ok()) return 1;
+
+    for (size_t v=0; v<map.numVoxels(); v++)
+    {
+      map.setVoxel(v, reachability[v], max_manipulability > 0.0 ? manipulability[v] / max_manipulability : 0.0);
+    }
+    if (!map.save(output_file)) return 1;
+    ROS_INFO("Reachability map: saved to %s", output_file.c_str());
+  }
+  catch (GraspException &ex)
+  {
+    ROS_ERROR("Reachability map: %s", ex.what());
+    return 1;
+  }
+  return 0;
+}
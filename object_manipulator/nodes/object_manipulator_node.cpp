@@ -34,9 +34,15 @@
 // Author(s): Matei Ciocarlie
 
 #include "object_manipulator/object_manipulator.h"
+#include "object_manipulator/grasp_execution/grasp_prescreener.h"
+#include "object_manipulator/tools/arm_configurations.h"
+#include "object_manipulator/tools/hand_description.h"
+#include "object_manipulator/GetGraspPrescreenStatistics.h"
 
 #include <ros/ros.h>
 
+#include <std_srvs/Empty.h>
+
 #include <actionlib/server/simple_action_server.h>
 
 #include <object_manipulation_msgs/PickupAction.h>
@@ -46,6 +52,8 @@ namespace object_manipulator {
 
 static const std::string PICKUP_ACTION_NAME = "object_manipulator_pickup";
 static const std::string PLACE_ACTION_NAME = "object_manipulator_place";
+static const std::string PRESCREEN_STATISTICS_SERVICE_NAME = "get_grasp_prescreen_statistics";
+static const std::string RELOAD_PARAMS_SERVICE_NAME = "reload_params";
 
 //! Wraps the Object Manipulator in a ROS API
 class ObjectManipulatorNode
@@ -63,6 +71,12 @@ private:
   //! The action server for placing
   actionlib::SimpleActionServer<object_manipulation_msgs::PlaceAction> place_action_server_;
 
+  //! Server for the grasp prescreening statistics
+  ros::ServiceServer prescreen_statistics_srv_;
+
+  //! Server for re-reading the hand descriptions and arm configurations
+  ros::ServiceServer reload_params_srv_;
+
   //! Callback for the pickup action
   void pickupCallback(const object_manipulation_msgs::PickupGoal::ConstPtr &goal)
   {
@@ -75,6 +89,30 @@ private:
     object_manipulator_.place(goal, &place_action_server_);
   }
 
+  //! Callback for the prescreening statistics service
+  bool prescreenStatisticsCB(GetGraspPrescreenStatistics::Request &request, 
+                             GetGraspPrescreenStatistics::Response &response)
+  {
+    GraspPrescreener::Statistics statistics = object_manipulator_.getGraspPrescreener().getStatistics();
+    response.grasps_checked = statistics.grasps_checked;
+    response.rejected_out_of_reach = statistics.rejected_out_of_reach;
+    response.rejected_surface_collision = statistics.rejected_surface_collision;
+    response.rejected_approach_through_surface = statistics.rejected_approach_through_surface;
+    response.time = statistics.time;
+    return true;
+  }
+
+  //! Callback for the reload params service
+  /*! The hand descriptions and arm configurations are read from the parameter server once, so changes
+    made there later only take effect after calling this. */
+  bool reloadParamsCB(std_srvs::Empty::Request &request, std_srvs::Empty::Response &response)
+  {
+    handDescription().reload();
+    armConfigurations().reload();
+    ROS_INFO("Object manipulator: reloaded hand descriptions and arm configurations");
+    return true;
+  }
+
 public:
   ObjectManipulatorNode() : priv_nh_("~"),
 			    pickup_action_server_( priv_nh_, PICKUP_ACTION_NAME, 
@@ -86,6 +124,10 @@ public:
   {
     pickup_action_server_.start();
     place_action_server_.start();
+    prescreen_statistics_srv_ = priv_nh_.advertiseService(PRESCREEN_STATISTICS_SERVICE_NAME,
+                                                          &ObjectManipulatorNode::prescreenStatisticsCB, this);
+    reload_params_srv_ = priv_nh_.advertiseService(RELOAD_PARAMS_SERVICE_NAME, 
+                                                   &ObjectManipulatorNode::reloadParamsCB, this);
   }
 };
 
@@ -96,5 +138,6 @@ int main(int argc, char** argv)
   ros::init(argc, argv, "object_manipulator");
   object_manipulator::ObjectManipulatorNode node;
   ros::spin();
+  object_manipulator::mechInterface().logServiceCallStatistics();
   return 0;
 }
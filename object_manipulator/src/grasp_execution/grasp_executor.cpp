@@ -75,45 +75,45 @@ GraspExecutor::linkPaddingForLift(const object_manipulation_msgs::PickupGoal &pi
                 pickup_goal.additional_link_padding);
 }
 
+MechanismInterface::InterpolatedIKRequest 
+GraspExecutor::liftIKRequest(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                             const object_manipulation_msgs::Grasp &grasp,
+                             const std::vector<double> &grasp_joint_angles)
+{
+  MechanismInterface::InterpolatedIKRequest request;
+  request.start_pose.pose = grasp.grasp_pose;
+  request.start_pose.header.frame_id = pickup_goal.target.reference_frame_id;
+  request.start_pose.header.stamp = ros::Time(0);
+  request.direction = pickup_goal.lift.direction;
+  request.desired_trajectory_length = pickup_goal.lift.desired_distance;
+  request.seed_joint_position = grasp_joint_angles;
+  request.joint_state = grasp.grasp_posture;
+  request.reverse_trajectory = false;
+  return request;
+}
+
 GraspResult 
-GraspExecutor::getInterpolatedIKForLift(const object_manipulation_msgs::PickupGoal &pickup_goal,
-					const object_manipulation_msgs::Grasp &grasp,
-					const std::vector<double> &grasp_joint_angles,
-					trajectory_msgs::JointTrajectory &lift_trajectory)
+GraspExecutor::liftIKResult(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                            const MechanismInterface::InterpolatedIKResult &ik_result)
 {
-  geometry_msgs::PoseStamped grasp_pose;
-  grasp_pose.pose = grasp.grasp_pose;
-  grasp_pose.header.frame_id = pickup_goal.target.reference_frame_id;
-  grasp_pose.header.stamp = ros::Time(0);
-
-  float actual_lift_distance;
-  int error_code = 
-    mechInterface().getInterpolatedIK(pickup_goal.arm_name, 
-				      grasp_pose, 
-				      pickup_goal.lift.direction, pickup_goal.lift.desired_distance,
-				      grasp_joint_angles, 
-				      grasp.grasp_posture, 
-				      collisionOperationsForLift(pickup_goal), linkPaddingForLift(pickup_goal),
-				      false, lift_trajectory, actual_lift_distance);
-  ROS_DEBUG_NAMED("manipulation","  Lift distance: actual %f, min %f and desired %f", actual_lift_distance, pickup_goal.lift.min_distance,
-           pickup_goal.lift.desired_distance);
-
-  if (actual_lift_distance < pickup_goal.lift.min_distance)
+  ROS_DEBUG_NAMED("manipulation","  Lift distance: actual %f, min %f and desired %f", ik_result.actual_trajectory_length, 
+                  pickup_goal.lift.min_distance, pickup_goal.lift.desired_distance);
+
+  if (ik_result.actual_trajectory_length < pickup_goal.lift.min_distance)
   {
     ROS_DEBUG_NAMED("manipulation","  Lift trajectory  below min. threshold");
-    if (marker_publisher_) marker_publisher_->colorGraspMarker(marker_id_, 0.0, 0.0, 1.0); //blue
-    if (lift_trajectory.points.empty())
+    if (ik_result.trajectory.points.empty())
     {
       ROS_DEBUG_NAMED("manipulation","  Lift trajectory empty; problem is with grasp location");
-      if (error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
+      if (ik_result.error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
 	return Result(GraspResult::GRASP_IN_COLLISION, true);
-      else if (error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
+      else if (ik_result.error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
 	return Result(GraspResult::GRASP_OUT_OF_REACH, true);
       else return Result(GraspResult::GRASP_UNFEASIBLE, true);
     }
-    if (error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
+    if (ik_result.error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
       return Result(GraspResult::LIFT_IN_COLLISION, true);
-    else if (error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
+    else if (ik_result.error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
       return Result(GraspResult::LIFT_OUT_OF_REACH, true);
     else return Result(GraspResult::LIFT_UNFEASIBLE, true);
   }
@@ -125,6 +125,27 @@ GraspExecutor::getInterpolatedIKForLift(const object_manipulation_msgs::PickupGo
   return Result(GraspResult::SUCCESS, true);
 }
 
+GraspResult 
+GraspExecutor::getInterpolatedIKForLift(const object_manipulation_msgs::PickupGoal &pickup_goal,
+					const object_manipulation_msgs::Grasp &grasp,
+					const std::vector<double> &grasp_joint_angles,
+					trajectory_msgs::JointTrajectory &lift_trajectory)
+{
+  std::vector<MechanismInterface::InterpolatedIKRequest> requests(1, liftIKRequest(pickup_goal, grasp, 
+                                                                                   grasp_joint_angles));
+  std::vector<MechanismInterface::InterpolatedIKResult> ik_results;
+  mechInterface().getInterpolatedIKBatch(pickup_goal.arm_name, requests, 
+                                         collisionOperationsForLift(pickup_goal), linkPaddingForLift(pickup_goal),
+                                         ik_results);
+  lift_trajectory = ik_results[0].trajectory;
+  GraspResult result = liftIKResult(pickup_goal, ik_results[0]);
+  if (result.result_code != GraspResult::SUCCESS && marker_publisher_) 
+  {
+    marker_publisher_->colorGraspMarker(marker_id_, 0.0, 0.0, 1.0); //blue
+  }
+  return result;
+}
+
 GraspResult 
 GraspExecutor::lift(const object_manipulation_msgs::PickupGoal &pickup_goal)
 {
@@ -155,7 +176,14 @@ GraspExecutor::checkAndExecuteGrasp(const object_manipulation_msgs::PickupGoal &
   GraspResult result = prepareGrasp(pickup_goal, grasp);
   if (result.result_code != GraspResult::SUCCESS || pickup_goal.only_perform_feasibility_test) return result;
 
-  result = executeGrasp(pickup_goal, grasp);
+  return executePreparedGrasp(pickup_goal, grasp);
+}
+
+GraspResult 
+GraspExecutor::executePreparedGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                    const object_manipulation_msgs::Grasp &grasp)
+{
+  GraspResult result = executeGrasp(pickup_goal, grasp);
   if (result.result_code != GraspResult::SUCCESS) return result;
 
   //check if there is anything in gripper; if not, open gripper and retreat
@@ -86,54 +86,50 @@ GraspExecutorWithApproach::linkPaddingForGrasp(const object_manipulation_msgs::P
                 pickup_goal.additional_link_padding);
 }
 
-GraspResult 
-GraspExecutorWithApproach::getInterpolatedIKForGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
-						     const object_manipulation_msgs::Grasp &grasp,
-						     trajectory_msgs::JointTrajectory &grasp_trajectory)
+MechanismInterface::InterpolatedIKRequest 
+GraspExecutorWithApproach::approachIKRequest(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                             const object_manipulation_msgs::Grasp &grasp)
 {
+  MechanismInterface::InterpolatedIKRequest request;
   //get the grasp pose in the right frame
-  geometry_msgs::PoseStamped grasp_pose_stamped;
-  grasp_pose_stamped.pose = grasp.grasp_pose;
-  grasp_pose_stamped.header.frame_id = pickup_goal.target.reference_frame_id;
-  grasp_pose_stamped.header.stamp = ros::Time(0);
+  request.start_pose.pose = grasp.grasp_pose;
+  request.start_pose.header.frame_id = pickup_goal.target.reference_frame_id;
+  request.start_pose.header.stamp = ros::Time(0);
 
   //use the opposite of the approach direction as we are going backwards, from grasp to pre-grasp
-  geometry_msgs::Vector3Stamped direction;
-  direction.header.stamp = ros::Time::now();
-  direction.header.frame_id = handDescription().gripperFrame(pickup_goal.arm_name);
-  direction.vector = mechInterface().negate( handDescription().approachDirection(pickup_goal.arm_name) );
+  request.direction.header.stamp = ros::Time::now();
+  request.direction.header.frame_id = handDescription().gripperFrame(pickup_goal.arm_name);
+  request.direction.vector = mechInterface().negate( handDescription().approachDirection(pickup_goal.arm_name) );
 
-  std::vector<double> empty;
+  request.desired_trajectory_length = grasp.desired_approach_distance;
+  request.joint_state = grasp.pre_grasp_posture;
   //remember to pass that we want to flip the trajectory
-  float actual_approach_distance;
-  int error_code = mechInterface().getInterpolatedIK(pickup_goal.arm_name, 
-						     grasp_pose_stamped, 
-						     direction, grasp.desired_approach_distance,
-						     empty, 
-						     grasp.pre_grasp_posture,
-						     collisionOperationsForGrasp(pickup_goal), 
-						     linkPaddingForGrasp(pickup_goal),
-						     true, grasp_trajectory, actual_approach_distance);
+  request.reverse_trajectory = true;
+  return request;
+}
+
+GraspResult 
+GraspExecutorWithApproach::approachIKResult(const object_manipulation_msgs::Grasp &grasp,
+                                            const MechanismInterface::InterpolatedIKResult &ik_result)
+{
   ROS_DEBUG_NAMED("manipulation","  Grasp executor approach distance: actual (%f), min(%f) and desired (%f)", 
-            actual_approach_distance, grasp.min_approach_distance, grasp.desired_approach_distance);
+            ik_result.actual_trajectory_length, grasp.min_approach_distance, grasp.desired_approach_distance);
 
-  if ( actual_approach_distance < grasp.min_approach_distance)
+  if ( ik_result.actual_trajectory_length < grasp.min_approach_distance)
   {
     ROS_DEBUG_NAMED("manipulation","  Grasp executor: interpolated IK for grasp below min threshold");
-    if (grasp_trajectory.points.empty())
+    if (ik_result.trajectory.points.empty())
     {
       ROS_DEBUG_NAMED("manipulation","  Grasp executor: interpolaed IK empty, problem is with grasp location");
-      if (marker_publisher_) marker_publisher_->colorGraspMarker(marker_id_, 1.0, 1.0, 0.0); //yellow
-      if (error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
+      if (ik_result.error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
 	return Result(GraspResult::GRASP_IN_COLLISION, true);
-      else if (error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
+      else if (ik_result.error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
 	return Result(GraspResult::GRASP_OUT_OF_REACH, true);
       else return Result(GraspResult::GRASP_UNFEASIBLE, true);      
     }
-    if (marker_publisher_) marker_publisher_->colorGraspMarker(marker_id_, 0.0, 1.0, 1.0); //cyan
-    if (error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
+    if (ik_result.error_code == ArmNavigationErrorCodes::COLLISION_CONSTRAINTS_VIOLATED) 
       return Result(GraspResult::PREGRASP_IN_COLLISION, true);
-    else if (error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
+    else if (ik_result.error_code == ArmNavigationErrorCodes::JOINT_LIMITS_VIOLATED)
       return Result(GraspResult::PREGRASP_OUT_OF_REACH, true);
     else return Result(GraspResult::PREGRASP_UNFEASIBLE, true);      
   }
@@ -145,6 +141,63 @@ GraspExecutorWithApproach::getInterpolatedIKForGrasp(const object_manipulation_m
   return Result(GraspResult::SUCCESS, true);
 }
 
+GraspResult 
+GraspExecutorWithApproach::getInterpolatedIKForGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
+						     const object_manipulation_msgs::Grasp &grasp,
+						     trajectory_msgs::JointTrajectory &grasp_trajectory)
+{
+  std::vector<MechanismInterface::InterpolatedIKRequest> requests(1, approachIKRequest(pickup_goal, grasp));
+  std::vector<MechanismInterface::InterpolatedIKResult> ik_results;
+  mechInterface().getInterpolatedIKBatch(pickup_goal.arm_name, requests, 
+                                         collisionOperationsForGrasp(pickup_goal), linkPaddingForGrasp(pickup_goal),
+                                         ik_results);
+  grasp_trajectory = ik_results[0].trajectory;
+  GraspResult result = approachIKResult(grasp, ik_results[0]);
+  if (result.result_code != GraspResult::SUCCESS && marker_publisher_)
+  {
+    //yellow if the problem is with the grasp location, cyan if it is with the pre-grasp
+    if (grasp_trajectory.points.empty()) marker_publisher_->colorGraspMarker(marker_id_, 1.0, 1.0, 0.0);
+    else marker_publisher_->colorGraspMarker(marker_id_, 0.0, 1.0, 1.0);
+  }
+  return result;
+}
+
+GraspResult 
+GraspExecutorWithApproach::checkPreGraspValidity(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                                 const trajectory_msgs::JointTrajectory &grasp_trajectory)
+{
+  //check if the first pose in grasp trajectory is valid
+  //when we check from pre-grasp to grasp we use custom link padding, so we need to check here
+  //if the initial pose is feasible with default padding; otherwise, move_arm might refuse to 
+  //take us there
+  if ( !mechInterface().checkStateValidity(pickup_goal.arm_name, 
+                                           grasp_trajectory.points.front().positions,
+                                           pickup_goal.additional_collision_operations,
+                                           pickup_goal.additional_link_padding) )
+  {
+    ROS_DEBUG_NAMED("manipulation","  Grasp executor: initial pose in grasp trajectory is unfeasible with default padding");
+    return Result(GraspResult::PREGRASP_UNFEASIBLE, true);      
+  }
+  return Result(GraspResult::SUCCESS, true);
+}
+
+GraspResult 
+GraspExecutorWithApproach::checkLiftValidity(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                             const trajectory_msgs::JointTrajectory &lift_trajectory)
+{
+  //check if the last pose in lift trajectory is valid
+  //when we check for lift we use custom link padding, so we need to check here if the last pose 
+  //is feasible with default padding; otherwise, move_arm might refuse to take us out of there
+  if ( pickup_goal.lift.min_distance != 0 && 
+       !mechInterface().checkStateValidity(pickup_goal.arm_name, lift_trajectory.points.back().positions,
+                                           collisionOperationsForLift(pickup_goal),
+                                           pickup_goal.additional_link_padding) )
+  {
+    ROS_DEBUG_NAMED("manipulation","  Grasp executor: last pose in lift trajectory is unfeasible with default padding");
+    return Result(GraspResult::LIFT_UNFEASIBLE, true);
+  }
+  return Result(GraspResult::SUCCESS, true);
+}
 
 GraspResult GraspExecutorWithApproach::prepareGrasp(const object_manipulation_msgs::PickupGoal &pickup_goal,
 						    const object_manipulation_msgs::Grasp &grasp)
@@ -170,32 +223,92 @@ GraspResult GraspExecutorWithApproach::prepareGrasp(const object_manipulation_ms
     return result;
   }
 
-  //check if the first pose in grasp trajectory is valid
-  //when we check from pre-grasp to grasp we use custom link padding, so we need to check here
-  //if the initial pose is feasible with default padding; otherwise, move_arm might refuse to 
-  //take us there
-  if ( !mechInterface().checkStateValidity(pickup_goal.arm_name, 
-                                           interpolated_grasp_trajectory_.points.front().positions,
-                                           pickup_goal.additional_collision_operations,
-                                           pickup_goal.additional_link_padding) )
+  result = checkPreGraspValidity(pickup_goal, interpolated_grasp_trajectory_);
+  if (result.result_code != GraspResult::SUCCESS) return result;
+  return checkLiftValidity(pickup_goal, interpolated_lift_trajectory_);
+}
+
+/*! The lift paths are seeded with the grasp solutions found by the approach paths, so the two 
+  can not be computed in the same exchange. They also use different planning scenes. The validity 
+  checks for the ends of the trajectories are also grouped by planning scene, so the scene sent to the 
+  environment server changes four times regardless of the number of grasps, instead of alternating 
+  for each grasp, and each group of checks is sent as a batch. */
+void GraspExecutorWithApproach::checkGraspsFeasibility(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                                       const std::vector<object_manipulation_msgs::Grasp> &grasps,
+                                                       std::vector<GraspResult> &results)
+{
+  results.clear();
+  if (grasps.empty()) return;
+
+  //approach paths for all the grasps
+  std::vector<MechanismInterface::InterpolatedIKRequest> requests;
+  for (size_t i=0; i<grasps.size(); i++) requests.push_back(approachIKRequest(pickup_goal, grasps[i]));
+  std::vector<MechanismInterface::InterpolatedIKResult> approach_results;
+  mechInterface().getInterpolatedIKBatch(pickup_goal.arm_name, requests, 
+                                         collisionOperationsForGrasp(pickup_goal), linkPaddingForGrasp(pickup_goal),
+                                         approach_results);
+
+  //lift paths for the grasps that can be reached, starting from their grasp solutions
+  requests.clear();
+  std::vector<size_t> lift_grasps;
+  for (size_t i=0; i<grasps.size(); i++)
   {
+    results.push_back( approachIKResult(grasps[i], approach_results[i]) );
+    if (results[i].result_code != GraspResult::SUCCESS) continue;
+    lift_grasps.push_back(i);
+    requests.push_back( liftIKRequest(pickup_goal, grasps[i], approach_results[i].trajectory.points.back().positions) );
+  }
+  std::vector<MechanismInterface::InterpolatedIKResult> lift_results;
+  mechInterface().getInterpolatedIKBatch(pickup_goal.arm_name, requests, 
+                                         collisionOperationsForLift(pickup_goal), linkPaddingForLift(pickup_goal),
+                                         lift_results);
+
+  std::vector<size_t> lift_index(grasps.size(), lift_grasps.size());
+  for (size_t j=0; j<lift_grasps.size(); j++)
+  {
+    size_t i = lift_grasps[j];
+    lift_index[i] = j;
+    results[i] = liftIKResult(pickup_goal, lift_results[j]);
+  }
+
+  //start of the approach: goal collision operations with default padding
+  //checked before the end of the lift, in the same order as prepareGrasp(...)
+  std::vector<size_t> checked_grasps;
+  std::vector< std::vector<double> > states;
+  for (size_t i=0; i<grasps.size(); i++)
+  {
+    if (results[i].result_code != GraspResult::SUCCESS) continue;
+    checked_grasps.push_back(i);
+    states.push_back(approach_results[i].trajectory.points.front().positions);
+  }
+  std::vector<bool> valid;
+  mechInterface().checkStateValidityBatch(pickup_goal.arm_name, states, pickup_goal.additional_collision_operations,
+                                          pickup_goal.additional_link_padding, valid);
+  for (size_t j=0; j<checked_grasps.size(); j++)
+  {
+    if (valid[j]) continue;
     ROS_DEBUG_NAMED("manipulation","  Grasp executor: initial pose in grasp trajectory is unfeasible with default padding");
-    return Result(GraspResult::PREGRASP_UNFEASIBLE, true);      
+    results[checked_grasps[j]] = Result(GraspResult::PREGRASP_UNFEASIBLE, true);
   }
 
-  //check if the last pose in lift trajectory is valid
-  //when we check for lift we use custom link padding, so we need to check here if the last pose 
-  //is feasible with default padding; otherwise, move_arm might refuse to take us out of there
-  if ( pickup_goal.lift.min_distance != 0 && 
-       !mechInterface().checkStateValidity(pickup_goal.arm_name, interpolated_lift_trajectory_.points.back().positions,
-                                           collisionOperationsForLift(pickup_goal),
-                                           pickup_goal.additional_link_padding) )
+  //end of the lift: lift collision operations with default padding
+  if (pickup_goal.lift.min_distance == 0) return;
+  checked_grasps.clear();
+  states.clear();
+  for (size_t i=0; i<grasps.size(); i++)
   {
+    if (results[i].result_code != GraspResult::SUCCESS) continue;
+    checked_grasps.push_back(i);
+    states.push_back(lift_results[lift_index[i]].trajectory.points.back().positions);
+  }
+  mechInterface().checkStateValidityBatch(pickup_goal.arm_name, states, collisionOperationsForLift(pickup_goal),
+                                          pickup_goal.additional_link_padding, valid);
+  for (size_t j=0; j<checked_grasps.size(); j++)
+  {
+    if (valid[j]) continue;
     ROS_DEBUG_NAMED("manipulation","  Grasp executor: last pose in lift trajectory is unfeasible with default padding");
-    return Result(GraspResult::LIFT_UNFEASIBLE, true);
+    results[checked_grasps[j]] = Result(GraspResult::LIFT_UNFEASIBLE, true);
   }
-
-  return Result(GraspResult::SUCCESS, true);
 }
 
 GraspResult 
@@ -0,0 +1,232 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include "object_manipulator/grasp_execution/grasp_prescreener.h"
+
+#include <limits>
+
+#include "object_manipulator/tools/exceptions.h"
+#include "object_manipulator/tools/hand_description.h"
+#include "object_manipulator/tools/mechanism_interface.h"
+
+using object_manipulation_msgs::GraspResult;
+
+namespace object_manipulator {
+
+GraspPrescreener::Tests GraspPrescreener::setupTests(const object_manipulation_msgs::PickupGoal &pickup_goal)
+{
+  Tests tests;
+  std::string frame_id = pickup_goal.target.reference_frame_id;
+
+  tf::vector3MsgToTF(handDescription().approachDirection(pickup_goal.arm_name), tests.approach_direction);
+
+  //reachability map, if we have one
+  tests.reachability_map = mechInterface().getReachabilityMap(pickup_goal.arm_name);
+  if (tests.reachability_map)
+  {
+    geometry_msgs::PoseStamped frame_pose;
+    frame_pose.header.frame_id = frame_id;
+    frame_pose.header.stamp = ros::Time(0);
+    frame_pose.pose.orientation.w = 1.0;
+    try
+    {
+      frame_pose = mechInterface().transformPose(tests.reachability_map->frameId(), frame_pose);
+      tf::poseMsgToTF(frame_pose.pose, tests.reachability_map_transform);
+    }
+    catch (MechanismException &ex)
+    {
+      ROS_WARN("Grasp prescreening: reachability map not used, could not transform into %s", 
+               tests.reachability_map->frameId().c_str());
+      tests.reachability_map.reset();
+    }
+  }
+
+  //reach envelope, used if we have no reachability map
+  std::string reach_frame;
+  tests.check_reach = !tests.reachability_map && priv_nh_.getParamCached("prescreen/" + pickup_goal.arm_name + "/reach_frame", reach_frame) &&
+    priv_nh_.getParamCached("prescreen/" + pickup_goal.arm_name + "/max_reach", tests.max_reach);
+  if (tests.check_reach)
+  {
+    geometry_msgs::PoseStamped reach_pose;
+    reach_pose.header.frame_id = reach_frame;
+    reach_pose.header.stamp = ros::Time(0);
+    reach_pose.pose.orientation.w = 1.0;
+    try
+    {
+      reach_pose = mechInterface().transformPose(frame_id, reach_pose);
+      tf::pointMsgToTF(reach_pose.pose.position, tests.reach_center);
+    }
+    catch (MechanismException &ex)
+    {
+      ROS_WARN("Grasp prescreening: reach test disabled, could not get the position of %s", reach_frame.c_str());
+      tests.check_reach = false;
+    }
+  }
+
+  //support surface, from the lowest point of the cluster along the lift direction
+  tests.check_surface = false;
+  if (!pickup_goal.allow_gripper_support_collision && !pickup_goal.target.cluster.points.empty())
+  {
+    if (!pickup_goal.lift.direction.header.frame_id.empty() && pickup_goal.lift.direction.header.frame_id != frame_id)
+    {
+      ROS_DEBUG_NAMED("manipulation", "Grasp prescreening: surface test disabled, lift direction not in grasp frame");
+      return tests;
+    }
+    tf::vector3MsgToTF(pickup_goal.lift.direction.vector, tests.surface_normal);
+    if (tests.surface_normal.length() < 1.0e-5) return tests;
+    tests.surface_normal.normalize();
+
+    sensor_msgs::PointCloud cluster;
+    try
+    {
+      if (pickup_goal.target.cluster.header.frame_id != frame_id)
+      {
+        mechInterface().transformPointCloud(frame_id, pickup_goal.target.cluster, cluster);
+      }
+      else cluster = pickup_goal.target.cluster;
+    }
+    catch (MechanismException &ex)
+    {
+      ROS_WARN("Grasp prescreening: surface test disabled, could not transform the cluster");
+      return tests;
+    }
+    tests.surface_height = std::numeric_limits<double>::max();
+    for (size_t i=0; i<cluster.points.size(); i++)
+    {
+      tf::Vector3 point(cluster.points[i].x, cluster.points[i].y, cluster.points[i].z);
+      tests.surface_height = std::min(tests.surface_height, (double)point.dot(tests.surface_normal));
+    }
+    priv_nh_.param<double>("prescreen/surface_clearance", tests.surface_clearance, 0.0);
+    tests.check_surface = true;
+  }
+  return tests;
+}
+
+int GraspPrescreener::testGrasp(const Tests &tests, const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                const object_manipulation_msgs::Grasp &grasp, Statistics &statistics)
+{
+  tf::Pose grasp_pose;
+  tf::poseMsgToTF(grasp.grasp_pose, grasp_pose);
+
+  if (tests.reachability_map)
+  {
+    double reachability, manipulability;
+    if (!tests.reachability_map->lookup(tests.reachability_map_transform * grasp_pose.getOrigin(), 
+                                        reachability, manipulability) || reachability <= 0.0)
+    {
+      statistics.rejected_out_of_reach++;
+      return GraspResult::GRASP_OUT_OF_REACH;
+    }
+  }
+  else if (tests.check_reach && (grasp_pose.getOrigin() - tests.reach_center).length() > tests.max_reach)
+  {
+    statistics.rejected_out_of_reach++;
+    return GraspResult::GRASP_OUT_OF_REACH;
+  }
+
+  if (tests.check_surface)
+  {
+    double grasp_height = grasp_pose.getOrigin().dot(tests.surface_normal) - tests.surface_height;
+    if (grasp_height < tests.surface_clearance)
+    {
+      statistics.rejected_surface_collision++;
+      return GraspResult::GRASP_IN_COLLISION;
+    }
+    tf::Vector3 approach = grasp_pose.getBasis() * tests.approach_direction;
+    double pregrasp_height = grasp_height - grasp.desired_approach_distance * approach.dot(tests.surface_normal);
+    if (pregrasp_height < tests.surface_clearance)
+    {
+      statistics.rejected_approach_through_surface++;
+      return GraspResult::PREGRASP_IN_COLLISION;
+    }
+  }
+  return GraspResult::SUCCESS;
+}
+
+void GraspPrescreener::prescreen(const object_manipulation_msgs::PickupGoal &pickup_goal,
+                                 std::vector<object_manipulation_msgs::Grasp> &grasps,
+                                 std::vector<object_manipulation_msgs::Grasp> &rejected_grasps,
+                                 std::vector<object_manipulation_msgs::GraspResult> &rejected_results)
+{
+  ros::WallTime start_time = ros::WallTime::now();
+  Tests tests;
+  try
+  {
+    tests = setupTests(pickup_goal);
+  }
+  catch (GraspException &ex)
+  {
+    ROS_WARN("Grasp prescreening skipped; exception: %s", ex.what());
+    return;
+  }
+  Statistics statistics;
+  std::vector<object_manipulation_msgs::Grasp> accepted_grasps;
+  accepted_grasps.reserve(grasps.size());
+  for (size_t i=0; i<grasps.size(); i++)
+  {
+    statistics.grasps_checked++;
+    int result_code = testGrasp(tests, pickup_goal, grasps[i], statistics);
+    if (result_code == GraspResult::SUCCESS)
+    {
+      accepted_grasps.push_back(grasps[i]);
+      continue;
+    }
+    GraspResult result;
+    result.result_code = result_code;
+    result.continuation_possible = true;
+    rejected_grasps.push_back(grasps[i]);
+    rejected_results.push_back(result);
+  }
+  grasps.swap(accepted_grasps);
+  statistics.time = (ros::WallTime::now() - start_time).toSec();
+
+  ROS_INFO("Grasp prescreening: %u of %u grasps rejected (out of reach: %u, surface collision: %u, "
+           "approach through surface: %u) in %.3f ms", statistics.grasps_checked - (unsigned int)grasps.size(),
+           statistics.grasps_checked, statistics.rejected_out_of_reach, statistics.rejected_surface_collision,
+           statistics.rejected_approach_through_surface, 1.0e3 * statistics.time);
+
+  boost::mutex::scoped_lock lock(statistics_mutex_);
+  statistics_.grasps_checked += statistics.grasps_checked;
+  statistics_.rejected_out_of_reach += statistics.rejected_out_of_reach;
+  statistics_.rejected_surface_collision += statistics.rejected_surface_collision;
+  statistics_.rejected_approach_through_surface += statistics.rejected_approach_through_surface;
+  statistics_.time += statistics.time;
+}
+
+GraspPrescreener::Statistics GraspPrescreener::getStatistics()
+{
+  boost::mutex::scoped_lock lock(statistics_mutex_);
+  return statistics_;
+}
+
+} //namespace object_manipulator
@@ -85,6 +85,8 @@ ReactiveGraspExecutor::executeGrasp(const object_manipulation_msgs::PickupGoal &
 
   //give the reactive grasp 3 minutes to do its thing
   ros::Duration timeout = ros::Duration(180.0);
+  //the reactive actions use the joint controllers
+  mechInterface().finishDeferredSwitchToJoint(pickup_goal.arm_name);
   mechInterface().reactive_grasp_action_client_.client(pickup_goal.arm_name).sendGoal(reactive_grasp_goal);
   if ( !mechInterface().reactive_grasp_action_client_.client(pickup_goal.arm_name).waitForResult(timeout) )
   {
@@ -165,6 +167,8 @@ ReactiveGraspExecutor::reactiveLift(const object_manipulation_msgs::PickupGoal &
 
   //give the reactive lift 1 minute to do its thing
   ros::Duration timeout = ros::Duration(60.0);
+  //the reactive actions use the joint controllers
+  mechInterface().finishDeferredSwitchToJoint(pickup_goal.arm_name);
   mechInterface().reactive_lift_action_client_.client(pickup_goal.arm_name).sendGoal(reactive_lift_goal);
   if ( !mechInterface().reactive_lift_action_client_.client(pickup_goal.arm_name).waitForResult(timeout) )
   {
@@ -105,6 +105,8 @@ UnsafeGraspExecutor::executeGrasp(const object_manipulation_msgs::PickupGoal &pi
 
     //give the reactive grasp 3 minutes to do its thing
     ros::Duration timeout = ros::Duration(180.0);
+    //the reactive actions use the joint controllers
+    mechInterface().finishDeferredSwitchToJoint(pickup_goal.arm_name);
     mechInterface().reactive_grasp_action_client_.client(pickup_goal.arm_name).sendGoal(reactive_grasp_goal);
     if ( !mechInterface().reactive_grasp_action_client_.client(pickup_goal.arm_name).waitForResult(timeout) )
     {
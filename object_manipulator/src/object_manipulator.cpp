@@ -36,6 +36,9 @@
 #include "object_manipulator/object_manipulator.h"
 
 #include <algorithm>
+#include <cmath>
+
+#include <boost/scoped_ptr.hpp>
 
 //#define PROF_ENABLED
 //#include <profiling/profiling.h>
@@ -46,9 +49,12 @@
 #include <object_manipulation_msgs/tools.h>
 
 #include "object_manipulator/grasp_execution/grasp_executor_with_approach.h"
+#include "object_manipulator/grasp_execution/grasp_feasibility_evaluator.h"
+#include "object_manipulator/grasp_execution/grasp_prescreener.h"
 #include "object_manipulator/grasp_execution/reactive_grasp_executor.h"
 #include "object_manipulator/grasp_execution/unsafe_grasp_executor.h"
 #include "object_manipulator/place_execution/place_executor.h"
+#include "object_manipulator/place_execution/place_feasibility_evaluator.h"
 #include "object_manipulator/tools/grasp_marker_publisher.h"
 #include "object_manipulator/tools/exceptions.h"
 
@@ -67,11 +73,65 @@ using object_manipulation_msgs::getPlaceLocationResultInfo;
 
 namespace object_manipulator {
 
+//! Creates the executors used by the feasibility evaluator; they do not publish markers
+static GraspExecutor* newFeasibilityExecutor()
+{
+  return new GraspExecutorWithApproach(NULL);
+}
+
+//! Creates the executors used by the place feasibility evaluator; they do not publish markers
+static PlaceExecutor* newPlaceFeasibilityExecutor()
+{
+  return new PlaceExecutor(NULL);
+}
+
+//! Makes sure no feasibility checks are left running in the background when pickup or place returns
+template <class Evaluator>
+class FeasibilityCheckGuard
+{
+ private:
+  Evaluator *evaluator_;
+ public:
+  FeasibilityCheckGuard(Evaluator *evaluator) : evaluator_(evaluator) {}
+  ~FeasibilityCheckGuard() {if (evaluator_) evaluator_->stop();}
+};
+
+//! Returns the order in which candidates should be tried, given their reachability
+/*! Candidates are grouped in bands of the given width, starting from the most reachable one. The 
+  original order, which reflects the preferences of whoever produced the candidates, is kept 
+  within each band. */
+static std::vector<size_t> reachabilityOrder(const std::vector<double> &reachability, double band)
+{
+  std::vector< std::pair<int, size_t> > keys;
+  for (size_t i=0; i<reachability.size(); i++)
+  {
+    int band_index = band > 0.0 ? (int)floor(reachability[i] / band) : 0;
+    keys.push_back( std::pair<int, size_t>(-band_index, i) );
+  }
+  std::sort(keys.begin(), keys.end());
+  std::vector<size_t> order;
+  for (size_t i=0; i<keys.size(); i++) order.push_back(keys[i].second);
+  return order;
+}
+
+//! Reorders a list according to the given order
+template <class T>
+static void applyOrder(const std::vector<size_t> &order, std::vector<T> &items)
+{
+  std::vector<T> ordered;
+  ordered.reserve(items.size());
+  for (size_t i=0; i<order.size(); i++) ordered.push_back(items[order[i]]);
+  items.swap(ordered);
+}
+
 ObjectManipulator::ObjectManipulator() :
   priv_nh_("~"),
   root_nh_(""),
   grasp_planning_services_("", "", false),
-  marker_pub_(NULL)
+  marker_pub_(NULL),
+  feasibility_evaluator_(NULL),
+  place_feasibility_evaluator_(NULL),
+  speculative_grasp_lookahead_(0)
 {
   bool publish_markers = true;
   if (publish_markers)
@@ -82,6 +142,7 @@ ObjectManipulator::ObjectManipulator() :
   grasp_executor_with_approach_ = new GraspExecutorWithApproach(marker_pub_);
   reactive_grasp_executor_ = new ReactiveGraspExecutor(marker_pub_);
   unsafe_grasp_executor_ = new UnsafeGraspExecutor(marker_pub_);
+  grasp_prescreener_ = new GraspPrescreener();
   place_executor_ = new PlaceExecutor(marker_pub_);
   reactive_place_executor_ = new ReactivePlaceExecutor(marker_pub_);
 
@@ -90,6 +151,27 @@ ObjectManipulator::ObjectManipulator() :
   priv_nh_.param<std::string>("default_probabilistic_planner", default_probabilistic_planner_, 
 			      "default_probabilistic_planner");
   priv_nh_.param<bool>("randomize_grasps", randomize_grasps_, false);
+  priv_nh_.param<bool>("prescreen_grasps", prescreen_grasps_, true);
+  priv_nh_.param<bool>("sort_by_reachability", sort_by_reachability_, true);
+  priv_nh_.param<double>("reachability_sort_band", reachability_band_, 0.25);
+
+  //number of threads used for checking grasp feasibility ahead of execution; 0 or 1 to disable
+  int feasibility_workers;
+  priv_nh_.param<int>("grasp_feasibility_workers", feasibility_workers, 4);
+  if (feasibility_workers > 1)
+  {
+    feasibility_evaluator_ = new GraspFeasibilityEvaluator(feasibility_workers, &newFeasibilityExecutor);
+  }
+  priv_nh_.param<int>("speculative_grasp_lookahead", speculative_grasp_lookahead_, 0);
+
+  //same for place locations
+  int place_feasibility_workers;
+  priv_nh_.param<int>("place_feasibility_workers", place_feasibility_workers, 4);
+  if (place_feasibility_workers > 1)
+  {
+    place_feasibility_evaluator_ = new PlaceFeasibilityEvaluator(place_feasibility_workers, 
+                                                                 &newPlaceFeasibilityExecutor);
+  }
 
   ROS_INFO("Object manipulator ready. Default cluster planner: %s. Default database planner: %s.", 
 	   default_cluster_planner_.c_str(), default_database_planner_.c_str());
@@ -102,6 +184,9 @@ ObjectManipulator::~ObjectManipulator()
   delete grasp_executor_with_approach_;
   delete reactive_grasp_executor_;
   delete unsafe_grasp_executor_;
+  delete feasibility_evaluator_;
+  delete grasp_prescreener_;
+  delete place_feasibility_evaluator_;
   delete place_executor_;
   delete reactive_place_executor_;
 }
@@ -181,6 +266,14 @@ void ObjectManipulator::pickup(const PickupGoal::ConstPtr &pickup_goal,
       return;
     }
   }
+  //drop the grasps that are obviously infeasible before spending any time on them; they are
+  //still reported as attempted, along with the reason for rejecting them
+  if (prescreen_grasps_)
+  {
+    MechanismInterface::ScopedTransformSnapshot transform_snapshot(mechInterface());
+    grasp_prescreener_->prescreen(*pickup_goal, grasps, result.attempted_grasps, result.attempted_grasp_results);
+  }
+
   feedback.total_grasps = grasps.size();
   feedback.current_grasp = 0;
   action_server->publishFeedback(feedback);
@@ -198,14 +291,59 @@ void ObjectManipulator::pickup(const PickupGoal::ConstPtr &pickup_goal,
     ROS_INFO("Randomizing grasps");
     std::random_shuffle(grasps.begin(), grasps.end());
   }
+  //try the grasps the arm can reach most easily first
+  else if (sort_by_reachability_ && grasps.size() > 1 && 
+           mechInterface().getReachabilityMap(pickup_goal->arm_name))
+  {
+    try
+    {
+      MechanismInterface::ScopedTransformSnapshot transform_snapshot(mechInterface());
+      std::vector<double> reachability;
+      geometry_msgs::PoseStamped grasp_pose;
+      grasp_pose.header.frame_id = pickup_goal->target.reference_frame_id;
+      grasp_pose.header.stamp = ros::Time(0);
+      for (size_t i=0; i<grasps.size(); i++)
+      {
+        double grasp_reachability, manipulability;
+        grasp_pose.pose = grasps[i].grasp_pose;
+        mechInterface().getReachability(pickup_goal->arm_name, grasp_pose, grasp_reachability, manipulability);
+        reachability.push_back(grasp_reachability);
+      }
+      applyOrder(reachabilityOrder(reachability, reachability_band_), grasps);
+    }
+    catch (MechanismException &ex)
+    {
+      ROS_WARN("Grasps not sorted by reachability: %s", ex.what());
+    }
+  }
 
   //PROF_RESET_ALL;
   //PROF_START_TIMER(TOTAL_PICKUP_TIMER);
 
+  //start checking grasp feasibility in the background; the checks are done by executors of the
+  //same type as the one we use here, so they can also be used to execute the grasps they prepared
+  //feasibility tests are instead done for the whole list at once, using batched interpolated IK
+  bool check_all_grasps = pickup_goal->only_perform_feasibility_test && executor == grasp_executor_with_approach_ &&
+    grasps.size() > 1;
+  std::vector<GraspResult> checked_grasp_results;
+  GraspFeasibilityEvaluator *evaluator = NULL;
+  if (feasibility_evaluator_ && executor == grasp_executor_with_approach_ && grasps.size() > 1 && !check_all_grasps)
+  {
+    evaluator = feasibility_evaluator_;
+    evaluator->start(*pickup_goal, grasps);
+  }
+  FeasibilityCheckGuard<GraspFeasibilityEvaluator> feasibility_check_guard(evaluator);
+  bool speculating = false;
+
   //try the grasps in the list until one succeeds
   result.manipulation_result.value = ManipulationResult::UNFEASIBLE;
   try
   {
+    if (check_all_grasps)
+    {
+      MechanismInterface::ScopedTransformSnapshot transform_snapshot(mechInterface());
+      grasp_executor_with_approach_->checkGraspsFeasibility(*pickup_goal, grasps, checked_grasp_results);
+    }
     for (size_t i=0; i<grasps.size(); i++)
     {
       if (action_server->isPreemptRequested())
@@ -215,7 +353,38 @@ void ObjectManipulator::pickup(const PickupGoal::ConstPtr &pickup_goal,
       }
       feedback.current_grasp = i+1;
       action_server->publishFeedback(feedback);
-      GraspResult grasp_result = executor->checkAndExecuteGrasp(*pickup_goal, grasps[i]);
+      //once a grasp has been executed, the background checks only go a few grasps ahead
+      if (speculating) evaluator->setLimit(i + speculative_grasp_lookahead_);
+      GraspResult grasp_result;
+      bool checked;
+      if (i < checked_grasp_results.size())
+      {
+        grasp_result = checked_grasp_results[i];
+        checked = true;
+      }
+      else checked = evaluator && evaluator->waitForResult(i, grasp_result) == GraspFeasibilityEvaluator::DONE;
+      if (!checked || 
+          (grasp_result.result_code == GraspResult::SUCCESS && !pickup_goal->only_perform_feasibility_test))
+      {
+        if (evaluator && !pickup_goal->only_perform_feasibility_test) 
+        {
+          //while the robot is moving, either keep preparing the next few grasps in case this one 
+          //fails, or stop checking altogether; in the latter case the remaining grasps are then 
+          //checked here, one at a time
+          speculating = speculative_grasp_lookahead_ > 0;
+          if (speculating) evaluator->setLimit(i + 1 + speculative_grasp_lookahead_);
+          else evaluator->stop();
+        }
+        boost::scoped_ptr<GraspExecutor> prepared_executor;
+        if (checked && evaluator) prepared_executor.reset(evaluator->takePreparedExecutor(i));
+        if (prepared_executor) 
+        {
+          ROS_DEBUG_NAMED("manipulation","Executing grasp %d using the trajectories prepared in the background", 
+                          (int)i+1);
+          grasp_result = prepared_executor->executePreparedGrasp(*pickup_goal, grasps[i]);
+        }
+        else grasp_result = executor->checkAndExecuteGrasp(*pickup_goal, grasps[i]);
+      }
       ROS_INFO_STREAM("Grasp " << i+1 << "/" << grasps.size() << " result: " << getGraspResultInfo(grasp_result));
       ROS_DEBUG_NAMED("manipulation","Grasp result code: %d; continuation: %d", 
                       grasp_result.result_code, grasp_result.continuation_possible);
@@ -292,14 +461,54 @@ void ObjectManipulator::place(const object_manipulation_msgs::PlaceGoal::ConstPt
     executor = place_executor_;
   }
 
-  feedback.total_locations = place_goal->place_locations.size();
+  //try the locations the arm can reach most easily first
+  std::vector<geometry_msgs::PoseStamped> place_locations = place_goal->place_locations;
+  if (sort_by_reachability_ && place_locations.size() > 1 && 
+      mechInterface().getReachabilityMap(place_goal->arm_name))
+  {
+    try
+    {
+      std::vector<double> reachability;
+      tf::Transform grasp_trans;
+      tf::poseMsgToTF(place_goal->grasp.grasp_pose, grasp_trans);
+      for (size_t i=0; i<place_locations.size(); i++)
+      {
+        tf::Transform place_trans;
+        tf::poseMsgToTF(place_locations[i].pose, place_trans);
+        geometry_msgs::PoseStamped gripper_pose;
+        gripper_pose.header.frame_id = place_locations[i].header.frame_id;
+        gripper_pose.header.stamp = ros::Time(0);
+        tf::poseTFToMsg(place_trans * grasp_trans, gripper_pose.pose);
+        double location_reachability, manipulability;
+        mechInterface().getReachability(place_goal->arm_name, gripper_pose, location_reachability, manipulability);
+        reachability.push_back(location_reachability);
+      }
+      applyOrder(reachabilityOrder(reachability, reachability_band_), place_locations);
+    }
+    catch (MechanismException &ex)
+    {
+      ROS_WARN("Place locations not sorted by reachability: %s", ex.what());
+    }
+  }
+
+  feedback.total_locations = place_locations.size();
   feedback.current_location = 0;
   action_server->publishFeedback(feedback);
 
+  //check the locations in the background, while the ones before them are being tried; the
+  //reactive executor has its own way of placing, so its locations are checked here, one at a time
+  PlaceFeasibilityEvaluator *evaluator = NULL;
+  if (place_feasibility_evaluator_ && executor == place_executor_ && place_locations.size() > 1)
+  {
+    evaluator = place_feasibility_evaluator_;
+    evaluator->start(*place_goal, place_locations);
+  }
+  FeasibilityCheckGuard<PlaceFeasibilityEvaluator> feasibility_check_guard(evaluator);
+
   try
   {
     result.manipulation_result.value = ManipulationResult::UNFEASIBLE;
-    for (size_t i=0; i<place_goal->place_locations.size(); i++)
+    for (size_t i=0; i<place_locations.size(); i++)
     {
       if (action_server->isPreemptRequested())
       {
@@ -308,20 +517,48 @@ void ObjectManipulator::place(const object_manipulation_msgs::PlaceGoal::ConstPt
       }
       feedback.current_location = i+1;
       action_server->publishFeedback(feedback);
-      geometry_msgs::PoseStamped place_location = place_goal->place_locations[i];
-      PlaceLocationResult location_result = executor->place(*place_goal, place_location);
-      ROS_INFO_STREAM("Place " << i+1 << "/" << place_goal->place_locations.size() << " result: " << 
-                      getPlaceLocationResultInfo(location_result));
+      geometry_msgs::PoseStamped place_location = place_locations[i];
+      PlaceLocationResult location_result;
+      ros::WallDuration check_time;
+      bool checked = evaluator && 
+        evaluator->waitForResult(i, location_result, check_time) == PlaceFeasibilityEvaluator::DONE;
+      if (!checked)
+      {
+        ros::WallTime check_start = ros::WallTime::now();
+        location_result = executor->checkPlaceFeasibility(*place_goal, place_location);
+        check_time = ros::WallTime::now() - check_start;
+      }
+      ROS_DEBUG_NAMED("manipulation","Place location %d feasibility: %s (checked in %.1f ms%s)", (int)i+1, 
+                      getPlaceLocationResultInfo(location_result).c_str(), check_time.toSec() * 1.0e3,
+                      checked ? ", in the background" : "");
+      if (location_result.result_code == PlaceLocationResult::SUCCESS && !place_goal->only_perform_feasibility_test)
+      {
+        //no more checks while the robot is moving
+        if (evaluator) evaluator->stop();
+        boost::scoped_ptr<PlaceExecutor> prepared_executor;
+        if (checked) prepared_executor.reset(evaluator->takePreparedExecutor(i));
+        if (prepared_executor)
+        {
+          ROS_DEBUG_NAMED("manipulation","Placing at location %d using the trajectories prepared in the background", 
+                          (int)i+1);
+          location_result = prepared_executor->executePreparedPlace(*place_goal, place_location);
+        }
+        else if (checked) location_result = executor->place(*place_goal, place_location);
+        else location_result = executor->executePreparedPlace(*place_goal, place_location);
+      }
+      ROS_INFO_STREAM("Place " << i+1 << "/" << place_locations.size() << " result: " << 
+                      getPlaceLocationResultInfo(location_result) << " (feasibility checked in " << 
+                      check_time.toSec() * 1.0e3 << " ms)");
       ROS_DEBUG_NAMED("manipulation","Place location result code: %d; continuation: %d", location_result.result_code, 
 	       location_result.continuation_possible);
-      result.attempted_locations.push_back(place_goal->place_locations[i]);
+      result.attempted_locations.push_back(place_locations[i]);
       result.attempted_location_results.push_back(location_result);
       if (location_result.result_code == PlaceLocationResult::SUCCESS)
       {
 	result.manipulation_result.value = ManipulationResult::SUCCESS;
 	if (!place_goal->only_perform_feasibility_test)
 	{
-	  result.place_location = place_goal->place_locations[i];
+	  result.place_location = place_locations[i];
 	  action_server->setSucceeded(result);
 	  return;
 	}
@@ -332,7 +569,7 @@ void ObjectManipulator::place(const object_manipulation_msgs::PlaceGoal::ConstPt
 	{
 	  ROS_ERROR("Continuation impossible when performing feasibility test");
 	}
-	result.place_location = place_goal->place_locations[i];
+	result.place_location = place_locations[i];
 	if (location_result.result_code == PlaceLocationResult::RETREAT_FAILED)
 	  result.manipulation_result.value = ManipulationResult::RETREAT_FAILED;
 	else
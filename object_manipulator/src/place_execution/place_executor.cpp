@@ -56,36 +56,11 @@ geometry_msgs::PoseStamped PlaceExecutor::computeGripperPose(geometry_msgs::Pose
   grasp_trans = place_trans * grasp_trans;
 
   //get it in the requested frame
-  tf::Stamped<tf::Pose> grasp_trans_stamped;
-  grasp_trans_stamped.setData(grasp_trans);
-  grasp_trans_stamped.frame_id_ = place_location.header.frame_id;
-  grasp_trans_stamped.stamp_ = ros::Time::now();
-  if (!listener_.waitForTransform(frame_id, place_location.header.frame_id, ros::Time::now(), ros::Duration(1.0)))
-  {
-    ROS_ERROR("Object place: tf does not have transform from %s to %s", 
-	      place_location.header.frame_id.c_str(),
-	      frame_id.c_str());
-    throw MechanismException( std::string("Object place: tf does not have transform from ") + 
-			      place_location.header.frame_id.c_str() + std::string(" to ") + 
-			      frame_id);
-  }
-  tf::Stamped<tf::Pose> grasp_trans_base;
-  try
-  {
-    listener_.transformPose( frame_id, grasp_trans_stamped, grasp_trans_base);
-  }
-  catch (tf::TransformException ex)
-  {
-    ROS_ERROR("Object place: tf failed to transform gripper pose into frame %s; exception: %s", 
-	      frame_id.c_str(), ex.what());
-    throw MechanismException( std::string("tf failed to transform gripper pose into frame ") + 
-			      frame_id + std::string("; tf exception: ") +  
-			      std::string(ex.what()) );
-  }
-  
   geometry_msgs::PoseStamped gripper_pose;
-  tf::poseTFToMsg(grasp_trans_base, gripper_pose.pose);
-  gripper_pose.header.frame_id = frame_id;
+  tf::poseTFToMsg(grasp_trans, gripper_pose.pose);
+  gripper_pose.header.frame_id = place_location.header.frame_id;
+  gripper_pose.header.stamp = ros::Time(0);
+  gripper_pose = mechInterface().transformPose(frame_id, gripper_pose);
   gripper_pose.header.stamp = ros::Time::now();
   return gripper_pose;
 }
@@ -336,8 +311,15 @@ PlaceLocationResult PlaceExecutor::place(const object_manipulation_msgs::PlaceGo
   //demo_synchronizer::getClient().rviz(1, "Collision models;IK contacts;Interpolated IK;Grasp execution");
 
   //compute interpolated trajectories
-  PlaceLocationResult result = prepareInterpolatedTrajectories(place_goal, place_location);
+  PlaceLocationResult result = checkPlaceFeasibility(place_goal, place_location);
   if (result.result_code != PlaceLocationResult::SUCCESS || place_goal.only_perform_feasibility_test) return result;
+  return executePreparedPlace(place_goal, place_location);
+}
+
+PlaceLocationResult PlaceExecutor::executePreparedPlace(const object_manipulation_msgs::PlaceGoal &place_goal,
+                                                        const geometry_msgs::PoseStamped &place_location)
+{
+  PlaceLocationResult result;
 
   //demo_synchronizer::getClient().sync(2, "Using motion planner to move arm to pre-place location");
   //demo_synchronizer::getClient().rviz(1, "Collision models;Planning goal;Environment contacts;Collision map");
@@ -458,6 +440,8 @@ ReactivePlaceExecutor::placeApproach(const object_manipulation_msgs::PlaceGoal &
   //give the reactive place 1 minute to do its thing
   ros::Duration timeout = ros::Duration(60.0);
   ROS_DEBUG_NAMED("manipulation"," Calling the reactive place action");
+  //the reactive actions use the joint controllers
+  mechInterface().finishDeferredSwitchToJoint(place_goal.arm_name);
   mechInterface().reactive_place_action_client_.client(place_goal.arm_name).sendGoal(reactive_place_goal);
   if ( !mechInterface().reactive_place_action_client_.client(place_goal.arm_name).waitForResult(timeout) )
   {
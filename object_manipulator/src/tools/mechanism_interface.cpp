@@ -32,6 +32,15 @@
 *********************************************************************/
 
 #include "object_manipulator/tools/mechanism_interface.h"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <planning_environment/models/collision_models_interface.h>
+#include <planning_models/kinematic_state.h>
+
 #include "object_manipulator/tools/hand_description.h"
 #include "object_manipulator/tools/exceptions.h"
 
@@ -46,6 +55,7 @@ static const std::string IK_SERVICE_SUFFIX = "/constraint_aware_ik";
 static const std::string FK_SERVICE_SUFFIX = "/get_fk";
 static const std::string INTERPOLATED_IK_SERVICE_SUFFIX = "/interpolated_ik";
 static const std::string INTERPOLATED_IK_SET_PARAMS_SERVICE_SUFFIX = "/interpolated_ik_set_params";
+static const std::string INTERPOLATED_IK_BATCH_SERVICE_SUFFIX = "/interpolated_ik_batch";
 static const std::string IK_QUERY_SERVICE_SUFFIX = "/get_ik_solver_info";
 static const std::string GRASP_STATUS_SUFFIX = "/grasp_status";
 
@@ -79,16 +89,30 @@ static const double OBJECT_POSITION_TOLERANCE_X = 0.02;
 static const double OBJECT_POSITION_TOLERANCE_Y = 0.02;
 static const double OBJECT_POSITION_TOLERANCE_Z = 0.02;
 
+//hard-coded for now
+static const int INTERPOLATED_IK_COLLISION_CHECK_RESOLUTION = 2;
+
 MechanismInterface::MechanismInterface() : 
   root_nh_(""),priv_nh_("~"),
-  planning_scene_cache_empty_(true),
+  joint_state_hits_(0),
+  joint_state_misses_(0),
+  controller_state_max_age_(0),
+  cartesian_switch_back_delay_(0),
+  deferred_switch_generation_(0),
   cache_planning_scene_(true),
+  planning_scene_gate_(boost::bind(&MechanismInterface::comparePlanningScenes, this, _1, _2),
+                       boost::bind(&MechanismInterface::setPlanningScene, this, _1)),
+  interpolated_ik_params_gate_(&MechanismInterface::compareInterpolatedIKParams,
+                               boost::bind(&MechanismInterface::setInterpolatedIKParams, this, _1)),
+  local_scene_updates_(0),
+  local_scene_valid_(false),
   //------------------- multi arm service clients -----------------------
   ik_query_client_("", IK_QUERY_SERVICE_SUFFIX, true),
   ik_service_client_("", IK_SERVICE_SUFFIX, true),
   fk_service_client_("",FK_SERVICE_SUFFIX,true),
   interpolated_ik_service_client_("", INTERPOLATED_IK_SERVICE_SUFFIX, true),
   interpolated_ik_set_params_client_("", INTERPOLATED_IK_SET_PARAMS_SERVICE_SUFFIX, true),
+  interpolated_ik_batch_service_client_("", INTERPOLATED_IK_BATCH_SERVICE_SUFFIX, true),
   grasp_status_client_("", GRASP_STATUS_SUFFIX, true),
   //------------------- simple service clients -----------------------
   check_state_validity_client_(CHECK_STATE_VALIDITY_NAME),
@@ -116,7 +140,95 @@ MechanismInterface::MechanismInterface() :
 
   //JointStates topic for current arm angles
   priv_nh_.param<std::string>("joint_states_topic", joint_states_topic_, "joint_states");
+  //a negative value disables the cache, and the robot state is always requested; disabled by default,
+  //as a cached robot state only has the joint positions, without the rest of the robot state
+  priv_nh_.param<double>("joint_state_max_age", joint_state_max_age_, -1.0);
+  if (joint_state_max_age_ >= 0)
+  {
+    joint_states_sub_ = root_nh_.subscribe(joint_states_topic_, 1, &MechanismInterface::jointStatesCallback, this);
+  }
+
+  //how long the known state of the controllers can be relied on before it is queried again
+  priv_nh_.param<double>("controller_state_max_age", controller_state_max_age_, 5.0);
+  //how long to stay in Cartesian control after a Cartesian move, in case another one follows
+  priv_nh_.param<double>("cartesian_switch_back_delay", cartesian_switch_back_delay_, 0.0);
+
+  //whether trajectories can be unnormalized here instead of calling the normalizer service
+  priv_nh_.param<bool>("local_unnormalization", local_unnormalization_, false);
+
+  //whether several interpolated IK requests can be sent to the server in a single call
+  //off by default, as older interpolated IK servers do not offer the batch service
+  priv_nh_.param<bool>("use_interpolated_ik_batch", use_interpolated_ik_batch_, false);
+
+  //check state validity against a local mirror of the planning scene instead of calling the service
+  bool local_collision_checking;
+  priv_nh_.param<bool>("local_collision_checking", local_collision_checking, false);
+  if (local_collision_checking)
+  {
+    //registers with the environment server, which will send us every new planning scene
+    collision_models_.reset(new planning_environment::CollisionModelsInterface("robot_description"));
+    collision_models_->addSetPlanningSceneCallback(boost::bind(&MechanismInterface::localSceneUpdated, this));
+  }
+
+  //keep the connections to the services we call most often open between calls
+  bool persistent_connections;
+  priv_nh_.param<bool>("persistent_service_connections", persistent_connections, false);
+  if (persistent_connections)
+  {
+    ik_query_client_.setPersistent(true);
+    ik_service_client_.setPersistent(true);
+    fk_service_client_.setPersistent(true);
+    interpolated_ik_service_client_.setPersistent(true);
+    interpolated_ik_set_params_client_.setPersistent(true);
+    interpolated_ik_batch_service_client_.setPersistent(true);
+    check_state_validity_client_.setPersistent(true);
+    joint_trajectory_normalizer_service_.setPersistent(true);
+    get_robot_state_client_.setPersistent(true);
+    set_planning_scene_diff_service_.setPersistent(true);
+  }
+
+}
+
+//! Logs the statistics of all the services called through a multi-arm wrapper
+template <class ServiceDataType>
+static void logServiceCallStatistics(MultiArmServiceWrapper<ServiceDataType> &wrapper)
+{
+  std::map<std::string, ServiceCallStatistics> statistics = wrapper.statistics();
+  for (std::map<std::string, ServiceCallStatistics>::const_iterator it = statistics.begin(); 
+       it != statistics.end(); it++)
+  {
+    ROS_INFO("  %s: %s", it->first.c_str(), it->second.toString().c_str());
+  }
+}
+
+//! Logs the statistics of the service called through a wrapper, if it has been used
+template <class ServiceDataType>
+static void logServiceCallStatistics(std::string name, ServiceWrapper<ServiceDataType> &wrapper)
+{
+  ServiceCallStatistics statistics = wrapper.statistics();
+  if (statistics.calls) ROS_INFO("  %s: %s", name.c_str(), statistics.toString().c_str());
+}
 
+void MechanismInterface::logServiceCallStatistics()
+{
+  ROS_INFO("Mechanism interface service call statistics:");
+  unsigned int hits, misses;
+  planning_scene_gate_.getStatistics(hits, misses);
+  ROS_INFO("  planning scene cache: %u hits, %u misses", hits, misses);
+  {
+    boost::mutex::scoped_lock lock(joint_state_mutex_);
+    ROS_INFO("  joint state cache: %u hits, %u misses", joint_state_hits_, joint_state_misses_);
+  }
+  object_manipulator::logServiceCallStatistics(ik_query_client_);
+  object_manipulator::logServiceCallStatistics(ik_service_client_);
+  object_manipulator::logServiceCallStatistics(fk_service_client_);
+  object_manipulator::logServiceCallStatistics(interpolated_ik_service_client_);
+  object_manipulator::logServiceCallStatistics(interpolated_ik_set_params_client_);
+  object_manipulator::logServiceCallStatistics(interpolated_ik_batch_service_client_);
+  object_manipulator::logServiceCallStatistics(CHECK_STATE_VALIDITY_NAME, check_state_validity_client_);
+  object_manipulator::logServiceCallStatistics(NORMALIZE_SERVICE_NAME, joint_trajectory_normalizer_service_);
+  object_manipulator::logServiceCallStatistics(GET_ROBOT_STATE_NAME, get_robot_state_client_);
+  object_manipulator::logServiceCallStatistics(SET_PLANNING_SCENE_DIFF_NAME, set_planning_scene_diff_service_);
 }
 
 /*! For now, just calls the IK Info service each time. In the future, we might do some
@@ -126,7 +238,7 @@ std::vector<std::string> MechanismInterface::getJointNames(std::string arm_name)
 {
   kinematics_msgs::GetKinematicSolverInfo::Request query_request;
   kinematics_msgs::GetKinematicSolverInfo::Response query_response;  
-  if ( !ik_query_client_.client(arm_name).call(query_request, query_response) ) 
+  if ( !ik_query_client_.call(arm_name, query_request, query_response) ) 
   {
     ROS_ERROR("Failed to call ik information query");
     throw MechanismException("Failed to call ik information query");
@@ -134,11 +246,87 @@ std::vector<std::string> MechanismInterface::getJointNames(std::string arm_name)
   return query_response.kinematic_solver_info.joint_names;
 }
 
+void MechanismInterface::jointStatesCallback(const sensor_msgs::JointState::ConstPtr &joint_state)
+{
+  if (joint_state->position.size() != joint_state->name.size()) return;
+  boost::mutex::scoped_lock lock(joint_state_mutex_);
+  for (size_t i=0; i<joint_state->name.size(); i++)
+  {
+    joint_positions_[joint_state->name[i]] = std::make_pair(joint_state->position[i], joint_state->header.stamp);
+  }
+  last_joint_state_.reset();
+}
+
+/*! The message is only assembled once for all the callers in between two JointState messages, and
+  callers only share a pointer to it. 
+
+  If \a joint_names is empty, all the joints must be recent enough; otherwise, only the ones 
+  listed, so that joints published by a slower (or stopped) publisher do not cause a miss for 
+  callers that do not need them. */
+sensor_msgs::JointState::ConstPtr 
+MechanismInterface::getRecentJointState(const std::vector<std::string> &joint_names)
+{
+  boost::mutex::scoped_lock lock(joint_state_mutex_);
+  if (!last_joint_state_ && !joint_positions_.empty())
+  {
+    sensor_msgs::JointState::Ptr joint_state(new sensor_msgs::JointState());
+    joint_state->header.stamp = joint_positions_.begin()->second.second;
+    for (std::map<std::string, std::pair<double, ros::Time> >::const_iterator it = joint_positions_.begin();
+         it != joint_positions_.end(); it++)
+    {
+      joint_state->name.push_back(it->first);
+      joint_state->position.push_back(it->second.first);
+      if (it->second.second < joint_state->header.stamp) joint_state->header.stamp = it->second.second;
+    }
+    last_joint_state_ = joint_state;
+  }
+  if (!last_joint_state_)
+  {
+    joint_state_misses_++;
+    return sensor_msgs::JointState::ConstPtr();
+  }
+  ros::Time oldest = last_joint_state_->header.stamp;
+  if (!joint_names.empty())
+  {
+    oldest = ros::TIME_MAX;
+    for (size_t i=0; i<joint_names.size(); i++)
+    {
+      std::map<std::string, std::pair<double, ros::Time> >::const_iterator it = joint_positions_.find(joint_names[i]);
+      if (it == joint_positions_.end())
+      {
+        oldest = ros::Time(0);
+        break;
+      }
+      if (it->second.second < oldest) oldest = it->second.second;
+    }
+  }
+  if (ros::Time::now() - oldest <= ros::Duration(joint_state_max_age_))
+  {
+    joint_state_hits_++;
+    return last_joint_state_;
+  }
+  joint_state_misses_++;
+  return sensor_msgs::JointState::ConstPtr();
+}
+
 void MechanismInterface::getRobotState(arm_navigation_msgs::RobotState& robot_state)
 {
+  getRobotState(robot_state, std::vector<std::string>());
+}
+
+void MechanismInterface::getRobotState(arm_navigation_msgs::RobotState& robot_state,
+                                       const std::vector<std::string> &joint_names)
+{
+  sensor_msgs::JointState::ConstPtr joint_state = getRecentJointState(joint_names);
+  if (joint_state)
+  {
+    robot_state = arm_navigation_msgs::RobotState();
+    robot_state.joint_state = *joint_state;
+    return;
+  }
   arm_navigation_msgs::GetRobotState::Request req;
   arm_navigation_msgs::GetRobotState::Response res;  
-  if(!get_robot_state_client_.client().call(req,res)) 
+  if(!get_robot_state_client_.call(req,res)) 
   {
     ROS_ERROR("Mechanism interface: can't get current robot state");
     throw MechanismException("Mechanism interface: can't get current robot state");
@@ -173,62 +361,103 @@ bool compareLinkPadding(const std::vector<arm_navigation_msgs::LinkPadding> &l1,
   return true;
 }
 
-bool MechanismInterface::cachePlanningScene(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
-                                            const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
+MechanismInterface::PlanningSceneState 
+MechanismInterface::planningSceneState(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
+                                       const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
+{
+  PlanningSceneState state;
+  state.collision_operations = collision_operations;
+  state.link_padding = link_padding;
+  //hash the same fields that comparePlanningScenes looks at
+  state.hash = 0;
+  for (size_t i=0; i<collision_operations.collision_operations.size(); i++)
+  {
+    const arm_navigation_msgs::CollisionOperation &op = collision_operations.collision_operations[i];
+    boost::hash_combine(state.hash, op.object1);
+    boost::hash_combine(state.hash, op.object2);
+    boost::hash_combine(state.hash, op.penetration_distance);
+    boost::hash_combine(state.hash, op.operation);
+  }
+  for (size_t i=0; i<link_padding.size(); i++)
+  {
+    boost::hash_combine(state.hash, link_padding[i].link_name);
+    boost::hash_combine(state.hash, link_padding[i].padding);
+  }
+  return state;
+}
+
+bool MechanismInterface::comparePlanningScenes(const PlanningSceneState &s1, const PlanningSceneState &s2)
 {
-  static int cache_hits = 0;
-  static int total_hits = 0;
-  total_hits++;
   if (!cache_planning_scene_) 
   {
     ROS_DEBUG_NAMED("manipulation","Planning scene caching disabled");
-    collision_operations_cache_ = collision_operations;
-    link_padding_cache_ = link_padding;
     return false;
   }
-  if (planning_scene_cache_empty_)
+  //different hashes mean different scenes; equal hashes still need to be checked in full
+  if (s1.hash != s2.hash)
   {
-    ROS_DEBUG_NAMED("manipulation","Planning scene cache empty.");
-    collision_operations_cache_ = collision_operations;
-    link_padding_cache_ = link_padding;
-    planning_scene_cache_empty_ = false;
+    ROS_DEBUG_NAMED("manipulation","Planning scene cache miss - hash.");
     return false;
   }
-  if (!compareOrderedCollisionOperations(collision_operations, collision_operations_cache_))
+  if (!compareOrderedCollisionOperations(s1.collision_operations, s2.collision_operations))
   {
-    ROS_DEBUG_NAMED("manipulation","Planning scene cache miss - collisions (hits: %d/%d).", cache_hits, total_hits);
-    collision_operations_cache_ = collision_operations;
-    link_padding_cache_ = link_padding;
+    ROS_DEBUG_NAMED("manipulation","Planning scene cache miss - collisions.");
     return false;
   }
-  if (!compareLinkPadding(link_padding, link_padding_cache_))
+  if (!compareLinkPadding(s1.link_padding, s2.link_padding))
   {
-    ROS_DEBUG_NAMED("manipulation","Planning scene cache miss - padding (hits: %d/%d).", cache_hits, total_hits);
-    collision_operations_cache_ = collision_operations;
-    link_padding_cache_ = link_padding;
+    ROS_DEBUG_NAMED("manipulation","Planning scene cache miss - padding.");
     return false;
   }
-  cache_hits++;
-  ROS_DEBUG_NAMED("manipulation", "Planning scene cache hit (hits: %d/%d).", cache_hits, total_hits);
+  ROS_DEBUG_NAMED("manipulation", "Planning scene cache hit.");
   return true;
 }
-  
-void MechanismInterface::getPlanningScene(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
-                                          const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
+
+void MechanismInterface::localSceneUpdated()
 {
-  if (cachePlanningScene(collision_operations, link_padding)) return;
+  boost::mutex::scoped_lock lock(local_scene_mutex_);
+  local_scene_updates_++;
+}
+
+/*! The environment server sends the new planning scene to all registered mirrors before it 
+  responds, so if the mirror has not received anything by the time the call returns, it has 
+  missed this scene and can not be used until the next one. */
+void MechanismInterface::setPlanningScene(const PlanningSceneState &state)
+{
+  unsigned int local_scene_updates;
+  {
+    boost::mutex::scoped_lock lock(local_scene_mutex_);
+    local_scene_valid_ = false;
+    local_scene_updates = local_scene_updates_;
+  }
   arm_navigation_msgs::SetPlanningSceneDiff::Request planning_scene_req;
-  planning_scene_req.planning_scene_diff.link_padding = link_padding;
-  planning_scene_req.operations = collision_operations;
+  planning_scene_req.planning_scene_diff.link_padding = state.link_padding;
+  planning_scene_req.operations = state.collision_operations;
   arm_navigation_msgs::SetPlanningSceneDiff::Response planning_scene_res;  
   //PROF_COUNT(SET_PLANNING_SCENE);
   //PROF_START_TIMER(SET_PLANNING_SCENE);
-  if(!set_planning_scene_diff_service_.client().call(planning_scene_req, planning_scene_res)) 
+  if(!set_planning_scene_diff_service_.call(planning_scene_req, planning_scene_res)) 
   {
     ROS_ERROR("Failed to set planning scene diff");
     throw MechanismException("Failed to set planning scene diff");
   }
   //PROF_STOP_TIMER(SET_PLANNING_SCENE);
+  if (collision_models_)
+  {
+    boost::mutex::scoped_lock lock(local_scene_mutex_);
+    local_scene_valid_ = (local_scene_updates_ != local_scene_updates);
+    if (!local_scene_valid_)
+    {
+      ROS_WARN("Local planning scene mirror was not updated; using the state validity service instead");
+    }
+  }
+}
+
+void MechanismInterface::getPlanningScene(const arm_navigation_msgs::OrderedCollisionOperations& collision_operations,
+                                          const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
+{
+  ServerStateGate<PlanningSceneState>::ScopedHolder scene(planning_scene_gate_, 
+                                                          planningSceneState(collision_operations, link_padding));
 }
 
 trajectory_msgs::JointTrajectory MechanismInterface::assembleJointTrajectory(std::string arm_name, 
@@ -265,15 +494,96 @@ void MechanismInterface::attemptTrajectory(std::string arm_name,
 }
 
 
+/*! The mutex is not held during the query, so that callers for other arms, or for an arm that has 
+  already been queried, do not wait on the service. Several threads might query the same arm at
+  first; they all get the same answer. */
+std::vector<std::string> MechanismInterface::getContinuousJoints(std::string arm_name)
+{
+  {
+    boost::mutex::scoped_lock lock(continuous_joints_mutex_);
+    std::map<std::string, std::vector<std::string> >::iterator it = continuous_joints_.find(arm_name);
+    if (it != continuous_joints_.end()) return it->second;
+  }
+
+  kinematics_msgs::GetKinematicSolverInfo::Request query_request;
+  kinematics_msgs::GetKinematicSolverInfo::Response query_response;  
+  if ( !ik_query_client_.call(arm_name, query_request, query_response) ) 
+  {
+    ROS_ERROR("Failed to call ik information query");
+    throw MechanismException("Failed to call ik information query");
+  }
+  std::vector<std::string> continuous_joints;
+  const std::vector<arm_navigation_msgs::JointLimits> &limits = query_response.kinematic_solver_info.limits;
+  for (size_t i=0; i<limits.size(); i++)
+  {
+    if (!limits[i].has_position_limits) continuous_joints.push_back(limits[i].joint_name);
+  }
+  boost::mutex::scoped_lock lock(continuous_joints_mutex_);
+  continuous_joints_[arm_name] = continuous_joints;
+  return continuous_joints;
+}
+
+//! Returns the angle in [-pi, pi] that takes from one joint value to another
+static double shortestAngularDistance(double from, double to)
+{
+  double distance = fmod(to - from, 2.0 * M_PI);
+  if (distance > M_PI) distance -= 2.0 * M_PI;
+  else if (distance < -M_PI) distance += 2.0 * M_PI;
+  return distance;
+}
+
+/*! Each continuous joint is moved by the shortest angle from its previous value, starting from its
+  current value, which is what the trajectory normalizer service does as well. */
+bool MechanismInterface::unnormalizeTrajectoryLocal(std::string arm_name, 
+                                                    const trajectory_msgs::JointTrajectory &input_trajectory,
+                                                    trajectory_msgs::JointTrajectory &normalized_trajectory)
+{
+  std::vector<std::string> continuous_joints = getContinuousJoints(arm_name);
+  arm_navigation_msgs::RobotState robot_state;
+  getRobotState(robot_state, continuous_joints);
+  trajectory_msgs::JointTrajectory trajectory = input_trajectory;
+  for (size_t j=0; j<trajectory.joint_names.size(); j++)
+  {
+    if (std::find(continuous_joints.begin(), continuous_joints.end(), trajectory.joint_names[j]) == 
+        continuous_joints.end()) continue;
+    size_t k;
+    for (k=0; k<robot_state.joint_state.name.size(); k++)
+    {
+      if (robot_state.joint_state.name[k] == trajectory.joint_names[j]) break;
+    }
+    if (k == robot_state.joint_state.name.size() || k >= robot_state.joint_state.position.size()) 
+    {
+      ROS_WARN("Mechanism interface: current position of joint %s unknown, can not unnormalize trajectory",
+               trajectory.joint_names[j].c_str());
+      return false;
+    }
+    double previous_position = robot_state.joint_state.position[k];
+    for (size_t i=0; i<trajectory.points.size(); i++)
+    {
+      if (trajectory.points[i].positions.size() <= j)
+      {
+        throw MechanismException("Malformed trajectory passed to unnormalizeTrajectory");
+      }
+      double &position = trajectory.points[i].positions[j];
+      position = previous_position + shortestAngularDistance(previous_position, position);
+      previous_position = position;
+    }
+  }
+  normalized_trajectory = trajectory;
+  return true;
+}
+
 void MechanismInterface::unnormalizeTrajectory(std::string arm_name, 
 					   const trajectory_msgs::JointTrajectory &input_trajectory,
 					   trajectory_msgs::JointTrajectory &normalized_trajectory)
 {    
+  if (local_unnormalization_ && 
+      unnormalizeTrajectoryLocal(arm_name, input_trajectory, normalized_trajectory)) return;
   arm_navigation_msgs::FilterJointTrajectory service_call;
   getRobotState(service_call.request.start_state);
   service_call.request.trajectory = input_trajectory;
   service_call.request.allowed_time = ros::Duration(2.0);
-  if ( !joint_trajectory_normalizer_service_.client().call(service_call) )
+  if ( !joint_trajectory_normalizer_service_.call(service_call) )
   {
     ROS_ERROR("Mechanism interface: joint trajectory normalizer service call failed");
     throw MechanismException("joint trajectory normalizer service call failed");
@@ -295,6 +605,8 @@ void MechanismInterface::attemptTrajectory(std::string arm_name,
   //make sure joint controllers are running
   //if(!checkController(jointControllerName(arm_name)))
   //   switchToJoint(arm_name);
+  //the joint controllers could only be stopped by a Cartesian move that has not switched back yet
+  finishDeferredSwitchToJoint(arm_name);
 
   pr2_controllers_msgs::JointTrajectoryGoal goal;
   if (unnormalize)
@@ -319,25 +631,30 @@ void MechanismInterface::attemptTrajectory(std::string arm_name,
   }
 }
 
-void MechanismInterface::setInterpolatedIKParams(std::string arm_name, int num_steps,
-						 int collision_check_resolution, bool start_from_end)
+void MechanismInterface::setInterpolatedIKParams(const InterpolatedIKParams &params)
 {
   interpolated_ik_motion_planner::SetInterpolatedIKMotionPlanParams srv;
-  srv.request.num_steps = num_steps;
+  srv.request.num_steps = params.num_steps;
   srv.request.consistent_angle = M_PI/6;
-  srv.request.collision_check_resolution = collision_check_resolution;
+  srv.request.collision_check_resolution = params.collision_check_resolution;
   srv.request.steps_before_abort = 0;
   srv.request.pos_spacing = 0.01; //ignored if num_steps !=0
   srv.request.rot_spacing = 0.1;  //ignored if num_steps !=0
   srv.request.collision_aware = true;
-  srv.request.start_from_end = start_from_end;
-  if (!interpolated_ik_set_params_client_.client(arm_name).call(srv))
+  srv.request.start_from_end = params.start_from_end;
+  if (!interpolated_ik_set_params_client_.call(params.arm_name, srv))
   {
     ROS_ERROR("Failed to set Interpolated IK server parameters");
     throw MechanismException("Failed to set Interpolated IK server parameters");
   }
 }
 
+bool MechanismInterface::compareInterpolatedIKParams(const InterpolatedIKParams &p1, const InterpolatedIKParams &p2)
+{
+  return p1.arm_name == p2.arm_name && p1.num_steps == p2.num_steps &&
+    p1.collision_check_resolution == p2.collision_check_resolution && p1.start_from_end == p2.start_from_end;
+}
+
 bool MechanismInterface::moveArmToPose(std::string arm_name, const geometry_msgs::PoseStamped &desired_pose,
                                        const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
                                        const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
@@ -359,10 +676,10 @@ bool MechanismInterface::getFK(std::string arm_name,
  fk_request.header.frame_id = pose_stamped.header.frame_id;
  fk_request.header.stamp = pose_stamped.header.stamp;
  fk_request.fk_link_names.resize(1);
- fk_request.fk_link_names[0] = handDescription().gripperFrame(arm_name);
+ fk_request.fk_link_names[0] = handDescription().arm(arm_name)->gripper_frame.get();
  fk_request.robot_state.joint_state.position = positions;
  fk_request.robot_state.joint_state.name = getJointNames(arm_name);
- if( !fk_service_client_.client(arm_name).call(fk_request,fk_response) ) 
+ if( !fk_service_client_.call(arm_name, fk_request, fk_response) ) 
    {
      ROS_ERROR("FK Service Call failed altogether");
      throw MechanismException("FK Service Call failed altogether");
@@ -381,18 +698,19 @@ bool MechanismInterface::getIKForPose(std::string arm_name, const geometry_msgs:
                                       const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
                                       const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
 {
-  //prepare the planning scene
-  getPlanningScene(collision_operations, link_padding);
+  //prepare the planning scene, and hold it until we are done
+  ServerStateGate<PlanningSceneState>::ScopedHolder scene(planning_scene_gate_, 
+                                                          planningSceneState(collision_operations, link_padding));
   //call collision-aware ik
   kinematics_msgs::GetConstraintAwarePositionIK::Request ik_request;
-  ik_request.ik_request.ik_link_name = handDescription().gripperFrame(arm_name);
+  ik_request.ik_request.ik_link_name = handDescription().arm(arm_name)->gripper_frame.get();
   ik_request.ik_request.pose_stamped.pose = desired_pose.pose;
   ik_request.ik_request.pose_stamped.header.stamp = desired_pose.header.stamp;
   ik_request.ik_request.pose_stamped.header.frame_id = desired_pose.header.frame_id;
   ik_request.ik_request.ik_seed_state.joint_state.name = getJointNames(arm_name);
   ik_request.ik_request.ik_seed_state.joint_state.position.resize(7, 0.0);
   ik_request.timeout = ros::Duration(2.0);
-  if( !ik_service_client_.client(arm_name).call(ik_request,ik_response) ) 
+  if( !ik_service_client_.call(arm_name, ik_request, ik_response) ) 
   {
     ROS_ERROR("IK Service Call failed altogether");
     throw MechanismException("IK Service Call failed altogether");
@@ -409,8 +727,85 @@ bool MechanismInterface::checkStateValidity(std::string arm_name, const std::vec
                                           const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
                                             const std::vector<arm_navigation_msgs::LinkPadding> &link_padding)
 {
-  //prepare the planning scene
-  getPlanningScene(collision_operations, link_padding);
+  std::vector< std::vector<double> > states(1, joint_values);
+  std::vector<bool> valid;
+  checkStateValidityBatch(arm_name, states, collision_operations, link_padding, valid);
+  return valid[0];
+}
+
+void MechanismInterface::checkStateValidityBatch(std::string arm_name, 
+                                                 const std::vector< std::vector<double> > &joint_values,
+                                                 const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+                                                 const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+                                                 std::vector<bool> &valid)
+{
+  valid.clear();
+  if (joint_values.empty()) return;
+  //prepare the planning scene, and hold it until we are done
+  ServerStateGate<PlanningSceneState>::ScopedHolder scene(planning_scene_gate_, 
+                                                          planningSceneState(collision_operations, link_padding));
+  if (checkStateValidityLocal(arm_name, joint_values, valid)) return;
+  valid.resize(joint_values.size());
+  for (size_t i=0; i<joint_values.size(); i++)
+  {
+    valid[i] = checkStateValidityService(arm_name, joint_values[i]);
+  }
+}
+
+//! Holds the bodies lock of the collision models for as long as it is in scope
+class ScopedBodiesLock
+{
+ private:
+  planning_environment::CollisionModelsInterface &collision_models_;
+ public:
+  ScopedBodiesLock(planning_environment::CollisionModelsInterface &collision_models) : 
+    collision_models_(collision_models) {collision_models_.bodiesLock();}
+  ~ScopedBodiesLock() {collision_models_.bodiesUnlock();}
+};
+
+bool MechanismInterface::checkStateValidityLocal(std::string arm_name, 
+                                                 const std::vector< std::vector<double> > &joint_values,
+                                                 std::vector<bool> &valid)
+{
+  if (!collision_models_) return false;
+  {
+    boost::mutex::scoped_lock lock(local_scene_mutex_);
+    if (!local_scene_valid_) return false;
+  }
+  std::vector<std::string> joint_names = getJointNames(arm_name);
+  for (size_t i=0; i<joint_values.size(); i++)
+  {
+    if (!joint_values[i].empty() && joint_names.size() != joint_values[i].size())
+    {
+      throw MechanismException("Wrong number of joint values for checkStateValidity");
+    }
+  }
+
+  //the collision models are not thread safe, so we hold them for the whole batch
+  ScopedBodiesLock lock(*collision_models_);
+  if (!collision_models_->isPlanningSceneSet()) return false;
+  valid.assign(joint_values.size(), false);
+  for (size_t i=0; i<joint_values.size(); i++)
+  {
+    //the scene state belongs to the mirror, so work on a copy of it; a fresh one for each entry,
+    //as empty joint values mean the current state of the arm, which is the one in the scene
+    planning_models::KinematicState state(*collision_models_->getPlanningSceneState());
+    std::map<std::string, double> joint_state_map;
+    for (size_t j=0; j<joint_values[i].size(); j++)
+    {
+      joint_state_map[joint_names[j]] = joint_values[i][j];
+    }
+    state.setKinematicState(joint_state_map);
+    arm_navigation_msgs::ArmNavigationErrorCodes error_code;
+    valid[i] = collision_models_->isKinematicStateValid(state, joint_names, error_code,
+                                                        arm_navigation_msgs::Constraints(), 
+                                                        arm_navigation_msgs::Constraints());
+  }
+  return true;
+}
+
+bool MechanismInterface::checkStateValidityService(std::string arm_name, const std::vector<double> &joint_values)
+{
   //call check state validity
   arm_navigation_msgs::GetStateValidity::Request req;
   arm_navigation_msgs::GetStateValidity::Response res;
@@ -426,7 +821,7 @@ bool MechanismInterface::checkStateValidity(std::string arm_name, const std::vec
     req.robot_state.joint_state.header.stamp = ros::Time::now();
   }
   req.check_collisions = true;
-  if(!check_state_validity_client_.client().call(req,res))
+  if(!check_state_validity_client_.call(req,res))
   {
     throw MechanismException("Call to check state validity client failed");
   }
@@ -450,78 +845,56 @@ double getJointPosition( std::string name, const arm_navigation_msgs::RobotState
   return 0.0;
 }
 
-/*! If starting_from_end is set to true, the Interpolated IK server will be set to start 
-  from end as well, and the resulting trajectory is copied into the result starting from 
-  the end until a failed step is encountered.
-
-  - seed_joint_position is a seed to be use for IK for the joints we are planning on. Pass
-  an empty vector if you don't have a seed you want to use
-
-  - joint_state is a list of values to be used for joints that are not part of our plan.
-  For example, use this to specifiy if you want the plan done with the gripper open
-  or closed. If you don't specify a joint in here, the current value of that joint will
-  be used by the Interpolated IK server.
- */
-int MechanismInterface::getInterpolatedIK(std::string arm_name,
-					  geometry_msgs::PoseStamped start_pose,
-					  geometry_msgs::Vector3Stamped direction,
-					  float desired_trajectory_length,
-					  const std::vector<double> &seed_joint_position,
-					  const sensor_msgs::JointState &joint_state,
-					  const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
-					  const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
-					  bool reverse_trajectory,
-					  trajectory_msgs::JointTrajectory &trajectory,
-					  float &actual_trajectory_length)
+void MechanismInterface::interpolatedIKMotionPlanRequest(std::string arm_name, const InterpolatedIKRequest &request,
+                                                         arm_navigation_msgs::MotionPlanRequest &motion_plan_request,
+                                                         unsigned int &num_steps, float &actual_step_size)
 {
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
   //first compute the desired end pose
   //make sure the input is normalized
-  geometry_msgs::Vector3Stamped direction_norm = direction;
-  direction_norm.vector = normalize(direction.vector);
+  geometry_msgs::Vector3Stamped direction_norm = request.direction;
+  direction_norm.vector = normalize(request.direction.vector);
   //multiply by the length
-  desired_trajectory_length = fabs(desired_trajectory_length);
+  float desired_trajectory_length = fabs(request.desired_trajectory_length);
   direction_norm.vector.x *= desired_trajectory_length;
   direction_norm.vector.y *= desired_trajectory_length;
   direction_norm.vector.z *= desired_trajectory_length;
+  geometry_msgs::PoseStamped start_pose = request.start_pose;
   geometry_msgs::PoseStamped end_pose = translateGripperPose(direction_norm, start_pose, arm_name);
  
   //hard-coded for now
   float max_step_size = 0.01;
-  unsigned int collision_check_resolution = 2;
  
   //compute the number of steps  
-  unsigned int num_steps = (unsigned int)ceil(desired_trajectory_length / fabs(max_step_size));
-  float actual_step_size = desired_trajectory_length / num_steps;
+  num_steps = (unsigned int)ceil(desired_trajectory_length / fabs(max_step_size));
+  actual_step_size = desired_trajectory_length / num_steps;
 
   ROS_DEBUG_NAMED("manipulation","Trajectory details: length %f, requested num steps: %d, actual step size: %f",
 	   desired_trajectory_length, num_steps, actual_step_size);
 
-  if (reverse_trajectory)
+  if (request.reverse_trajectory)
   {
     std::swap(start_pose, end_pose);
   }
 
-  //recall that here we setting the number of points in trajectory, which is steps+1
-  setInterpolatedIKParams(arm_name, num_steps+1, collision_check_resolution, reverse_trajectory);
-
   arm_navigation_msgs::RobotState start_state;
-  start_state.multi_dof_joint_state.child_frame_ids.push_back(handDescription().gripperFrame(arm_name));
+  start_state.multi_dof_joint_state.child_frame_ids.push_back(hand->gripper_frame.get());
   start_state.multi_dof_joint_state.poses.push_back(start_pose.pose);
   start_state.multi_dof_joint_state.frame_ids.push_back(start_pose.header.frame_id);
   start_state.multi_dof_joint_state.stamp = ros::Time::now();
 
   //pass the seeds for the IK
-  if (!seed_joint_position.empty())
+  if (!request.seed_joint_position.empty())
   { 
     //the caller has provided seeds for planned joints
     //we are silently assuming that the values passed in match out joint names for IK
     start_state.joint_state.name = getJointNames(arm_name);
-    if (seed_joint_position.size() != start_state.joint_state.name.size())
+    if (request.seed_joint_position.size() != start_state.joint_state.name.size())
     {
       ROS_ERROR("Interpolated IK request: seed_joint_position does not match joint names");
       throw MechanismException("Interpolated IK request: seed_joint_position does not match joint names");
     }
-    start_state.joint_state.position = seed_joint_position;
+    start_state.joint_state.position = request.seed_joint_position;
   }
   else
   {
@@ -537,41 +910,37 @@ int MechanismInterface::getInterpolatedIK(std::string arm_name,
   }
 
   //pass the desired values of non-planned joints, if any
-  for (size_t i=0; i<joint_state.name.size(); i++)
+  for (size_t i=0; i<request.joint_state.name.size(); i++)
   {
-    start_state.joint_state.name.push_back(joint_state.name[i]);
-    start_state.joint_state.position.push_back(joint_state.position[i]);
+    start_state.joint_state.name.push_back(request.joint_state.name[i]);
+    start_state.joint_state.position.push_back(request.joint_state.position[i]);
   }
   
   arm_navigation_msgs::PositionConstraint position_constraint;
   arm_navigation_msgs::OrientationConstraint orientation_constraint;
-  arm_navigation_msgs::poseStampedToPositionOrientationConstraints(end_pose, handDescription().gripperFrame(arm_name),
+  arm_navigation_msgs::poseStampedToPositionOrientationConstraints(end_pose, hand->gripper_frame.get(),
 								    position_constraint, 
 								    orientation_constraint);
   arm_navigation_msgs::Constraints goal_constraints;
   goal_constraints.position_constraints.push_back(position_constraint);
   goal_constraints.orientation_constraints.push_back(orientation_constraint);
 
-  arm_navigation_msgs::GetMotionPlan motion_plan;
-  motion_plan.request.motion_plan_request.start_state = start_state;
-  motion_plan.request.motion_plan_request.goal_constraints = goal_constraints;
-
-  //prepare the planning scene
-  getPlanningScene(collision_operations, link_padding);
-
-  //PROF_COUNT(INTERPOLATED_IK);
-  //PROF_START_TIMER(INTERPOLATED_IK);
-  if ( !interpolated_ik_service_client_.client(arm_name).call(motion_plan) ) 
-  {
-    ROS_ERROR("  Call to Interpolated IK service failed");
-    throw MechanismException("Call to Interpolated IK service failed");
-  }
-  //PROF_STOP_TIMER(INTERPOLATED_IK);
+  motion_plan_request.start_state = start_state;
+  motion_plan_request.goal_constraints = goal_constraints;
+}
 
+/*! If reverse_trajectory is set, the trajectory is copied starting from the end until a failed 
+  step is encountered; otherwise, it is copied from the start. */
+void MechanismInterface::interpolatedIKResult(const trajectory_msgs::JointTrajectory &planned_trajectory,
+                                              const std::vector<arm_navigation_msgs::ArmNavigationErrorCodes> &error_codes,
+                                              bool reverse_trajectory, float actual_step_size,
+                                              InterpolatedIKResult &result)
+{
+  trajectory_msgs::JointTrajectory &trajectory = result.trajectory;
   trajectory.points.clear();
-  trajectory.joint_names = motion_plan.response.trajectory.joint_trajectory.joint_names;
+  trajectory.joint_names = planned_trajectory.joint_names;
 
-  if (motion_plan.response.trajectory_error_codes.empty()) 
+  if (error_codes.empty()) 
   {
     ROS_ERROR("  Interpolated IK: empty trajectory received");
     throw MechanismException("Interpolated IK: empty trajectory received");
@@ -580,19 +949,19 @@ int MechanismInterface::getInterpolatedIK(std::string arm_name,
   int error_code = arm_navigation_msgs::ArmNavigationErrorCodes::SUCCESS;
   if (!reverse_trajectory)
   {
-    for (size_t i=0; i<motion_plan.response.trajectory_error_codes.size(); i++) 
+    for (size_t i=0; i<error_codes.size(); i++) 
     {
-      if ( motion_plan.response.trajectory_error_codes[i].val == motion_plan.response.trajectory_error_codes[i].SUCCESS )
+      if ( error_codes[i].val == error_codes[i].SUCCESS )
       {
-	trajectory.points.push_back( motion_plan.response.trajectory.joint_trajectory.points[i] );
+	trajectory.points.push_back( planned_trajectory.points[i] );
       } 
       else 
       {
 	ROS_DEBUG_NAMED("manipulation","  Interpolated IK failed on step %d (forward towards %d) with error code %d", 
 		 (int) i, 
-		 (int) motion_plan.response.trajectory_error_codes.size() - 1, 
-		 motion_plan.response.trajectory_error_codes[i].val);
-	error_code = motion_plan.response.trajectory_error_codes[i].val;
+		 (int) error_codes.size() - 1, 
+		 error_codes[i].val);
+	error_code = error_codes[i].val;
 	break;
       }
     }
@@ -600,41 +969,191 @@ int MechanismInterface::getInterpolatedIK(std::string arm_name,
   else
   {
     size_t first_success = 0;
-    while ( first_success < motion_plan.response.trajectory_error_codes.size() &&
-	    motion_plan.response.trajectory_error_codes[first_success].val != 
-	    motion_plan.response.trajectory_error_codes[first_success].SUCCESS ) first_success ++;
+    while ( first_success < error_codes.size() &&
+	    error_codes[first_success].val != error_codes[first_success].SUCCESS ) first_success ++;
     if (first_success != 0)
     {
       ROS_DEBUG_NAMED("manipulation","  Interpolation failed on step %d (backwards from %d) with error code %d",
 	       (int) first_success - 1,
-	       (int) motion_plan.response.trajectory_error_codes.size() - 1,
-	       motion_plan.response.trajectory_error_codes[first_success - 1].val);
-      error_code = motion_plan.response.trajectory_error_codes[first_success - 1].val;
+	       (int) error_codes.size() - 1,
+	       error_codes[first_success - 1].val);
+      error_code = error_codes[first_success - 1].val;
     }
     else
     {
       ROS_DEBUG_NAMED("manipulation","  Interpolation trajectory complete (backwards from %d points)",
-	       (int) motion_plan.response.trajectory_error_codes.size());
+	       (int) error_codes.size());
       
     }
-    for (size_t i=first_success; i < motion_plan.response.trajectory_error_codes.size(); i++) 
+    for (size_t i=first_success; i < error_codes.size(); i++) 
     {
-      if ( motion_plan.response.trajectory_error_codes[i].val == motion_plan.response.trajectory_error_codes[i].SUCCESS )
+      if ( error_codes[i].val == error_codes[i].SUCCESS )
       {
-	trajectory.points.push_back( motion_plan.response.trajectory.joint_trajectory.points[i] );
+	trajectory.points.push_back( planned_trajectory.points[i] );
       } 
       else 
       {
 	ROS_ERROR("  Interpolated IK: unexpected behavior for error codes: step %d has error code %d",
-		  (int) i, motion_plan.response.trajectory_error_codes[i].val);
+		  (int) i, error_codes[i].val);
 	throw MechanismException("Interpolated IK: unexpected behavior for error codes");
       }
     }
   }
 
-  if (!trajectory.points.empty()) actual_trajectory_length = actual_step_size * (trajectory.points.size()-1);
-  else actual_trajectory_length = 0.0;
-  return error_code;
+  if (!trajectory.points.empty()) result.actual_trajectory_length = actual_step_size * (trajectory.points.size()-1);
+  else result.actual_trajectory_length = 0.0;
+  result.error_code = error_code;
+}
+
+/*! Uses the regular interpolated IK service, which means the server params have to be set before
+  the call, in a separate round trip. */
+void MechanismInterface::getInterpolatedIKSingle(std::string arm_name, const InterpolatedIKRequest &request,
+                                                 const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+                                                 const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+                                                 InterpolatedIKResult &result)
+{
+  arm_navigation_msgs::GetMotionPlan motion_plan;
+  unsigned int num_steps;
+  float actual_step_size;
+  interpolatedIKMotionPlanRequest(arm_name, request, motion_plan.request.motion_plan_request, 
+                                  num_steps, actual_step_size);
+  {
+    //prepare the planning scene, then the server params, and hold both until the call is done
+    ServerStateGate<PlanningSceneState>::ScopedHolder scene(planning_scene_gate_, 
+                                                            planningSceneState(collision_operations, link_padding));
+    //recall that here we setting the number of points in trajectory, which is steps+1
+    InterpolatedIKParams params;
+    params.arm_name = arm_name;
+    params.num_steps = num_steps+1;
+    params.collision_check_resolution = INTERPOLATED_IK_COLLISION_CHECK_RESOLUTION;
+    params.start_from_end = request.reverse_trajectory;
+    ServerStateGate<InterpolatedIKParams>::ScopedHolder ik_params(interpolated_ik_params_gate_, params);
+
+    //PROF_COUNT(INTERPOLATED_IK);
+    //PROF_START_TIMER(INTERPOLATED_IK);
+    if ( !interpolated_ik_service_client_.call(arm_name, motion_plan) ) 
+    {
+      ROS_ERROR("  Call to Interpolated IK service failed");
+      throw MechanismException("Call to Interpolated IK service failed");
+    }
+    //PROF_STOP_TIMER(INTERPOLATED_IK);
+  }
+  interpolatedIKResult(motion_plan.response.trajectory.joint_trajectory, motion_plan.response.trajectory_error_codes,
+                       request.reverse_trajectory, actual_step_size, result);
+}
+
+/*! All the requests are sent to the server in a single call, along with the server params they
+  need, so the params do not have to be set separately. They all use the same planning scene.
+
+  A request the server could not plan at all comes back without a trajectory; its result gets 
+  the error code of the plan and an empty trajectory, and the other results are not affected.
+
+  Unless batch requests are enabled through the use_interpolated_ik_batch param, the requests are 
+  sent one at a time to the regular interpolated IK service instead.
+*/
+void MechanismInterface::getInterpolatedIKBatch(std::string arm_name, 
+                                                const std::vector<InterpolatedIKRequest> &requests,
+                                                const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+                                                const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+                                                std::vector<InterpolatedIKResult> &results)
+{
+  results.resize(requests.size());
+  if (requests.empty()) return;
+  if (!use_interpolated_ik_batch_)
+  {
+    for (size_t i=0; i<requests.size(); i++)
+    {
+      getInterpolatedIKSingle(arm_name, requests[i], collision_operations, link_padding, results[i]);
+    }
+    return;
+  }
+
+  interpolated_ik_motion_planner::GetInterpolatedIKMotionPlanBatch batch;
+  std::vector<float> actual_step_sizes(requests.size());
+  batch.request.motion_plan_requests.resize(requests.size());
+  for (size_t i=0; i<requests.size(); i++)
+  {
+    unsigned int num_steps;
+    interpolatedIKMotionPlanRequest(arm_name, requests[i], batch.request.motion_plan_requests[i], 
+                                    num_steps, actual_step_sizes[i]);
+    //recall that here we setting the number of points in trajectory, which is steps+1
+    batch.request.num_steps.push_back(num_steps+1);
+    batch.request.collision_check_resolution.push_back(INTERPOLATED_IK_COLLISION_CHECK_RESOLUTION);
+    batch.request.start_from_end.push_back(requests[i].reverse_trajectory);
+  }
+  {
+    //prepare the planning scene, and hold it until the call is done
+    ServerStateGate<PlanningSceneState>::ScopedHolder scene(planning_scene_gate_, 
+                                                            planningSceneState(collision_operations, link_padding));
+    if ( !interpolated_ik_batch_service_client_.call(arm_name, batch) ) 
+    {
+      ROS_ERROR("  Call to Interpolated IK batch service failed");
+      throw MechanismException("Call to Interpolated IK batch service failed");
+    }
+  }
+  if (batch.response.plans.size() != requests.size())
+  {
+    ROS_ERROR("  Interpolated IK batch: %zd plans received for %zd requests", 
+              batch.response.plans.size(), requests.size());
+    throw MechanismException("Interpolated IK batch: wrong number of plans received");
+  }
+  for (size_t i=0; i<requests.size(); i++)
+  {
+    const interpolated_ik_motion_planner::InterpolatedIKMotionPlan &plan = batch.response.plans[i];
+    if (plan.trajectory_error_codes.empty())
+    {
+      ROS_DEBUG_NAMED("manipulation", "  Interpolated IK batch: request %zd failed with error code %d",
+                      i, plan.error_code.val);
+      results[i].trajectory = trajectory_msgs::JointTrajectory();
+      results[i].actual_trajectory_length = 0.0;
+      results[i].error_code = plan.error_code.val != plan.error_code.SUCCESS ? 
+        plan.error_code.val : (int)arm_navigation_msgs::ArmNavigationErrorCodes::PLANNING_FAILED;
+      continue;
+    }
+    interpolatedIKResult(plan.trajectory.joint_trajectory, plan.trajectory_error_codes,
+                         requests[i].reverse_trajectory, actual_step_sizes[i], results[i]);
+  }
+}
+
+/*! If starting_from_end is set to true, the Interpolated IK server will be set to start 
+  from end as well, and the resulting trajectory is copied into the result starting from 
+  the end until a failed step is encountered.
+
+  - seed_joint_position is a seed to be use for IK for the joints we are planning on. Pass
+  an empty vector if you don't have a seed you want to use
+
+  - joint_state is a list of values to be used for joints that are not part of our plan.
+  For example, use this to specifiy if you want the plan done with the gripper open
+  or closed. If you don't specify a joint in here, the current value of that joint will
+  be used by the Interpolated IK server.
+
+  Unless batch requests are disabled, this is sent as a batch of one request, which saves 
+  the round trip for setting the server params.
+ */
+int MechanismInterface::getInterpolatedIK(std::string arm_name,
+					  geometry_msgs::PoseStamped start_pose,
+					  geometry_msgs::Vector3Stamped direction,
+					  float desired_trajectory_length,
+					  const std::vector<double> &seed_joint_position,
+					  const sensor_msgs::JointState &joint_state,
+					  const arm_navigation_msgs::OrderedCollisionOperations &collision_operations,
+					  const std::vector<arm_navigation_msgs::LinkPadding> &link_padding,
+					  bool reverse_trajectory,
+					  trajectory_msgs::JointTrajectory &trajectory,
+					  float &actual_trajectory_length)
+{
+  std::vector<InterpolatedIKRequest> requests(1);
+  requests[0].start_pose = start_pose;
+  requests[0].direction = direction;
+  requests[0].desired_trajectory_length = desired_trajectory_length;
+  requests[0].seed_joint_position = seed_joint_position;
+  requests[0].joint_state = joint_state;
+  requests[0].reverse_trajectory = reverse_trajectory;
+  std::vector<InterpolatedIKResult> results;
+  getInterpolatedIKBatch(arm_name, requests, collision_operations, link_padding, results);
+  trajectory = results[0].trajectory;
+  actual_trajectory_length = results[0].actual_trajectory_length;
+  return results[0].error_code;
 }
 
 bool MechanismInterface::attemptMoveArmToGoal(std::string arm_name, const std::vector<double> &desired_joint_values,
@@ -644,6 +1163,8 @@ bool MechanismInterface::attemptMoveArmToGoal(std::string arm_name, const std::v
   //make sure joint controllers are running
   //if(!checkController(jointControllerName(arm_name)))
   //   switchToJoint(arm_name);
+  //the joint controllers could only be stopped by a Cartesian move that has not switched back yet
+  finishDeferredSwitchToJoint(arm_name);
 
   int num_tries = 0;
   int max_tries = 5;
@@ -669,6 +1190,8 @@ bool MechanismInterface::attemptMoveArmToGoal(std::string arm_name, const std::v
     move_arm_goal.motion_plan_request.goal_constraints.joint_constraints[i].tolerance_above = .08;
   }
   
+  //move arm sends its own planning scene diff; nobody else can rely on the planning scene meanwhile
+  ServerStateGate<PlanningSceneState>::ScopedExclusiveHolder scene(planning_scene_gate_);
   bool success = false;
   arm_navigation_msgs::ArmNavigationErrorCodes error_code;
   while(num_tries < max_tries)
@@ -768,6 +1291,8 @@ bool MechanismInterface::moveArmConstrained(std::string arm_name, const geometry
   //make sure joint controllers are running
   //if(!checkController(jointControllerName(arm_name)))
   //   switchToJoint(arm_name);
+  //the joint controllers could only be stopped by a Cartesian move that has not switched back yet
+  finishDeferredSwitchToJoint(arm_name);
 
   int num_tries = 0;
   int max_tries = 1;
@@ -850,6 +1375,8 @@ bool MechanismInterface::moveArmConstrained(std::string arm_name, const geometry
   move_arm_goal.motion_plan_request.goal_constraints.joint_constraints[0].tolerance_below = M_PI;
   move_arm_goal.motion_plan_request.goal_constraints.joint_constraints[0].tolerance_above = M_PI;
       
+  //move arm sends its own planning scene diff; nobody else can rely on the planning scene meanwhile
+  ServerStateGate<PlanningSceneState>::ScopedExclusiveHolder scene(planning_scene_gate_);
   bool success = false;
   while(num_tries < max_tries)
   {
@@ -904,12 +1431,15 @@ geometry_msgs::PoseStamped MechanismInterface::translateGripperPose(geometry_msg
 								    geometry_msgs::PoseStamped start_pose,
 								    std::string arm_name)
 {
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
+  const std::string &gripper_frame = hand->gripper_frame.get();
+  const std::string &robot_frame = hand->robot_frame.get();
   bool pre_multiply;
-  if (translation.header.frame_id == handDescription().gripperFrame(arm_name))
+  if (translation.header.frame_id == gripper_frame)
   {
     pre_multiply=false;
   } 
-  else if (translation.header.frame_id == handDescription().robotFrame(arm_name))
+  else if (translation.header.frame_id == robot_frame)
   {
     pre_multiply=true;
   }
@@ -922,7 +1452,7 @@ geometry_msgs::PoseStamped MechanismInterface::translateGripperPose(geometry_msg
 
 
   //go to robot frame first
-  geometry_msgs::PoseStamped start_pose_robot_frame = transformPose(handDescription().robotFrame(arm_name), start_pose);
+  geometry_msgs::PoseStamped start_pose_robot_frame = transformPose(robot_frame, start_pose);
   tf::StampedTransform start_transform;
   tf::poseMsgToTF(start_pose_robot_frame.pose, start_transform);
 
@@ -940,7 +1470,7 @@ geometry_msgs::PoseStamped MechanismInterface::translateGripperPose(geometry_msg
   //prepare the results
   geometry_msgs::PoseStamped translated_pose;
   tf::poseTFToMsg(end_transform, translated_pose.pose);
-  translated_pose.header.frame_id = handDescription().robotFrame(arm_name);
+  translated_pose.header.frame_id = robot_frame;
   translated_pose.header.stamp = ros::Time(0);
 
   //return the result in the requested frame
@@ -952,10 +1482,11 @@ geometry_msgs::PoseStamped MechanismInterface::translateGripperPose(geometry_msg
 /*! Current gripper pose is returned in the requested frame_id.*/
 geometry_msgs::PoseStamped MechanismInterface::getGripperPose(std::string arm_name, std::string frame_id)
 {
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
   tf::StampedTransform gripper_transform;
   try
   {
-    listener_.lookupTransform(frame_id, handDescription().gripperFrame(arm_name), ros::Time(0), gripper_transform);
+    listener_.lookupTransform(frame_id, hand->gripper_frame.get(), ros::Time(0), gripper_transform);
   }
   catch (tf::TransformException ex)
   {
@@ -963,7 +1494,7 @@ geometry_msgs::PoseStamped MechanismInterface::getGripperPose(std::string arm_na
     ROS_ERROR("failed to get tf transform for wrist roll link, trying a second time");
     try
     {
-      listener_.lookupTransform(frame_id, handDescription().gripperFrame(arm_name), ros::Time(0), gripper_transform);
+      listener_.lookupTransform(frame_id, hand->gripper_frame.get(), ros::Time(0), gripper_transform);
     }
     catch (tf::TransformException ex)
     {
@@ -979,6 +1510,39 @@ geometry_msgs::PoseStamped MechanismInterface::getGripperPose(std::string arm_na
   return gripper_pose;
 }
 
+/*! Waits for tf to receive a gripper pose with a time stamp after the given one, or until max_wait 
+  runs out. The pose is returned stamped with the time of the transform it came from, so that it can
+  be passed back in as the time stamp to wait after. */
+bool MechanismInterface::getNewGripperPose(std::string arm_name, std::string frame_id, const ros::Time &after, 
+                                           ros::Duration max_wait, geometry_msgs::PoseStamped &gripper_pose)
+{
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
+  const std::string &gripper_frame = hand->gripper_frame.get();
+  tf::StampedTransform gripper_transform;
+  bool is_new = true;
+  try
+  {
+    listener_.lookupTransform(frame_id, gripper_frame, ros::Time(0), gripper_transform);
+    if (!after.isZero() && gripper_transform.stamp_ <= after)
+    {
+      //waitForTransform only returns once data at or after the requested time is available
+      is_new = listener_.waitForTransform(frame_id, gripper_frame, after + ros::Duration(1.0e-6), max_wait,
+                                          ros::Duration(0.001));
+      if (is_new) listener_.lookupTransform(frame_id, gripper_frame, ros::Time(0), gripper_transform);
+    }
+  }
+  catch (tf::TransformException ex)
+  {
+    ROS_ERROR("Mechanism interface: failed to get tf transform for wrist roll link; tf exception %s", ex.what());
+    throw MechanismException(std::string("failed to get tf transform for wrist roll link; tf exception: ") + 
+                             std::string(ex.what()) );
+  }
+  tf::poseTFToMsg(gripper_transform, gripper_pose.pose);
+  gripper_pose.header.frame_id = frame_id;
+  gripper_pose.header.stamp = gripper_transform.stamp_;
+  return is_new;
+}
+
 void MechanismInterface::transformPointCloud(std::string target_frame, 
 					     const sensor_msgs::PointCloud &cloud_in,
 					     sensor_msgs::PointCloud &cloud_out)
@@ -1016,7 +1580,26 @@ geometry_msgs::PoseStamped MechanismInterface::transformPose(const std::string t
   geometry_msgs::PoseStamped stamped_out;
   try
   {
-    listener_.transformPose(target_frame, stamped_in, stamped_out);
+    TransformSnapshotData *snapshot = transform_snapshot_.get();
+    if (!snapshot)
+    {
+      listener_.transformPose(target_frame, stamped_in, stamped_out);
+      return stamped_out;
+    }
+    //use the transform from the snapshot, looking it up the first time it is needed
+    std::pair<std::string, std::string> frames(target_frame, stamped_in.header.frame_id);
+    TransformSnapshotData::iterator it = snapshot->find(frames);
+    if (it == snapshot->end())
+    {
+      tf::StampedTransform transform;
+      listener_.lookupTransform(target_frame, stamped_in.header.frame_id, ros::Time(0), transform);
+      it = snapshot->insert(std::make_pair(frames, transform)).first;
+    }
+    tf::Pose pose_in;
+    tf::poseMsgToTF(stamped_in.pose, pose_in);
+    tf::poseTFToMsg(it->second * pose_in, stamped_out.pose);
+    stamped_out.header.frame_id = target_frame;
+    stamped_out.header.stamp = it->second.stamp_;
   }
   catch (tf::TransformException ex)
   {
@@ -1028,6 +1611,48 @@ geometry_msgs::PoseStamped MechanismInterface::transformPose(const std::string t
   return stamped_out;
 }
 
+boost::shared_ptr<const ReachabilityMap> MechanismInterface::getReachabilityMap(std::string arm_name)
+{
+  boost::mutex::scoped_lock lock(reachability_maps_mutex_);
+  std::map<std::string, boost::shared_ptr<const ReachabilityMap> >::iterator it = reachability_maps_.find(arm_name);
+  if (it != reachability_maps_.end()) return it->second;
+
+  //failures are remembered as empty pointers, so we only try to load each map once
+  boost::shared_ptr<const ReachabilityMap> &map = reachability_maps_[arm_name];
+  std::string filename;
+  if (!priv_nh_.getParam("reachability_map/" + arm_name, filename)) 
+  {
+    ROS_DEBUG("Mechanism interface: no reachability map specified for %s", arm_name.c_str());
+    return map;
+  }
+  boost::shared_ptr<ReachabilityMap> loaded_map(new ReachabilityMap());
+  if (!loaded_map->load(filename))
+  {
+    ROS_ERROR("Mechanism interface: failed to load reachability map for %s", arm_name.c_str());
+    return map;
+  }
+  ROS_INFO("Mechanism interface: loaded reachability map for %s from %s (%zd voxels)", 
+           arm_name.c_str(), filename.c_str(), loaded_map->numVoxels());
+  map = loaded_map;
+  return map;
+}
+
+bool MechanismInterface::getReachability(std::string arm_name, const geometry_msgs::PoseStamped &gripper_pose,
+                                         double &reachability, double &manipulability)
+{
+  boost::shared_ptr<const ReachabilityMap> map = getReachabilityMap(arm_name);
+  if (!map) return false;
+  geometry_msgs::PoseStamped map_pose = gripper_pose;
+  if (gripper_pose.header.frame_id != map->frameId()) map_pose = transformPose(map->frameId(), gripper_pose);
+  tf::Vector3 position(map_pose.pose.position.x, map_pose.pose.position.y, map_pose.pose.position.z);
+  if (!map->lookup(position, reachability, manipulability))
+  {
+    reachability = 0.0;
+    manipulability = 0.0;
+  }
+  return true;
+}
+
 /*! Moves the gripper from its current pose to the one obtained by the specified translation.
 */
 bool MechanismInterface::translateGripper(std::string arm_name, const geometry_msgs::Vector3Stamped &direction,
@@ -1219,46 +1844,106 @@ bool MechanismInterface::callSwitchControllers(std::vector<std::string> start_co
   return true;
 }  
 
-bool MechanismInterface::switchControllers(std::string start_controller, std::string stop_controller)
+void MechanismInterface::updateControllerStates()
 {
-  ROS_DEBUG_NAMED("manipulation","Switching controller %s for %s", start_controller.c_str(), stop_controller.c_str());
-  std::vector<std::string> start_controllers;
-  std::vector<std::string> stop_controllers;
-  start_controllers.push_back(start_controller);
-  stop_controllers.push_back(stop_controller);
-  bool success = callSwitchControllers(start_controllers, stop_controllers);
-  if(success)
+  pr2_mechanism_msgs::ListControllers srv;
+  if( !list_controllers_service_.client().call(srv))
   {
-    bool start_running = checkController(start_controller);
-    bool stop_running = checkController(stop_controller);
-    if(start_running && !stop_running) return true;
-    ROS_ERROR("switching %s to %s failed even though it returned success", 
-              stop_controller.c_str(), start_controller.c_str());
-    return false;
+    ROS_ERROR("Mechanism interface: list controllers service call failed");
+    throw MechanismException("list controllers service call failed");
   }
-  else
+  boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+  controller_running_.clear();
+  for(size_t controller_ind=0; controller_ind < srv.response.controllers.size(); controller_ind++)
   {
-    ROS_ERROR("switching %s to %s failed", stop_controller.c_str(), start_controller.c_str());
-    return false;
+    if (controller_ind >= srv.response.state.size()) break;
+    controller_running_[srv.response.controllers[controller_ind]] = 
+      (srv.response.state[controller_ind].compare("running") == 0);
   }
+  controller_states_stamp_ = ros::Time::now();
 }
 
-bool MechanismInterface::checkController(std::string controller)
+bool MechanismInterface::knownControllerState(std::string controller, bool &running)
 {
-  pr2_mechanism_msgs::ListControllers srv;
-  if( !list_controllers_service_.client().call(srv))
+  boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+  if (controller_states_stamp_.isZero() || 
+      ros::Time::now() - controller_states_stamp_ > ros::Duration(controller_state_max_age_)) return false;
+  std::map<std::string, bool>::const_iterator it = controller_running_.find(controller);
+  if (it == controller_running_.end()) return false;
+  running = it->second;
+  return true;
+}
+
+bool MechanismInterface::controllersInState(const std::vector<std::string> &running_controllers,
+                                            const std::vector<std::string> &stopped_controllers)
+{
+  bool running;
+  for (size_t i=0; i<running_controllers.size(); i++)
   {
-    ROS_ERROR("Mechanism interface: list controllers service call failed");
-    throw MechanismException("list controllers service call failed");
+    if (!knownControllerState(running_controllers[i], running) || !running) return false;
   }
-  for(size_t controller_ind=0; controller_ind < srv.response.controllers.size(); controller_ind++)
+  for (size_t i=0; i<stopped_controllers.size(); i++)
+  {
+    if (!knownControllerState(stopped_controllers[i], running) || running) return false;
+  }
+  return true;
+}
+
+/*! Switches are skipped if the controllers are known to already be in the requested state. Otherwise,
+  the result is verified with a single query of all controller states. */
+bool MechanismInterface::switchControllers(const std::vector<std::string> &start_controllers,
+                                           const std::vector<std::string> &stop_controllers)
+{
+  boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+  if (controllersInState(start_controllers, stop_controllers))
   {
-    if(controller.compare(srv.response.controllers[controller_ind]) == 0)
+    ROS_DEBUG_NAMED("manipulation","Controllers already in requested state, not switching");
+    return true;
+  }
+  bool success = callSwitchControllers(start_controllers, stop_controllers);
+  //whatever happened, the states we knew about might be wrong now
+  controller_states_stamp_ = ros::Time();
+  if (!success) return false;
+  updateControllerStates();
+  std::vector<std::string> none;
+  for (size_t i=0; i<start_controllers.size(); i++)
+  {
+    std::vector<std::string> running(1, start_controllers[i]);
+    if (!controllersInState(running, none))
     {
-      if(srv.response.state[controller_ind].compare("running") == 0) return true;
+      ROS_ERROR("controller %s not running after switch", start_controllers[i].c_str());
       return false;
     }
   }
+  for (size_t i=0; i<stop_controllers.size(); i++)
+  {
+    bool running;
+    if (knownControllerState(stop_controllers[i], running) && running)
+    {
+      ROS_ERROR("controller %s still running after switch", stop_controllers[i].c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MechanismInterface::switchControllers(std::string start_controller, std::string stop_controller)
+{
+  ROS_DEBUG_NAMED("manipulation","Switching controller %s for %s", start_controller.c_str(), stop_controller.c_str());
+  std::vector<std::string> start_controllers;
+  std::vector<std::string> stop_controllers;
+  start_controllers.push_back(start_controller);
+  stop_controllers.push_back(stop_controller);
+  if (switchControllers(start_controllers, stop_controllers)) return true;
+  ROS_ERROR("switching %s to %s failed", stop_controller.c_str(), start_controller.c_str());
+  return false;
+}
+
+bool MechanismInterface::checkController(std::string controller)
+{
+  updateControllerStates();
+  bool running;
+  if (knownControllerState(controller, running)) return running;
   ROS_WARN("controller %s not found when checking status!", controller.c_str());
   return false;
 }
@@ -1269,19 +1954,9 @@ bool MechanismInterface::startController(std::string controller)
   std::vector<std::string> start_controllers;
   std::vector<std::string> stop_controllers;
   start_controllers.push_back(controller);
-  bool success = callSwitchControllers(start_controllers, stop_controllers);
-  if(success)
-  {
-    bool running = checkController(controller);
-    if(running) return true;
-    ROS_ERROR("starting controller %s failed even though it returned success", controller.c_str());
-    return false;
-  }
-  else
-  {
-    ROS_ERROR("starting controller %s failed", controller.c_str());
-    return false;
-  }
+  if (switchControllers(start_controllers, stop_controllers)) return true;
+  ROS_ERROR("starting controller %s failed", controller.c_str());
+  return false;
 }
 
 bool MechanismInterface::stopController(std::string controller)
@@ -1290,27 +1965,99 @@ bool MechanismInterface::stopController(std::string controller)
   std::vector<std::string> start_controllers;
   std::vector<std::string> stop_controllers;
   stop_controllers.push_back(controller);
-  bool success = callSwitchControllers(start_controllers, stop_controllers);
-  if(success)
+  if (switchControllers(start_controllers, stop_controllers)) return true;
+  ROS_ERROR("stopping controller %s failed", controller.c_str());
+  return false;
+}
+
+void MechanismInterface::deferSwitchToJoint(std::string arm_name)
+{
+  ros::Timer replaced_timer;
+  {
+    boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+    DeferredSwitch &deferred_switch = deferred_joint_switches_[arm_name];
+    replaced_timer = deferred_switch.timer;
+    deferred_switch.generation = ++deferred_switch_generation_;
+    deferred_switch.timer = 
+      root_nh_.createTimer(ros::Duration(cartesian_switch_back_delay_), 
+                           boost::bind(&MechanismInterface::deferredSwitchToJointCallback, this, _1, arm_name, 
+                                       deferred_switch.generation), true);
+  }
+  //stopped outside the lock, see takeDeferredSwitchToJoint(...)
+  replaced_timer.stop();
+}
+
+bool MechanismInterface::takeDeferredSwitchToJoint(std::string arm_name, unsigned int generation, 
+                                                   ros::Timer &timer)
+{
+  std::map<std::string, DeferredSwitch>::iterator it = deferred_joint_switches_.find(arm_name);
+  if (it == deferred_joint_switches_.end()) return false;
+  if (generation != 0 && it->second.generation != generation) return false;
+  timer = it->second.timer;
+  deferred_joint_switches_.erase(it);
+  return true;
+}
+
+bool MechanismInterface::cancelDeferredSwitchToJoint(std::string arm_name)
+{
+  ros::Timer timer;
   {
-    bool running = checkController(controller);
-    if(running)
-    {
-      ROS_ERROR("stopping controller %s failed even though it returned success", controller.c_str());
-      return false;
-    }
-    return true;
+    //also waits for a switch the timer callback is doing right now
+    boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+    if (!takeDeferredSwitchToJoint(arm_name, 0, timer)) return false;
   }
-  else
+  //stopping waits for a running callback of this timer, which might itself be waiting for the lock
+  timer.stop();
+  return true;
+}
+
+bool MechanismInterface::finishDeferredSwitchToJoint(std::string arm_name)
+{
+  ros::Timer timer;
+  bool result = true;
   {
-    ROS_ERROR("stopping controller %s failed", controller.c_str());
-    return false;
+    //also waits for a switch the timer callback is doing right now
+    boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+    if (takeDeferredSwitchToJoint(arm_name, 0, timer)) result = switchToJointRetrying(arm_name);
+  }
+  timer.stop();
+  return result;
+}
+
+bool MechanismInterface::switchToJointRetrying(std::string arm_name)
+{
+  for(int tries=0; tries<3; tries++)
+  {
+    if (switchToJoint(arm_name)) return true;
+    ros::Duration(1.0).sleep();
+  }
+  ROS_ERROR("Tries exceeding when trying to switch back to joint control!");
+  return false;
+}
+
+void MechanismInterface::deferredSwitchToJointCallback(const ros::TimerEvent &, std::string arm_name, 
+                                                       unsigned int generation)
+{
+  //declared before the lock so that it is released after it
+  ros::Timer timer;
+  //held until the switch is done, so that nobody else sees the arm in between
+  boost::recursive_mutex::scoped_lock lock(controllers_mutex_);
+  //a switch that was cancelled or replaced while this callback was waiting is left alone
+  if (!takeDeferredSwitchToJoint(arm_name, generation, timer)) return;
+  try
+  {
+    switchToJointRetrying(arm_name);
+  }
+  catch (MechanismException &ex)
+  {
+    ROS_ERROR("Deferred switch to joint control failed: %s", ex.what());
   }
 }
 
 bool MechanismInterface::getArmAngles(std::string arm_name, std::vector<double> &arm_angles)
 {
-  std::vector<std::string> arm_joints = handDescription().armJointNames(arm_name);
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
+  const std::vector<std::string> &arm_joints = hand->arm_joint_names.get();
   if(arm_joints.size() == 0)
   {
     ROS_ERROR("mechanism interface: armJointNames was empty!");
@@ -1320,11 +2067,11 @@ bool MechanismInterface::getArmAngles(std::string arm_name, std::vector<double>
 
   //grab the latest JointState message
   arm_navigation_msgs::RobotState robot_state;
-  getRobotState(robot_state);
+  getRobotState(robot_state, arm_joints);
   //find each joint and its current position in the JointState message
   for (size_t joint_num = 0; joint_num < arm_joints.size(); joint_num++)
   {
-    std::string joint_name = arm_joints[joint_num];
+    const std::string &joint_name = arm_joints[joint_num];
     size_t i;
     for (i=0; i<robot_state.joint_state.name.size(); i++)
     {
@@ -1418,6 +2165,16 @@ geometry_msgs::PoseStamped MechanismInterface::clipDesiredPose(std::string arm_n
 
   //Get the current gripper pose
   geometry_msgs::PoseStamped current_pose = getGripperPose(arm_name, desired_pose.header.frame_id);
+  return clipDesiredPose(current_pose, desired_pose, clip_dist, clip_angle, resulting_clip_fraction);
+}
+
+geometry_msgs::PoseStamped MechanismInterface::clipDesiredPose(const geometry_msgs::PoseStamped &current_pose,
+                                                               const geometry_msgs::PoseStamped &desired_pose, 
+                                                               double clip_dist, double clip_angle, 
+                                                               double &resulting_clip_fraction)
+{
+  //no clipping desired
+  if(clip_dist == 0 && clip_angle == 0) return desired_pose;
 
   //Get the position and angle dists between current and desired
   Eigen::Affine3d current_trans, desired_trans;
@@ -1463,8 +2220,24 @@ geometry_msgs::PoseStamped MechanismInterface::clipDesiredPose(std::string arm_n
                                                                const std::vector<double> &goal_posture_suggestion,
                                                                std::vector<double> &clipped_posture_goal)
 {
-  double clip_fraction;
-  geometry_msgs::PoseStamped clipped_pose = clipDesiredPose(arm_name, desired_pose, clip_dist, clip_angle, clip_fraction);
+  geometry_msgs::PoseStamped current_pose;
+  if (clip_dist != 0 || clip_angle != 0) current_pose = getGripperPose(arm_name, desired_pose.header.frame_id);
+  return clipDesiredPose(arm_name, current_pose, desired_pose, clip_dist, clip_angle, resulting_clip_fraction,
+                         goal_posture_suggestion, clipped_posture_goal);
+}
+
+geometry_msgs::PoseStamped MechanismInterface::clipDesiredPose(std::string arm_name, 
+                                                               const geometry_msgs::PoseStamped &current_pose,
+                                                               const geometry_msgs::PoseStamped &desired_pose, 
+                                                               double clip_dist, double clip_angle, 
+                                                               double &resulting_clip_fraction,
+                                                               const std::vector<double> &goal_posture_suggestion,
+                                                               std::vector<double> &clipped_posture_goal)
+{
+  double clip_fraction = 1.0;
+  geometry_msgs::PoseStamped clipped_pose = clipDesiredPose(current_pose, desired_pose, clip_dist, clip_angle, 
+                                                            clip_fraction);
+  resulting_clip_fraction = clip_fraction;
 
   //If there's a goal posture suggestion, clip it as well
   if(goal_posture_suggestion.size() > 0 && (clip_dist != 0 || clip_angle != 0))
@@ -1543,6 +2316,9 @@ int MechanismInterface::moveArmToPoseCartesian(std::string arm_name, const geome
 {
   bool success = false;
 
+  //if we are still in Cartesian control from a previous move, there is no need to switch back and forth
+  cancelDeferredSwitchToJoint(arm_name);
+
   //Switch to Cartesian controllers
   for(int tries=0; tries<3; tries++)
   {
@@ -1557,9 +2333,13 @@ int MechanismInterface::moveArmToPoseCartesian(std::string arm_name, const geome
   }
 
   //Move towards the desired pose until we get there within our tolerance or until time runs out
+  //A new command is computed as soon as a new gripper pose arrives, or after timestep if none does
   ros::Time begin = ros::Time::now();
   int reached_target = -1;
-  geometry_msgs::PoseStamped current_pose = getGripperPose(arm_name, desired_pose.header.frame_id);
+  geometry_msgs::PoseStamped current_pose;
+  ros::Time last_pose_stamp, last_command_time;
+  int num_commands = 0, num_stale_poses = 0;
+  double latency_sum = 0, latency_max = 0, period_sum = 0, period_sq_sum = 0;
 
   while(ros::ok())
   {
@@ -1570,9 +2350,12 @@ int MechanismInterface::moveArmToPoseCartesian(std::string arm_name, const geome
       break;
     }
     
-    //stop if we're within our tolerances
-    current_pose = getGripperPose(arm_name, desired_pose.header.frame_id);
+    //wait for a gripper pose newer than the one the last command was computed from
+    if (!getNewGripperPose(arm_name, desired_pose.header.frame_id, last_pose_stamp, ros::Duration(timestep), 
+                           current_pose)) num_stale_poses++;
+    last_pose_stamp = current_pose.header.stamp;
 
+    //stop if we're within our tolerances
     double pos_dist, angle_dist;
     poseDists(current_pose.pose, desired_pose.pose, pos_dist, angle_dist);
     if(pos_dist <= dist_tol && angle_dist <= angle_tol)
@@ -1585,7 +2368,7 @@ int MechanismInterface::moveArmToPoseCartesian(std::string arm_name, const geome
     //clip the desired pose and posture suggestion and send it out
     double resulting_clip_fraction;
     std::vector<double> clipped_posture_suggestion;
-    geometry_msgs::PoseStamped clipped_pose = clipDesiredPose(arm_name, desired_pose, clip_dist, clip_angle, 
+    geometry_msgs::PoseStamped clipped_pose = clipDesiredPose(arm_name, current_pose, desired_pose, clip_dist, clip_angle, 
                                     resulting_clip_fraction, goal_posture_suggestion, clipped_posture_suggestion);
     sendCartesianPoseCommand(arm_name, clipped_pose);
 
@@ -1594,11 +2377,36 @@ int MechanismInterface::moveArmToPoseCartesian(std::string arm_name, const geome
       sendCartesianPostureCommand(arm_name, clipped_posture_suggestion);
     }
 
-    //sleep until the next timestep
-    ros::Duration(timestep).sleep();
+    //servo statistics: latency from gripper pose to command, and time between commands
+    ros::Time now = ros::Time::now();
+    double latency = (now - current_pose.header.stamp).toSec();
+    latency_sum += latency;
+    if (latency > latency_max) latency_max = latency;
+    if (num_commands > 0)
+    {
+      double period = (now - last_command_time).toSec();
+      period_sum += period;
+      period_sq_sum += period * period;
+    }
+    last_command_time = now;
+    num_commands++;
+  }
+
+  if (num_commands > 1)
+  {
+    double mean_period = period_sum / (num_commands - 1);
+    double jitter = sqrt(std::max(0.0, period_sq_sum / (num_commands - 1) - mean_period * mean_period));
+    ROS_DEBUG_NAMED("manipulation", "Cartesian servo: %d commands at %.1f Hz, jitter %.1f ms, latency %.1f ms "
+                    "mean %.1f ms max, %d commands without a new gripper pose", num_commands, 1.0 / mean_period, 
+                    jitter * 1000.0, latency_sum / num_commands * 1000.0, latency_max * 1000.0, num_stale_poses);
   }
 
-  //Switch back to joint control
+  //Switch back to joint control, unless another Cartesian move might follow soon
+  if (cartesian_switch_back_delay_ > 0)
+  {
+    deferSwitchToJoint(arm_name);
+    return reached_target;
+  }
   success = false;
   for(int tries=0; tries<3; tries++)
   {
@@ -1660,7 +2468,8 @@ MechanismInterface::fingertipPadding(std::string arm_name, double pad)
   std::vector<arm_navigation_msgs::LinkPadding> padding_vec;
   arm_navigation_msgs::LinkPadding padding;
   padding.padding = pad;  
-  std::vector<std::string> links = handDescription().fingertipLinks(arm_name);
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
+  const std::vector<std::string> &links = hand->fingertip_links.get();
   for (size_t i=0; i<links.size(); i++)
   {
     padding.link_name = links[i];
@@ -1675,7 +2484,8 @@ MechanismInterface::gripperPadding(std::string arm_name, double pad)
   std::vector<arm_navigation_msgs::LinkPadding> padding_vec;
   arm_navigation_msgs::LinkPadding padding;
   padding.padding = pad;  
-  std::vector<std::string> links = handDescription().gripperTouchLinkNames(arm_name);
+  HandDescription::ArmPtr hand = handDescription().arm(arm_name);
+  const std::vector<std::string> &links = hand->gripper_touch_link_names.get();
   for (size_t i=0; i<links.size(); i++)
   {
     padding.link_name = links[i];
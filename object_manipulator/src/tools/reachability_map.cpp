@@ -0,0 +1,215 @@
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+#include "object_manipulator/tools/reachability_map.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <new>
+
+#include <ros/ros.h>
+
+namespace object_manipulator {
+
+//! Identifies reachability map files
+static const char MAP_FILE_MAGIC[4] = {'R','M','A','P'};
+//! Incremented when the file format changes
+static const uint32_t MAP_FILE_VERSION = 1;
+//! Upper limit on the number of voxels along each axis of a map read from a file
+static const uint32_t MAX_MAP_SIZE = 4096;
+
+ReachabilityMap::ReachabilityMap(std::string frame_id, const tf::Vector3 &min_corner, 
+                                 const tf::Vector3 &max_corner, double resolution) :
+  frame_id_(frame_id), origin_(min_corner), resolution_(resolution)
+{
+  size_x_ = std::max(1, (int)ceil( (max_corner.x() - min_corner.x()) / resolution ));
+  size_y_ = std::max(1, (int)ceil( (max_corner.y() - min_corner.y()) / resolution ));
+  size_z_ = std::max(1, (int)ceil( (max_corner.z() - min_corner.z()) / resolution ));
+  reachability_.assign(size_x_ * size_y_ * size_z_, 0);
+  manipulability_.assign(size_x_ * size_y_ * size_z_, 0);
+}
+
+long int ReachabilityMap::voxelIndex(const tf::Vector3 &point) const
+{
+  if (resolution_ <= 0.0) return -1;
+  long int x = (long int)floor( (point.x() - origin_.x()) / resolution_ );
+  long int y = (long int)floor( (point.y() - origin_.y()) / resolution_ );
+  long int z = (long int)floor( (point.z() - origin_.z()) / resolution_ );
+  if (x < 0 || y < 0 || z < 0 || x >= (long int)size_x_ || y >= (long int)size_y_ || z >= (long int)size_z_) 
+    return -1;
+  return (z * size_y_ + y) * size_x_ + x;
+}
+
+tf::Vector3 ReachabilityMap::voxelCenter(size_t index) const
+{
+  size_t x = index % size_x_;
+  size_t y = (index / size_x_) % size_y_;
+  size_t z = index / (size_x_ * size_y_);
+  return origin_ + tf::Vector3( (x + 0.5) * resolution_, (y + 0.5) * resolution_, (z + 0.5) * resolution_ );
+}
+
+//! Quantizes a value in [0,1] to a byte
+static unsigned char quantize(double value)
+{
+  value = std::max(0.0, std::min(1.0, value));
+  return (unsigned char)floor(value * 255.0 + 0.5);
+}
+
+void ReachabilityMap::setVoxel(size_t index, double reachability, double manipulability)
+{
+  if (index >= reachability_.size()) return;
+  reachability_[index] = quantize(reachability);
+  manipulability_[index] = quantize(manipulability);
+}
+
+bool ReachabilityMap::lookup(const tf::Vector3 &point, double &reachability, double &manipulability) const
+{
+  long int index = voxelIndex(point);
+  if (index < 0) return false;
+  reachability = reachability_[index] / 255.0;
+  manipulability = manipulability_[index] / 255.0;
+  return true;
+}
+
+bool ReachabilityMap::save(std::string filename) const
+{
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+  {
+    ROS_ERROR("Reachability map: failed to open file %s for writing", filename.c_str());
+    return false;
+  }
+  uint32_t frame_length = frame_id_.size();
+  double origin[3] = {origin_.x(), origin_.y(), origin_.z()};
+  uint32_t size[3] = {size_x_, size_y_, size_z_};
+  file.write(MAP_FILE_MAGIC, sizeof(MAP_FILE_MAGIC));
+  file.write((const char*)&MAP_FILE_VERSION, sizeof(MAP_FILE_VERSION));
+  file.write((const char*)&frame_length, sizeof(frame_length));
+  file.write(frame_id_.data(), frame_length);
+  file.write((const char*)origin, sizeof(origin));
+  file.write((const char*)&resolution_, sizeof(resolution_));
+  file.write((const char*)size, sizeof(size));
+  file.write((const char*)&reachability_[0], reachability_.size());
+  file.write((const char*)&manipulability_[0], manipulability_.size());
+  if (!file.good())
+  {
+    ROS_ERROR("Reachability map: failed to write file %s", filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool ReachabilityMap::load(std::string filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file.is_open())
+  {
+    ROS_ERROR("Reachability map: failed to open file %s", filename.c_str());
+    return false;
+  }
+  char magic[4];
+  uint32_t version, frame_length;
+  file.read(magic, sizeof(magic));
+  file.read((char*)&version, sizeof(version));
+  if (!file.good() || !std::equal(magic, magic + sizeof(magic), MAP_FILE_MAGIC) || version != MAP_FILE_VERSION)
+  {
+    ROS_ERROR("Reachability map: %s is not a reachability map file of version %u", filename.c_str(), 
+              MAP_FILE_VERSION);
+    return false;
+  }
+  file.read((char*)&frame_length, sizeof(frame_length));
+  if (!file.good() || frame_length > 1024)
+  {
+    ROS_ERROR("Reachability map: file %s is corrupted", filename.c_str());
+    return false;
+  }
+  std::vector<char> frame_id(frame_length);
+  double origin[3], resolution;
+  uint32_t size[3];
+  if (frame_length) file.read(&frame_id[0], frame_length);
+  file.read((char*)origin, sizeof(origin));
+  file.read((char*)&resolution, sizeof(resolution));
+  file.read((char*)size, sizeof(size));
+  if (!file.good() || !(resolution > 0.0) || 
+      !size[0] || !size[1] || !size[2] || size[0] > MAX_MAP_SIZE || size[1] > MAX_MAP_SIZE || size[2] > MAX_MAP_SIZE)
+  {
+    ROS_ERROR("Reachability map: file %s is corrupted", filename.c_str());
+    return false;
+  }
+  //the voxel data must be exactly what is left of the file, which also bounds the allocation below
+  uint64_t num_voxels = (uint64_t)size[0] * size[1] * size[2];
+  std::streampos data_start = file.tellg();
+  file.seekg(0, std::ios::end);
+  std::streampos file_end = file.tellg();
+  file.seekg(data_start);
+  if (!file.good() || (uint64_t)(file_end - data_start) != 2 * num_voxels)
+  {
+    ROS_ERROR("Reachability map: file %s has the wrong size for a %ux%ux%u map", filename.c_str(), 
+              size[0], size[1], size[2]);
+    return false;
+  }
+  std::vector<unsigned char> reachability, manipulability;
+  try
+  {
+    reachability.resize(num_voxels);
+    manipulability.resize(num_voxels);
+  }
+  catch (std::bad_alloc &)
+  {
+    ROS_ERROR("Reachability map: not enough memory for the %ux%ux%u map in file %s", 
+              size[0], size[1], size[2], filename.c_str());
+    return false;
+  }
+  file.read((char*)&reachability[0], num_voxels);
+  file.read((char*)&manipulability[0], num_voxels);
+  if (!file.good())
+  {
+    ROS_ERROR("Reachability map: file %s is truncated", filename.c_str());
+    return false;
+  }
+
+  frame_id_.assign(frame_id.begin(), frame_id.end());
+  origin_ = tf::Vector3(origin[0], origin[1], origin[2]);
+  resolution_ = resolution;
+  size_x_ = size[0];
+  size_y_ = size[1];
+  size_z_ = size[2];
+  reachability_.swap(reachability);
+  manipulability_.swap(manipulability);
+  return true;
+}
+
+} //namespace object_manipulator
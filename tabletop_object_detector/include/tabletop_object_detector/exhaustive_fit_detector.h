@@ -47,6 +47,8 @@
 #include <household_objects_database_msgs/GetModelList.h>
 #include <household_objects_database_msgs/GetModelMesh.h>
 
+#include <household_objects_database/model_catalogue.h>
+
 #include "tabletop_object_detector/model_fitter.h"
 
 namespace tabletop_object_detector {
@@ -99,6 +101,9 @@ class ExhaustiveFitDetector
   //! Loads all the models that are in the model database
   void loadDatabaseModels(std::string model_set);
 
+  //! Loads the models in a model set directly from a model catalogue file
+  bool loadCatalogueModels(std::string filename, std::string model_set);
+
   //! Main fitting function; fits all meshes against \a cloud and sorts the fits
   /*! Fits the point cloud \a cloud against all the models in the internal list.
     It always stores the list with at most \a numResults best fits, sorted by 
@@ -155,10 +160,22 @@ ExhaustiveFitDetector<Fitter>::~ExhaustiveFitDetector()
   acquisition method. Those models are rotationally symmetric (which is what most fitters
   operating under this class are capable of handling) plus they do not have "filled insides"
   which makes them easier to grasp.
+
+  If the ~model_catalogue_file parameter is set, the models are loaded from that catalogue
+  instead, and the database services are only used if that fails.
 */
 template <class Fitter>
 void ExhaustiveFitDetector<Fitter>::loadDatabaseModels(std::string model_set)
 {
+  std::string catalogue_file;
+  priv_nh_.param<std::string>("model_catalogue_file", catalogue_file, "");
+  if (!catalogue_file.empty())
+  {
+    if (loadCatalogueModels(catalogue_file, model_set)) return;
+    ROS_WARN("Object detector: failed to load models from catalogue %s; using database services instead",
+             catalogue_file.c_str());
+  }
+
   std::string get_model_list_srv_name;
   priv_nh_.param<std::string>("get_model_list_srv", get_model_list_srv_name, "get_model_list_srv");
   while ( !ros::service::waitForService(get_model_list_srv_name, ros::Duration(2.0)) && nh_.ok() ) 
@@ -224,6 +241,86 @@ void ExhaustiveFitDetector<Fitter>::loadDatabaseModels(std::string model_set)
   ROS_INFO("Object detector: loading complete");
 }
 
+/*! Needs no services at all. If the catalogue holds points sampled at the resolution that the
+  Fitter uses, they are used directly, skipping the expensive mesh sampling step; otherwise, the
+  meshes in the catalogue are sampled just like loadDatabaseModels(...) does.
+*/
+template <class Fitter>
+bool ExhaustiveFitDetector<Fitter>::loadCatalogueModels(std::string filename, std::string model_set)
+{
+  household_objects_database::ModelCatalogue catalogue;
+  if (!catalogue.open(filename)) return false;
+
+  std::vector<const household_objects_database::CatalogueModel*> models;
+  if (model_set.empty())
+  {
+    for (size_t i=0; i<catalogue.numModels(); i++) models.push_back(&catalogue.model(i));
+  }
+  else
+  {
+    const household_objects_database::CatalogueModelSet *set = catalogue.findModelSet(model_set);
+    if (!set)
+    {
+      ROS_ERROR("Model set %s not found in catalogue %s", model_set.c_str(), filename.c_str());
+      return false;
+    }
+    const int32_t *ids = catalogue.array<int32_t>(set->ids_offset);
+    for (size_t i=0; i<set->num_ids; i++)
+    {
+      const household_objects_database::CatalogueModel *model = catalogue.findModel(ids[i]);
+      if (model) models.push_back(model);
+    }
+  }
+  if (models.empty())
+  {
+    ROS_ERROR("Empty model list retrieved from catalogue");
+    return false;
+  }
+
+  ROS_INFO("Object detector: loading object models from catalogue %s", filename.c_str());
+  for (size_t i=0; i<models.size(); i++)
+  {
+    const household_objects_database::CatalogueModel &model = *models[i];
+    if (!model.num_vertices || !model.num_triangles)
+    {
+      ROS_ERROR("Empty mesh for model %d", model.scaled_model_id);
+      continue;
+    }
+
+    Fitter* fitter = new Fitter();
+    if (model.num_sampled_points && 
+        fabs(catalogue.header().sampling_resolution - fitter->getSamplingResolution()) < 1.0e-9)
+    {
+      const float *p = catalogue.sampledPoints(model);
+      std::vector<btVector3> points(model.num_sampled_points);
+      for (size_t j=0; j<points.size(); j++) points[j] = btVector3(p[3*j+0], p[3*j+1], p[3*j+2]);
+      fitter->initializeFromSampledPoints(points);
+    }
+    else
+    {
+      const double *v = catalogue.vertices(model);
+      const int32_t *t = catalogue.triangles(model);
+      arm_navigation_msgs::Shape mesh;
+      mesh.type = mesh.MESH;
+      mesh.triangles.assign(t, t + 3 * model.num_triangles);
+      mesh.vertices.resize(model.num_vertices);
+      for (size_t j=0; j<mesh.vertices.size(); j++)
+      {
+        mesh.vertices[j].x = v[3*j+0];
+        mesh.vertices[j].y = v[3*j+1];
+        mesh.vertices[j].z = v[3*j+2];
+      }
+      fitter->initializeFromMesh(mesh);
+    }
+    templates.push_back(fitter);  
+    //set the model ID in the template so that we can use it later
+    templates.back()->setModelId( model.scaled_model_id );
+    ROS_INFO("  Loaded catalogue model with id %d", model.scaled_model_id);
+  }
+  ROS_INFO("Object detector: loading complete");
+  return true;
+}
+
 } //namespace
 
 #endif
@@ -154,6 +154,16 @@ class DistanceFieldFitter : public ModelToCloudFitter
   
   //! Calls initialize from points on the vertices of the mesh
   void initializeFromMesh(const arm_navigation_msgs::Shape &mesh);
+
+  //! The resolution that initializeFromMesh samples the surface of the mesh with
+  double getSamplingResolution() const {return 1.5 * distance_field_resolution_;}
+
+  //! Samples the surface of the mesh exactly like initializeFromMesh does
+  /*! Lets the sampled points be computed offline and stored, e.g. in a model catalogue. */
+  void sampleMeshSurface(const arm_navigation_msgs::Shape &mesh, std::vector<btVector3> &points);
+
+  //! Initialize from points previously obtained with sampleMeshSurface
+  void initializeFromSampledPoints(const std::vector<btVector3> &points) {initializeFromBtVectors(points);}
 };
 
 } //namespace tabletop_object_detector
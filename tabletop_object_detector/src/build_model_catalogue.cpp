@@ -0,0 +1,150 @@
+
+/*********************************************************************
+*
+*  Copyright (c) 2026, cob_object_manipulation contributors
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the copyright holders nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+  
+
+//! Builds a packed model catalogue from the objects database, with the surface of each mesh
+//! already sampled at the resolution used by the distance field fitters, so that the object
+//! detector can load all its models without any database access or mesh sampling
+
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include <ros/ros.h>
+
+#include <household_objects_database/database_tool_utils.h>
+#include <household_objects_database/model_catalogue.h>
+
+#include "tabletop_object_detector/iterative_distance_fitter.h"
+
+using namespace household_objects_database;
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "build_model_catalogue", ros::init_options::AnonymousName);
+  if (argc < 2)
+  {
+    printDatabaseToolUsage("build_model_catalogue output_file [model_set ...]");
+    return -1;
+  }
+  std::string filename(argv[1]);
+  std::vector<std::string> model_sets(argv + 2, argv + argc);
+
+  boost::scoped_ptr<ObjectsDatabase> database(connectToDatabaseFromParams());
+  if (!database) return -1;
+
+  //the fitter used by the object detector decides the sampling resolution
+  tabletop_object_detector::IterativeTranslationFitter fitter;
+  ModelCatalogueWriter writer(fitter.getSamplingResolution());
+
+  std::vector< boost::shared_ptr<DatabaseScaledModel> > models;
+  if (model_sets.empty())
+  {
+    if (!database->getScaledModelsList(models))
+    {
+      std::cerr << "Failed to get list of scaled models\n";
+      return -1;
+    }
+  }
+  else
+  {
+    std::set<int> added_ids;
+    for (size_t s=0; s<model_sets.size(); s++)
+    {
+      std::vector< boost::shared_ptr<DatabaseScaledModel> > set_models;
+      if (!database->getScaledModelsBySet(set_models, model_sets[s]))
+      {
+        std::cerr << "Failed to get models in set " << model_sets[s] << "\n";
+        return -1;
+      }
+      std::vector<int32_t> ids;
+      for (size_t i=0; i<set_models.size(); i++)
+      {
+        ids.push_back(set_models[i]->id_.data());
+        if (added_ids.insert(set_models[i]->id_.data()).second) models.push_back(set_models[i]);
+      }
+      writer.addModelSet(model_sets[s], ids);
+    }
+  }
+
+  for (size_t i=0; i<models.size(); i++)
+  {
+    int model_id = models[i]->id_.data();
+    DatabaseMesh mesh;
+    if (!database->getScaledModelMesh(model_id, mesh))
+    {
+      std::cerr << "Failed to get mesh for model " << model_id << "\n";
+      return -1;
+    }
+    std::vector< boost::shared_ptr<DatabaseGrasp> > grasps;
+    DatabaseGrasp example;
+    std::stringstream id;
+    id << model_id;
+    if (!database->getList<DatabaseGrasp>(grasps, example, "scaled_model_id=" + id.str()))
+    {
+      std::cerr << "Failed to get grasps for model " << model_id << "\n";
+      return -1;
+    }
+
+    //sample the mesh surface exactly as the fitter would at startup
+    arm_navigation_msgs::Shape shape;
+    if (!ObjectsDatabase::meshToShape(mesh, shape)) return -1;
+    std::vector<btVector3> points;
+    fitter.sampleMeshSurface(shape, points);
+    std::vector<float> sampled_points;
+    sampled_points.reserve(3 * points.size());
+    for (size_t j=0; j<points.size(); j++)
+    {
+      sampled_points.push_back(points[j].x());
+      sampled_points.push_back(points[j].y());
+      sampled_points.push_back(points[j].z());
+    }
+
+    if (!writer.addModel(*models[i], mesh, grasps, sampled_points)) return -1;
+    std::cerr << "Added model " << model_id << ": " << grasps.size() << " grasps, " 
+              << points.size() << " sampled points\n";
+  }
+
+  if (!writer.write(filename))
+  {
+    std::cerr << "Failed to write catalogue\n";
+    return -1;
+  }
+  std::cerr << "Catalogue written to " << filename << "\n";
+  return 0;
+}
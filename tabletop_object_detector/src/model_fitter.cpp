@@ -201,12 +201,18 @@ void ModelToCloudFitter::sampleMesh(const arm_navigation_msgs::Shape &mesh,
 }
 
 
-void DistanceFieldFitter::initializeFromMesh(const arm_navigation_msgs::Shape &mesh)
+void DistanceFieldFitter::sampleMeshSurface(const arm_navigation_msgs::Shape &mesh, 
+                                            std::vector<btVector3> &points)
 {
-  std::vector<btVector3> btVectors;
   //we use a slightly larger resolution than the distance field, in an attempt to bring
   //down pre-computation time
-  sampleMesh(mesh, btVectors,  1.5 * distance_field_resolution_ ); 
+  sampleMesh(mesh, points, getSamplingResolution());
+}
+
+void DistanceFieldFitter::initializeFromMesh(const arm_navigation_msgs::Shape &mesh)
+{
+  std::vector<btVector3> btVectors;
+  sampleMeshSurface(mesh, btVectors);
   initializeFromBtVectors(btVectors);
 }
 